@@ -2,11 +2,17 @@
 // Created by smaptas on 07.11.17.
 //
 
+#include <algorithm>
 #include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
 #include <utility>
 #include <map>
+#include <vector>
 
 #include "lexicon/fsa_lexicon/fsa_lexicon.h"
 #include "common/io_option.h"
@@ -21,22 +27,53 @@
 
 #include <cxxopts.hpp>
 
-FSALexicon make_lexicon(std::istream& in_stream)
+// Encode with word-packed bitvectors, since encoding time is dominated by
+// appending bits.
+using BVType = BitVector<PackedBits>;
+
+FSALexicon make_lexicon(std::istream& in_stream, size_t num_threads,
+                        bool pipeline)
 {
   FSALexicon lexicon;
-  lexicon.add_file(in_stream);
+  if (num_threads == 1) {
+    if (pipeline) {
+      lexicon.add_file_pipelined(in_stream);
+    } else {
+      lexicon.add_file(in_stream);
+    }
+  } else {
+    lexicon.add_file_parallel(in_stream, num_threads);
+  }
   return lexicon;
 }
 
-FSALexicon load_lexicon(std::istream& in_stream)
+FSALexicon load_lexicon(std::istream& in_stream, size_t, bool)
 {
   FSALexicon lexicon;
-  lexicon.load(in_stream);
+  if (!lexicon.load_encoding(in_stream)) {
+    std::cerr << "\n\nERROR: Input is not an encoded lexicon." << std::endl;
+    exit(1);
+  }
   return lexicon;
 }
 
+FSALexicon resume_lexicon(std::istream& in_stream, size_t, bool)
+{
+  FSALexicon lexicon;
+  if (!lexicon.load_checkpoint(in_stream)) {
+    std::cerr << "\n\nERROR: Input is not a lexicon checkpoint." << std::endl;
+    exit(1);
+  }
+  return lexicon;
+}
+
+void write_checkpoint(std::ostream& out_stream, const FSALexicon* lexicon)
+{
+  lexicon->save_checkpoint(out_stream);
+}
+
 void write_lexicon(std::ostream& out_stream,
-                   FSAEncoder<BitVector<>>* encoder)
+                   FSAEncoder<BVType>* encoder)
 {
   out_stream << encoder->encode();
 }
@@ -76,13 +113,44 @@ struct option_string
   std::string long_option;
 };
 
+/**
+ * Write the strings of a lexicon to numbered shard files on several threads.
+ *
+ * @param lexicon - the lexicon.
+ * @param prefix - the prefix of the file names, to which a five-digit shard
+ *                 number is appended, so the files concatenate in sorted order.
+ * @param num_threads - the number of shards and threads, or 0 for one per core.
+ */
+void export_strings(const FSALexicon& lexicon, const std::string& prefix,
+                    size_t num_threads)
+{
+  if (num_threads == 0) {
+    num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  std::vector<std::unique_ptr<std::ofstream>> files;
+  std::vector<std::ostream*> outstreams;
+  for (size_t i = 0; i < num_threads; ++i) {
+    std::ostringstream name;
+    name << prefix << "." << std::setw(5) << std::setfill('0') << i;
+    files.push_back(std::make_unique<std::ofstream>(name.str()));
+    outstreams.push_back(files.back().get());
+  }
+  lexicon.dump_parallel(outstreams, num_threads);
+}
+
 enum class Option {
   debug,
+  export_strings,
   help,
   infile,
   load,
   outfile,
   path_compaction,
+  pipeline,
+  resume,
+  save_build,
+  save_compacted,
+  threads,
   transition_compaction
 };
 
@@ -90,7 +158,9 @@ struct tool_options
 {
   tool_options(const cxxopts::ParseResult& result,
                const std::unordered_map<Option, option_string>& option_map)
-    : in_file{result[option_map.at(
+    : export_prefix{result[option_map.at(
+        Option::export_strings).long_option].as<std::string>()},
+      in_file{result[option_map.at(
         Option::infile).long_option].as<std::string>()},
       out_file{result[option_map.at(
         Option::outfile).long_option].as<std::string>()},
@@ -98,27 +168,48 @@ struct tool_options
       load{result.count(option_map.at(Option::load).long_option) > 0},
       path_compact{result.count(option_map.at(
         Option::path_compaction).long_option) > 0},
+      pipeline{result.count(option_map.at(Option::pipeline).long_option) > 0},
+      resume_file{result[option_map.at(
+        Option::resume).long_option].as<std::string>()},
+      save_build_file{result[option_map.at(
+        Option::save_build).long_option].as<std::string>()},
+      save_compacted_file{result[option_map.at(
+        Option::save_compacted).long_option].as<std::string>()},
+      num_threads{result[option_map.at(
+        Option::threads).long_option].as<size_t>()},
       transition_compact{result.count(option_map.at(
         Option::transition_compaction).long_option) > 0}
   {
     // Nothing to do here.
   }
 
+  std::string export_prefix;
   std::string in_file;
   std::string out_file;
   bool help;
   bool load;
   bool path_compact;
+  bool pipeline;
+  std::string resume_file;
+  std::string save_build_file;
+  std::string save_compacted_file;
+  size_t num_threads;
   bool transition_compact;
 };
 
 const std::unordered_map<Option, option_string> OPTION_MAP{
   {Option::debug, {"d", "debug"}},
+  {Option::export_strings, {"x", "export"}},
   {Option::infile, {"i", "infile"}},
   {Option::load, {"l", "load"}},
   {Option::help, {"h", "help"}},
   {Option::outfile, {"o", "outfile"}},
   {Option::path_compaction, {"p", "path-compaction"}},
+  {Option::pipeline, {"m", "pipeline"}},
+  {Option::resume, {"r", "resume"}},
+  {Option::save_build, {"b", "save-build"}},
+  {Option::save_compacted, {"c", "save-compacted"}},
+  {Option::threads, {"j", "threads"}},
   {Option::transition_compaction, {"t", "transition-compaction"}},
 };
 
@@ -135,13 +226,35 @@ cxxopts::Options make_options(char* program_name)
     return OPTION_MAP.at(o).full_option();
   };
   options.add_options()
+           (get_full_option(Option::export_strings),
+            "Write the strings of the lexicon, in sorted order, to one file "
+            "per thread named with this prefix and the shard number",
+            cxxopts::value<std::string>()->default_value(""))
            (get_full_option(Option::infile), "Input file",
             cxxopts::value<std::string>()->default_value(""))
-           (get_full_option(Option::load), "Load a representation")
+           (get_full_option(Option::load),
+            "Load an encoded lexicon instead of a list of strings")
            (get_full_option(Option::help), "Display this help message")
            (get_full_option(Option::outfile), "Output file",
             cxxopts::value<std::string>()->default_value(""))
            (get_full_option(Option::path_compaction), "Use path compaction")
+           (get_full_option(Option::pipeline),
+            "Minimize the lexicon on a second thread while building it "
+            "(ignored with -j)")
+           (get_full_option(Option::resume),
+            "Resume from a checkpoint instead of reading the input file (pass "
+            "-p only to compact a checkpoint saved before compaction)",
+            cxxopts::value<std::string>()->default_value(""))
+           (get_full_option(Option::save_build),
+            "Save a checkpoint of the lexicon after it is built or loaded",
+            cxxopts::value<std::string>()->default_value(""))
+           (get_full_option(Option::save_compacted),
+            "Save a checkpoint of the lexicon after path compaction",
+            cxxopts::value<std::string>()->default_value(""))
+           (get_full_option(Option::threads),
+            "Build the lexicon from shards and export its strings on this "
+            "many threads (0 for one per core)",
+            cxxopts::value<size_t>()->default_value("1"))
            (get_full_option(Option::transition_compaction),
             "Use transition compaction");
   return options;
@@ -196,10 +309,10 @@ std::pair<LabeledGraph::LabelMap, std::unordered_map<char, size_t>> get_new_coun
   return std::make_pair(counts1, counts2);
 }
 
-const LabeledGraph::LabelMap& get_label_counts(
+LabeledGraph::LabelMap get_label_counts(
   const FSALexicon& lexicon)
 {
-  return const_cast<const LabeledGraph::LabelMap&>(lexicon.get_graph().get_label_counts());
+  return lexicon.get_graph().get_label_counts();
 }
 
 int main(int argc, char* argv[])
@@ -215,18 +328,53 @@ int main(int argc, char* argv[])
 
   // TODO: refactor the operations below into their own functions.
 
-  // Make or load an FSALexicon from standard input or an input file.
-  FunctionTimer<FSALexicon, std::string, bool> in_timer([](std::string infile,
-                                                           bool load) {
-    return input_option(load ? load_lexicon: make_lexicon, infile);
+  // Make or load an FSALexicon from standard input or an input file, or
+  // resume from a checkpoint saved by an earlier run.
+  auto resume = !parsed.resume_file.empty();
+  FunctionTimer<FSALexicon, std::string, bool, size_t, bool> in_timer(
+    [resume](std::string infile, bool load, size_t num_threads,
+             bool pipeline) {
+    return input_option(resume ? resume_lexicon
+                               : load ? load_lexicon : make_lexicon, infile,
+                        num_threads, pipeline);
   });
-  std::cout << (parsed.load ? "Loading" : "Making") << " lexicon from "
-            << (parsed.in_file.empty() ? "standard input" : parsed.in_file)
+  auto in_file = resume ? parsed.resume_file : parsed.in_file;
+  std::cout << (resume ? "Resuming" : parsed.load ? "Loading" : "Making")
+            << " lexicon from "
+            << (in_file.empty() ? "standard input" : in_file)
             << "..." << std::flush;
-  auto lexicon = in_timer.run(parsed.in_file, parsed.load);
+  auto lexicon = in_timer.run(in_file, parsed.load, parsed.num_threads,
+                              parsed.pipeline);
   std::cout << "done! (took " << in_timer.time() << " seconds)" << std::endl;
   print_lexicon_info(lexicon);
 
+  // Save a checkpoint of a stage so that later runs can resume from it.
+  FunctionTimer<void, std::string, const FSALexicon&> save_timer([](
+    std::string outfile, const FSALexicon& lexicon) {
+    output_option(write_checkpoint, outfile, &lexicon);
+  });
+  auto save_stage = [&save_timer, &lexicon](const std::string& outfile) {
+    std::cout << "Saving checkpoint to " << outfile << "..." << std::flush;
+    save_timer.run(outfile, lexicon);
+    std::cout << "done! (took " << save_timer.time() << " seconds)"
+              << std::endl;
+  };
+  if (!parsed.save_build_file.empty()) {
+    save_stage(parsed.save_build_file);
+  }
+
+  if (!parsed.export_prefix.empty()) {
+    FunctionTimer<void, const FSALexicon&, std::string, size_t> export_timer(
+      [](const FSALexicon& lexicon, std::string prefix, size_t num_threads) {
+      export_strings(lexicon, prefix, num_threads);
+    });
+    std::cout << "Exporting strings to " << parsed.export_prefix << ".*..."
+              << std::flush;
+    export_timer.run(lexicon, parsed.export_prefix, parsed.num_threads);
+    std::cout << "done! (took " << export_timer.time() << " seconds)"
+              << std::endl;
+  }
+
   if (parsed.path_compact) {
     FunctionTimer<void, FSALexicon&> compact_timer([](FSALexicon& lexicon) {
       lexicon.compact(3);
@@ -236,9 +384,11 @@ int main(int argc, char* argv[])
     std::cout << "done! (took " << compact_timer.time() << " seconds)"
               << std::endl;
     print_lexicon_info(lexicon);
+    if (!parsed.save_compacted_file.empty()) {
+      save_stage(parsed.save_compacted_file);
+    }
   }
 
-  using BVType = BitVector<>;
   using EncPtrType = std::unique_ptr<FSAEncoder<BVType>>;
   auto [counts1, counts2] = get_new_counts(get_label_counts(lexicon));
   auto temp_char_coder = std::make_shared<CharHuffmanCoder<std::string,
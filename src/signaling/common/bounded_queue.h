@@ -0,0 +1,97 @@
+/**
+ * Blocking queue with a fixed capacity for handing work between threads.
+ */
+
+#ifndef CAPS_BOUNDED_QUEUE_H
+#define CAPS_BOUNDED_QUEUE_H
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <utility>
+
+/**
+ * First-in, first-out queue shared by producer and consumer threads.
+ *
+ * Pushing to a full queue blocks until an element is popped, so a producer
+ * cannot run arbitrarily far ahead of its consumers. Once the queue is
+ * closed, consumers drain the remaining elements and then stop.
+ *
+ * @tparam T - the element type.
+ */
+template <typename T>
+class BoundedQueue
+{
+ public:
+
+  explicit BoundedQueue(size_t capacity)
+    : elements_{}, capacity_{capacity}, closed_{false}, mutex_{},
+      not_empty_{}, not_full_{}
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * Add an element, waiting until the queue has room for it.
+   *
+   * @param element - the element to add.
+   */
+  void push(T element)
+  {
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      not_full_.wait(lock, [this]() { return elements_.size() < capacity_; });
+      elements_.push(std::move(element));
+    }
+    not_empty_.notify_one();
+  }
+
+  /**
+   * Remove the oldest element, waiting until there is one.
+   *
+   * @return - the element, or std::nullopt if the queue is closed and empty.
+   */
+  std::optional<T> pop()
+  {
+    std::optional<T> element;
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      not_empty_.wait(lock, [this]() { return closed_ || !elements_.empty(); });
+      if (elements_.empty()) {
+        return std::nullopt;
+      }
+      element = std::move(elements_.front());
+      elements_.pop();
+    }
+    not_full_.notify_one();
+    return element;
+  }
+
+  /**
+   * Signal that no more elements will be pushed.
+   */
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      closed_ = true;
+    }
+    not_empty_.notify_all();
+  }
+
+ private:
+
+  std::queue<T> elements_;
+  size_t capacity_;
+  bool closed_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+};
+
+#endif //CAPS_BOUNDED_QUEUE_H
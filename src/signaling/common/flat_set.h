@@ -0,0 +1,219 @@
+/**
+ * Sorted set stored in a small vector.
+ */
+
+#ifndef CAPS_FLAT_SET_H
+#define CAPS_FLAT_SET_H
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+// Include other headers from this project.
+#include "small_vector.h"
+
+// Include headers from other projects.
+
+/**
+ * Functor that uses a whole value as its key.
+ */
+struct IdentityKey
+{
+  template <typename T>
+  const T& operator()(const T& value) const noexcept
+  {
+    return value;
+  }
+};
+
+/**
+ * Functor that uses the first element of a pair as its key.
+ */
+struct FirstKey
+{
+  template <typename Pair>
+  const typename Pair::first_type& operator()(const Pair& value) const noexcept
+  {
+    return value.first;
+  }
+};
+
+/**
+ * Set of values with unique keys, kept sorted by key in a SmallVector.
+ *
+ * With FirstKey, the set can stand in for a std::map from the first element
+ * of a pair to the second: lookups take a key and iteration yields pairs in
+ * key order. Lookups are binary searches over contiguous memory, which is
+ * faster than a tree for the handful of elements usually stored, and no
+ * element requires an allocation of its own.
+ *
+ * Only const iterators are provided, since changing a key in place could
+ * break the order. Inserting or erasing an element invalidates iterators.
+ *
+ * @tparam Value - the type of the values.
+ * @tparam KeyOf - a functor that returns the key of a value.
+ * @tparam N - the number of values stored inline.
+ */
+template <typename Value, typename KeyOf, size_t N>
+class FlatSet
+{
+ public:
+
+  using value_type = Value;
+  using key_type = std::decay_t<decltype(KeyOf{}(std::declval<Value>()))>;
+  using size_type = size_t;
+  using ContainerType = SmallVector<Value, N>;
+  using const_iterator = typename ContainerType::const_iterator;
+  using iterator = const_iterator;
+  using const_reverse_iterator =
+    typename ContainerType::const_reverse_iterator;
+  using reverse_iterator = const_reverse_iterator;
+
+  size_t size() const noexcept
+  {
+    return values_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return values_.empty();
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return values_.begin();
+  }
+
+  const_iterator end() const noexcept
+  {
+    return values_.end();
+  }
+
+  const_iterator cbegin() const noexcept
+  {
+    return values_.begin();
+  }
+
+  const_iterator cend() const noexcept
+  {
+    return values_.end();
+  }
+
+  const_reverse_iterator rbegin() const noexcept
+  {
+    return values_.rbegin();
+  }
+
+  const_reverse_iterator rend() const noexcept
+  {
+    return values_.rend();
+  }
+
+  const_reverse_iterator crbegin() const noexcept
+  {
+    return values_.rbegin();
+  }
+
+  const_reverse_iterator crend() const noexcept
+  {
+    return values_.rend();
+  }
+
+  /**
+   * Find the first value whose key is not less than a key.
+   *
+   * @param key - the key to look for. It may be of any type that can be
+   *              compared with key_type.
+   * @return - an iterator to the value, or end() if there is none.
+   */
+  template <typename Key>
+  const_iterator lower_bound(const Key& key) const
+  {
+    return std::lower_bound(values_.begin(), values_.end(), key,
+                            [](const Value& value, const Key& k) {
+                              return KeyOf{}(value) < k;
+                            });
+  }
+
+  template <typename Key>
+  const_iterator find(const Key& key) const
+  {
+    auto position = lower_bound(key);
+    if (position != end() && !(key < KeyOf{}(*position))) {
+      return position;
+    }
+    return end();
+  }
+
+  /**
+   * Get the value with a key, which must be in the set.
+   *
+   * @param key - the key to look for.
+   * @return - the value with the key.
+   */
+  template <typename Key>
+  const Value& at(const Key& key) const
+  {
+    auto position = find(key);
+    if (position == end()) {
+      throw std::out_of_range{"FlatSet::at"};
+    }
+    return *position;
+  }
+
+  /**
+   * Insert a value constructed from arguments, unless a value with the same
+   * key is already in the set.
+   *
+   * @return - an iterator to the value with the key, and true if the value
+   *           was inserted.
+   */
+  template <typename... Args>
+  std::pair<const_iterator, bool> emplace(Args&&... args)
+  {
+    Value value(std::forward<Args>(args)...);
+    auto position = lower_bound(KeyOf{}(value));
+    if (position != end() && !(KeyOf{}(value) < KeyOf{}(*position))) {
+      return {position, false};
+    }
+    return {values_.insert(position, std::move(value)), true};
+  }
+
+  const_iterator erase(const_iterator position)
+  {
+    return values_.erase(position);
+  }
+
+  /**
+   * Erase the value with a key, if there is one.
+   *
+   * @param key - the key of the value to erase.
+   * @return - the number of values erased.
+   */
+  template <typename Key>
+  size_t erase(const Key& key)
+  {
+    auto position = find(key);
+    if (position == end()) {
+      return 0;
+    }
+    values_.erase(position);
+    return 1;
+  }
+
+  void clear() noexcept
+  {
+    values_.clear();
+  }
+
+ private:
+
+  ContainerType values_;
+};
+
+#endif //CAPS_FLAT_SET_H
@@ -0,0 +1,32 @@
+/**
+ * Report the memory used by the current process.
+ */
+
+#ifndef CAPS_MEMORY_USAGE_H
+#define CAPS_MEMORY_USAGE_H
+
+// Include C standard libraries.
+#include <cstddef>
+#include <unistd.h>
+
+// Include C++ standard libraries.
+#include <fstream>
+
+/**
+ * Get the resident set size of the current process.
+ *
+ * @return - the resident set size in bytes, or 0 if it cannot be read (e.g.,
+ *           on systems without /proc).
+ */
+inline size_t resident_memory()
+{
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  if (!(statm >> total_pages >> resident_pages)) {
+    return 0;
+  }
+  return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+#endif //CAPS_MEMORY_USAGE_H
@@ -0,0 +1,282 @@
+/**
+ * Vector that stores a small number of elements inline.
+ */
+
+#ifndef CAPS_SMALL_VECTOR_H
+#define CAPS_SMALL_VECTOR_H
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+// Include C++ standard libraries.
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Include other headers from this project.
+
+// Include headers from other projects.
+
+/**
+ * A contiguous sequence of elements that are stored inside the object itself
+ * while there are at most N of them, and on the heap otherwise.
+ *
+ * Only the operations needed by FlatSet are provided. As with std::vector,
+ * inserting or erasing an element invalidates iterators at or after it, and
+ * growing the capacity invalidates all iterators.
+ *
+ * @tparam T - the element type.
+ * @tparam N - the number of elements to store inline (at least 1).
+ */
+template <typename T, size_t N>
+class SmallVector
+{
+ public:
+
+  static_assert(N > 0, "SmallVector must store at least one element inline");
+
+  using value_type = T;
+  using size_type = size_t;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  SmallVector()
+    : data_{inline_data()}, size_{0}, capacity_{N}
+  {
+    // Nothing to do here.
+  }
+
+  SmallVector(const SmallVector& orig)
+    : SmallVector()
+  {
+    reserve(orig.size_);
+    std::uninitialized_copy(orig.begin(), orig.end(), data_);
+    size_ = orig.size_;
+  }
+
+  SmallVector(SmallVector&& orig) noexcept
+    : SmallVector()
+  {
+    move_from(orig);
+  }
+
+  ~SmallVector()
+  {
+    clear();
+    release_heap();
+  }
+
+  SmallVector& operator=(const SmallVector& orig)
+  {
+    if (this != &orig) {
+      SmallVector copy{orig};
+      clear();
+      move_from(copy);
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& orig) noexcept
+  {
+    if (this != &orig) {
+      clear();
+      move_from(orig);
+    }
+    return *this;
+  }
+
+  size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  size_t capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  T* data() noexcept
+  {
+    return data_;
+  }
+
+  const T* data() const noexcept
+  {
+    return data_;
+  }
+
+  T& operator[](size_t n)
+  {
+    return data_[n];
+  }
+
+  const T& operator[](size_t n) const
+  {
+    return data_[n];
+  }
+
+  iterator begin() noexcept
+  {
+    return data_;
+  }
+
+  iterator end() noexcept
+  {
+    return data_ + size_;
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return data_;
+  }
+
+  const_iterator end() const noexcept
+  {
+    return data_ + size_;
+  }
+
+  const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator{end()};
+  }
+
+  const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator{begin()};
+  }
+
+  /**
+   * Make room for at least n elements.
+   *
+   * @param n - the number of elements.
+   */
+  void reserve(size_t n)
+  {
+    if (n <= capacity_) {
+      return;
+    }
+    auto new_data = static_cast<T*>(::operator new(n * sizeof(T)));
+    relocate(data_, data_ + size_, new_data);
+    release_heap();
+    data_ = new_data;
+    capacity_ = static_cast<uint32_t>(n);
+  }
+
+  /**
+   * Insert an element before a position.
+   *
+   * @param position - the position to insert before.
+   * @param value - the element to insert.
+   * @return - an iterator to the inserted element.
+   */
+  iterator insert(const_iterator position, T value)
+  {
+    auto index = static_cast<size_t>(position - data_);
+    if (size_ == capacity_) {
+      reserve(2 * capacity_);
+    }
+    auto target = data_ + index;
+    if (index == size_) {
+      ::new (static_cast<void*>(target)) T(std::move(value));
+    } else {
+      // Shift the elements after the position back by one.
+      auto last = data_ + size_;
+      ::new (static_cast<void*>(last)) T(std::move(*(last - 1)));
+      std::move_backward(target, last - 1, last);
+      *target = std::move(value);
+    }
+    ++size_;
+    return target;
+  }
+
+  /**
+   * Erase the element at a position.
+   *
+   * @param position - the position of the element to erase.
+   * @return - an iterator to the element after the erased element.
+   */
+  iterator erase(const_iterator position)
+  {
+    auto target = data_ + (position - data_);
+    std::move(target + 1, data_ + size_, target);
+    --size_;
+    data_[size_].~T();
+    return target;
+  }
+
+  /**
+   * Remove all elements, keeping the capacity.
+   */
+  void clear() noexcept
+  {
+    for (size_t i = 0; i < size_; ++i) {
+      data_[i].~T();
+    }
+    size_ = 0;
+  }
+
+ private:
+
+  T* inline_data() noexcept
+  {
+    return reinterpret_cast<T*>(&storage_);
+  }
+
+  bool is_inline() const noexcept
+  {
+    return data_ == reinterpret_cast<const T*>(&storage_);
+  }
+
+  void release_heap() noexcept
+  {
+    if (!is_inline()) {
+      ::operator delete(data_);
+      data_ = inline_data();
+      capacity_ = N;
+    }
+  }
+
+  static void relocate(T* first, T* last, T* destination)
+  {
+    for (; first != last; ++first, ++destination) {
+      ::new (static_cast<void*>(destination)) T(std::move(*first));
+      first->~T();
+    }
+  }
+
+  // Take the elements of another vector, leaving it empty. This vector must
+  // be empty.
+  void move_from(SmallVector& other) noexcept
+  {
+    release_heap();
+    if (other.is_inline()) {
+      relocate(other.data_, other.data_ + other.size_, data_);
+    } else {
+      data_ = other.data_;
+      capacity_ = other.capacity_;
+      other.data_ = other.inline_data();
+      other.capacity_ = N;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+
+  // Sizes are 32-bit to keep small vectors small.
+  T* data_;
+  uint32_t size_;
+  uint32_t capacity_;
+  std::aligned_storage_t<sizeof(T) * N, alignof(T)> storage_;
+};
+
+#endif //CAPS_SMALL_VECTOR_H
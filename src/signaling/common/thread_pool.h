@@ -0,0 +1,120 @@
+/**
+ * Fixed-size pool of worker threads that run tasks in submission order.
+ */
+
+#ifndef CAPS_THREAD_POOL_H
+#define CAPS_THREAD_POOL_H
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Pool of threads that take tasks from a shared queue.
+ *
+ * Tasks are started in the order they are submitted. The destructor waits
+ * for every submitted task to finish before joining the threads.
+ */
+class ThreadPool
+{
+ public:
+
+  /**
+   * Start the threads of the pool.
+   *
+   * @param num_threads - the number of threads, or 0 to use one per hardware
+   *                      thread.
+   */
+  explicit ThreadPool(size_t num_threads = 0)
+    : threads_{}, tasks_{}, mutex_{}, ready_{}, stopping_{false}
+  {
+    if (num_threads == 0) {
+      num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this]() { run(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto& thread: threads_) {
+      thread.join();
+    }
+  }
+
+  /**
+   * Queue a task to run on one of the threads.
+   *
+   * @tparam Function - a callable type that takes no arguments.
+   * @param function - the task.
+   * @return - a future holding the task's result (or the exception it threw).
+   */
+  template <typename Function>
+  auto submit(Function function) -> std::future<decltype(function())>
+  {
+    // A packaged task cannot be copied into a std::function, so share it.
+    using ResultType = decltype(function());
+    auto task = std::make_shared<std::packaged_task<ResultType()>>(
+      std::move(function));
+    auto result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      tasks_.emplace([task]() { (*task)(); });
+    }
+    ready_.notify_one();
+    return result;
+  }
+
+  size_t size() const noexcept
+  {
+    return threads_.size();
+  }
+
+ private:
+
+  void run()
+  {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock{mutex_};
+        ready_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  bool stopping_;
+};
+
+#endif //CAPS_THREAD_POOL_H
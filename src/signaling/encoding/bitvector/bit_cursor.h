@@ -0,0 +1,164 @@
+/**
+ * Writer and reader cursors over bit vectors, used by the coders to append
+ * and read encodings without creating intermediate bit vectors.
+ */
+
+#ifndef CAPS_BIT_CURSOR_H
+#define CAPS_BIT_CURSOR_H
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+// Include C++ standard libraries.
+
+// Include other headers from this project.
+
+// Include headers from other projects.
+
+/**
+ * A cursor that appends bits to the end of a bit vector.
+ *
+ * The writer does not own the bit vector, which must outlive it. Writing
+ * never allocates other than to grow the underlying bit vector.
+ *
+ * @tparam BitVectorType - the type of the bit vector to write to.
+ */
+template <typename BitVectorType>
+class BitVectorWriter
+{
+ public:
+
+  explicit BitVectorWriter(BitVectorType& buffer)
+    : buffer_{&buffer}
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * Append a single bit.
+   *
+   * @param bit - the bit to append.
+   */
+  void write_bit(bool bit)
+  {
+    buffer_->push_back(bit);
+  }
+
+  /**
+   * Append the low-order bits of an integer, most significant bit first.
+   *
+   * @param value - the integer containing the bits to append.
+   * @param count - the number of low-order bits to append (at most 64).
+   */
+  void write_bits(uint64_t value, size_t count)
+  {
+    buffer_->push_back_bits(value, count);
+  }
+
+  /**
+   * Append the contents of another bit vector.
+   *
+   * @param bits - the bits to append.
+   */
+  void write(const BitVectorType& bits)
+  {
+    buffer_->push_back(bits);
+  }
+
+  /**
+   * Reserve space for a number of additional bits.
+   *
+   * @param count - the number of bits that will be written.
+   */
+  void reserve(size_t count)
+  {
+    buffer_->reserve(buffer_->size() + count);
+  }
+
+  /**
+   * @return - the number of bits in the underlying bit vector, i.e., the
+   *           position at which the next bit will be written.
+   */
+  size_t size() const
+  {
+    return buffer_->size();
+  }
+
+ private:
+
+  BitVectorType* buffer_;
+};
+
+/**
+ * A read-only view of a bit vector that reads bits at arbitrary positions.
+ *
+ * The reader does not own the bit vector, which must outlive it.
+ *
+ * @tparam BitVectorType - the type of the bit vector to read from.
+ */
+template <typename BitVectorType>
+class BitVectorReader
+{
+ public:
+
+  explicit BitVectorReader(const BitVectorType& buffer)
+    : buffer_{&buffer}
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * Read a single bit.
+   *
+   * @param position - the position of the bit, which must be in range.
+   * @return - the bit at the position.
+   */
+  bool read_bit(size_t position) const
+  {
+    return (*buffer_)[position];
+  }
+
+  /**
+   * Read consecutive bits as an integer, most significant bit first.
+   *
+   * @param position - the position of the first bit to read.
+   * @param count - the number of bits to read (at most 64). The bits must be
+   *                within the bit vector.
+   * @return - the bits as the low-order bits of an integer.
+   */
+  uint64_t read_bits(size_t position, size_t count) const
+  {
+    return buffer_->get_bits(position, count);
+  }
+
+  /**
+   * Read up to count bits, padding with unset bits past the end of the bit
+   * vector.
+   *
+   * @param position - the position of the first bit to read.
+   * @param count - the number of bits to read (at most 64).
+   * @return - the bits as the low-order bits of an integer.
+   */
+  uint64_t read_bits_padded(size_t position, size_t count) const
+  {
+    auto available = position < size() ? size() - position : 0;
+    if (available >= count) {
+      return read_bits(position, count);
+    } else if (available == 0) {
+      return 0;
+    }
+    return read_bits(position, available) << (count - available);
+  }
+
+  size_t size() const
+  {
+    return buffer_->size();
+  }
+
+ private:
+
+  const BitVectorType* buffer_;
+};
+
+#endif //CAPS_BIT_CURSOR_H
@@ -8,13 +8,17 @@
 // Include C standard libraries.
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 
 // Include C++ standard libraries.
 #include <iostream>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // Include other headers from this project.
 #include "../defs.h"
+#include "packed_bits.h"
 
 // Include headers from other projects.
 
@@ -24,6 +28,24 @@ using AllocatorType = typename BitContainerType::allocator_type;
 template <typename BitContainerType>
 using RefType = typename BitContainerType::reference;
 
+/**
+ * Whether a bit container can append and read up to a word of bits at a time
+ * and append another container in bulk (as PackedBits does).
+ */
+template <typename BitContainerType, typename = void>
+struct has_word_operations: std::false_type
+{
+};
+
+template <typename BitContainerType>
+struct has_word_operations<BitContainerType, std::void_t<
+  decltype(std::declval<BitContainerType&>().append_bits(0, 0)),
+  decltype(std::declval<const BitContainerType&>().get_bits(0, 0)),
+  decltype(std::declval<BitContainerType&>().append(
+    std::declval<const BitContainerType&>()))>>: std::true_type
+{
+};
+
 /**
  * Wrapper interface for a container of bits.
  *
@@ -128,18 +150,55 @@ class BitVector
     if (reserve_space) {
       reserve(size() + bs.size());
     }
-    for (size_t i = 0; i < bs.size(); ++i) {
-      push_back(static_cast<bool>(bs[i]));
+    if constexpr (has_word_operations<BitContainerType>::value) {
+      bits_.append(bs.bits_);
+    } else {
+      for (size_t i = 0; i < bs.size(); ++i) {
+        push_back(static_cast<bool>(bs[i]));
+      }
     }
   }
 
   void push_back(BitVector&& bs, bool reserve_space = false)
   {
-    if (reserve_space) {
-      reserve(size() + bs.size());
+    push_back(static_cast<const BitVector&>(bs), reserve_space);
+  }
+
+  /**
+   * Append the low-order bits of an integer, most significant bit first.
+   *
+   * @param bits - the integer containing the bits to append.
+   * @param count - the number of low-order bits to append (at most 64).
+   */
+  void push_back_bits(uint64_t bits, size_t count)
+  {
+    if constexpr (has_word_operations<BitContainerType>::value) {
+      bits_.append_bits(bits, count);
+    } else {
+      for (size_t i = count; i > 0; --i) {
+        push_back(((bits >> (i - 1)) & 1) != 0);
+      }
     }
-    for (size_t i = 0; i < bs.size(); ++i) {
-      push_back(static_cast<bool>(bs[i]));
+  }
+
+  /**
+   * Read consecutive bits as an integer, most significant bit first.
+   *
+   * @param position - the position of the first bit to read.
+   * @param count - the number of bits to read (at most 64). The bits must be
+   *                within the bitvector.
+   * @return - the bits as the low-order bits of an integer.
+   */
+  uint64_t get_bits(size_t position, size_t count) const
+  {
+    if constexpr (has_word_operations<BitContainerType>::value) {
+      return bits_.get_bits(position, count);
+    } else {
+      uint64_t bits = 0;
+      for (size_t i = position; i < position + count; ++i) {
+        bits = (bits << 1) | static_cast<uint64_t>(bits_[i]);
+      }
+      return bits;
     }
   }
 
@@ -158,6 +217,11 @@ class BitVector
     return bits_.flip();
   }
 
+  const BitContainerType& get_container() const
+  {
+    return bits_;
+  }
+
   void pad(bool b = false)
   {
     resize(BITS_IN_CHAR * static_cast<size_t>(ceil(static_cast<double>(
@@ -176,6 +240,9 @@ bool operator==(const BitVector<BitContainerType>& lhs,
   if (lhs.size() != rhs.size()) {
     return false;
   }
+  if constexpr (has_word_operations<BitContainerType>::value) {
+    return lhs.get_container() == rhs.get_container();
+  }
   // Because the underlying container types may have non-standard iterators
   // or no iterators at all, compare by iterating over the indices.
   for (size_t i = 0; i < lhs.size(); ++i) {
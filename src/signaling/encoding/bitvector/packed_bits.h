@@ -0,0 +1,317 @@
+/**
+ * Bit container that packs bits into 64-bit words for use with BitVector.
+ */
+
+#ifndef CAPS_PACKED_BITS_H
+#define CAPS_PACKED_BITS_H
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Include C++ standard libraries.
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+
+// Include headers from other projects.
+
+/**
+ * A container of bits stored in 64-bit words.
+ *
+ * The container provides the subset of the std::vector<bool> interface used
+ * by BitVector, along with operations on up to a word of bits at a time.
+ * Bits are stored most significant bit first, so that bit i is bit
+ * (63 - i % 64) of word i / 64, and the unused bits of the last word are
+ * always unset so that containers can be compared word by word.
+ */
+class PackedBits
+{
+ public:
+
+  // Type alias declarations
+  using WordType = uint64_t;
+  using WordContainerType = std::vector<WordType>;
+  using allocator_type = WordContainerType::allocator_type;
+
+  constexpr static size_t BITS_IN_WORD = 64;
+
+  /**
+   * Proxy reference to a single bit in the container.
+   */
+  class reference
+  {
+   public:
+
+    reference(WordType* word, WordType mask)
+      : word_{word}, mask_{mask}
+    {
+      // Nothing to do here.
+    }
+
+    reference(const reference& orig) = default;
+
+    operator bool() const
+    {
+      return (*word_ & mask_) != 0;
+    }
+
+    reference& operator=(bool value)
+    {
+      if (value) {
+        *word_ |= mask_;
+      } else {
+        *word_ &= ~mask_;
+      }
+      return *this;
+    }
+
+    reference& operator=(const reference& other)
+    {
+      return *this = static_cast<bool>(other);
+    }
+
+    void flip()
+    {
+      *word_ ^= mask_;
+    }
+
+   private:
+    WordType* word_;
+    WordType mask_;
+  };
+
+  PackedBits()
+    : words_{}, size_{0}
+  {
+    // Nothing to do here.
+  }
+
+  explicit PackedBits(size_t n, bool fill_value = false)
+    : words_{}, size_{0}
+  {
+    resize(n, fill_value);
+  }
+
+  allocator_type get_allocator() const
+  {
+    return words_.get_allocator();
+  }
+
+  size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  size_t max_size() const noexcept
+  {
+    return std::numeric_limits<size_t>::max();
+  }
+
+  size_t capacity() const noexcept
+  {
+    return words_.capacity() * BITS_IN_WORD;
+  }
+
+  bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  void reserve(size_t n)
+  {
+    words_.reserve(num_words(n));
+  }
+
+  void shrink_to_fit()
+  {
+    words_.shrink_to_fit();
+  }
+
+  reference operator[](size_t n)
+  {
+    return reference{&words_[n / BITS_IN_WORD], mask(n)};
+  }
+
+  bool operator[](size_t n) const
+  {
+    return (words_[n / BITS_IN_WORD] & mask(n)) != 0;
+  }
+
+  void resize(size_t n, bool value = false)
+  {
+    if (n <= size_) {
+      words_.resize(num_words(n));
+      size_ = n;
+      clear_unused_bits();
+      return;
+    }
+    auto fill = value ? ~static_cast<WordType>(0) : 0;
+    while (size_ < n) {
+      auto count = n - size_ < BITS_IN_WORD ? n - size_ : BITS_IN_WORD;
+      append_bits(fill, count);
+    }
+  }
+
+  void push_back(bool b)
+  {
+    if (size_ % BITS_IN_WORD == 0) {
+      words_.push_back(0);
+    }
+    if (b) {
+      words_.back() |= mask(size_);
+    }
+    ++size_;
+  }
+
+  /**
+   * Append the low-order bits of a word, most significant bit first.
+   *
+   * @param bits - the word containing the bits to append.
+   * @param count - the number of low-order bits to append (at most 64).
+   */
+  void append_bits(WordType bits, size_t count)
+  {
+    if (count == 0) {
+      return;
+    }
+    if (count < BITS_IN_WORD) {
+      bits &= (static_cast<WordType>(1) << count) - 1;
+    }
+    auto offset = size_ % BITS_IN_WORD;
+    if (offset == 0) {
+      words_.push_back(bits << (BITS_IN_WORD - count));
+    } else {
+      auto free_bits = BITS_IN_WORD - offset;
+      if (count <= free_bits) {
+        words_.back() |= bits << (free_bits - count);
+      } else {
+        words_.back() |= bits >> (count - free_bits);
+        words_.push_back(bits << (BITS_IN_WORD - (count - free_bits)));
+      }
+    }
+    size_ += count;
+  }
+
+  /**
+   * Append the contents of another container.
+   *
+   * If this container ends on a word boundary, the words are copied
+   * directly. Otherwise, each word is shifted and merged into the last two
+   * words of this container.
+   *
+   * @param other - the container to append.
+   */
+  void append(const PackedBits& other)
+  {
+    if (size_ % BITS_IN_WORD == 0) {
+      words_.insert(words_.end(), other.words_.begin(), other.words_.end());
+      size_ += other.size_;
+      return;
+    }
+    auto full_words = other.size_ / BITS_IN_WORD;
+    for (size_t i = 0; i < full_words; ++i) {
+      append_bits(other.words_[i], BITS_IN_WORD);
+    }
+    auto remaining = other.size_ % BITS_IN_WORD;
+    if (remaining > 0) {
+      append_bits(other.words_.back() >> (BITS_IN_WORD - remaining),
+                  remaining);
+    }
+  }
+
+  /**
+   * Read consecutive bits as an integer, most significant bit first.
+   *
+   * @param position - the position of the first bit to read.
+   * @param count - the number of bits to read (at most 64). The bits must
+   *                be within the container.
+   * @return - the bits as the low-order bits of a word.
+   */
+  WordType get_bits(size_t position, size_t count) const
+  {
+    if (count == 0) {
+      return 0;
+    }
+    auto index = position / BITS_IN_WORD;
+    auto offset = position % BITS_IN_WORD;
+    auto bits = words_[index] << offset;
+    if (offset + count > BITS_IN_WORD) {
+      bits |= words_[index + 1] >> (BITS_IN_WORD - offset);
+    }
+    return bits >> (BITS_IN_WORD - count);
+  }
+
+  void pop_back()
+  {
+    resize(size_ - 1);
+  }
+
+  void clear()
+  {
+    words_.clear();
+    size_ = 0;
+  }
+
+  void flip()
+  {
+    for (auto& word: words_) {
+      word = ~word;
+    }
+    clear_unused_bits();
+  }
+
+  void swap(PackedBits& other)
+  {
+    words_.swap(other.words_);
+    std::swap(size_, other.size_);
+  }
+
+  const WordContainerType& get_words() const
+  {
+    return words_;
+  }
+
+ private:
+
+  static size_t num_words(size_t n)
+  {
+    return (n + BITS_IN_WORD - 1) / BITS_IN_WORD;
+  }
+
+  static WordType mask(size_t n)
+  {
+    return static_cast<WordType>(1) << (BITS_IN_WORD - 1 - n % BITS_IN_WORD);
+  }
+
+  void clear_unused_bits()
+  {
+    auto offset = size_ % BITS_IN_WORD;
+    if (offset != 0) {
+      words_.back() &= ~static_cast<WordType>(0) << (BITS_IN_WORD - offset);
+    }
+  }
+
+  WordContainerType words_;
+  size_t size_;
+};
+
+inline bool operator==(const PackedBits& lhs, const PackedBits& rhs)
+{
+  // Unused bits are always unset, so whole words can be compared.
+  return lhs.size() == rhs.size()
+         && (lhs.size() == 0
+             || std::memcmp(lhs.get_words().data(), rhs.get_words().data(),
+                            lhs.get_words().size()
+                            * sizeof(PackedBits::WordType)) == 0);
+}
+
+inline bool operator!=(const PackedBits& lhs, const PackedBits& rhs)
+{
+  return !(lhs == rhs);
+}
+
+#endif //CAPS_PACKED_BITS_H
@@ -14,33 +14,52 @@
 
 // Include other headers from this project.
 #include "bitvector/bitvector.h"
-#include "coder/char_coder.h"
+#include "defs.h"
 
 // Include headers from other projects.
 
+/**
+ * Write a bitvector to a stream as bytes, most significant bit first.
+ *
+ * If the size of the bitvector is not a multiple of the number of bits in a
+ * character, the last byte is padded with unset bits.
+ */
 template <typename BitContainerType>
 std::ostream& operator<<(std::ostream& os,
                          const BitVector<BitContainerType>& bv)
 {
-//  bv.pad();
-  CharCoder<BitVector<BitContainerType>> char_coder;
   size_t position = 0;
-  while (position < bv.size()) {
-    auto decoded = char_coder.decode(bv, position);
-    if (!decoded.has_value()) {
-      break;
-    }
-    os << decoded->first;
-    position += decoded->second;
+  for (; position + BITS_IN_CHAR <= bv.size(); position += BITS_IN_CHAR) {
+    os.put(static_cast<char>(bv.get_bits(position, BITS_IN_CHAR)));
+  }
+
+  // Pad the remaining bits, if any, into a final byte.
+  if (position < bv.size()) {
+    auto remaining = bv.size() - position;
+    os.put(static_cast<char>(bv.get_bits(position, remaining)
+                             << (BITS_IN_CHAR - remaining)));
   }
   return os;
 }
 
 // TODO: template specialization for operator<< with boost:dynamic_bitset
 
-// TODO: operator>>
-//template <typename BitContainerType>
-//std::istream& operator>>(std::istream& is,
-//                         const BitVector<BitContainerType>& bv);
+/**
+ * Read the remaining bytes of a stream into the end of a bitvector, most
+ * significant bit first.
+ */
+template <typename BitContainerType>
+std::istream& operator>>(std::istream& is, BitVector<BitContainerType>& bv)
+{
+  char c;
+  while (is.get(c)) {
+    bv.push_back_bits(static_cast<unsigned char>(c), BITS_IN_CHAR);
+  }
+  // Reaching the end of the stream is expected, so only report other errors.
+  if (is.eof() && !is.bad()) {
+    is.clear(std::ios::eofbit);
+  }
+  return is;
+}
 
 #endif //CAPS_BITVECTOR_IO_H
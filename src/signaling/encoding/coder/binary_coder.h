@@ -38,7 +38,8 @@ class BinaryCoder: public Coder<IntType, EncodingType>
 
     // If the codeword width is zero, the coder can encode any nonnegative
     // value. Otherwise, make sure the value fits into the codeword width.
-    return width_ == 0 || value < static_cast<IntType>(1 << width_);
+    return width_ == 0 || width_ >= 8 * sizeof(IntType)
+           || value < (static_cast<IntType>(1) << width_);
   }
 
   inline size_t value_size(const IntType& value) const override
@@ -59,27 +60,37 @@ class BinaryCoder: public Coder<IntType, EncodingType>
 
  protected:
 
-  void encode_impl(const IntType& value, EncodingType* encoding) const override
+  void encode_impl(const IntType& value,
+                   BitVectorWriter<EncodingType>& writer) const override
   {
     auto width = width_;
     if (width == 0) {
       width = value_size(value);
     }
+    if (width <= MAX_BULK_WIDTH) {
+      writer.write_bits(static_cast<uint64_t>(value), width);
+      return;
+    }
     for (auto i = width; i > 0; --i) {
-      encoding->push_back((1 << (i - 1) & value) != 0);
+      writer.write_bit(((value >> (i - 1)) & 1) != 0);
     }
   }
 
   std::optional<std::pair<IntType, size_t>> decode_impl(
-    const EncodingType& buffer, const size_t position) const override
+    const BitVectorReader<EncodingType>& reader,
+    const size_t position) const override
   {
-    if (width_ != 0 && buffer.size() <= position + width_) {
+    if (width_ != 0 && reader.size() < position + width_) {
       return std::nullopt;
     }
+    if (width_ != 0 && width_ <= MAX_BULK_WIDTH) {
+      return std::make_optional(std::make_pair(
+        static_cast<IntType>(reader.read_bits(position, width_)), width_));
+    }
     IntType value = 0;
-    auto end_position = width_ != 0 ? position + width_ : buffer.size();
+    auto end_position = width_ != 0 ? position + width_ : reader.size();
     for (auto i = position; i < end_position; ++i) {
-      value = (value << 1) + static_cast<IntType>(buffer[i]);
+      value = (value << 1) + static_cast<IntType>(reader.read_bit(i));
     }
     return std::make_optional(std::make_pair(value, end_position - position));
   }
@@ -87,6 +98,9 @@ class BinaryCoder: public Coder<IntType, EncodingType>
 
  private:
 
+  // The maximum number of bits that can be written or read at once.
+  constexpr static size_t MAX_BULK_WIDTH = 64;
+
   size_t width_;
 };
 
@@ -36,23 +36,20 @@ class CharCoder: public Coder<char, EncodingType>
 
  protected:
 
-  void encode_impl(const char& value, EncodingType* buffer) const override
+  void encode_impl(const char& value,
+                   BitVectorWriter<EncodingType>& writer) const override
   {
-    for (size_t i = BITS_IN_CHAR; i > 0; --i) {
-      buffer->push_back(static_cast<bool>(value >> (i - 1) & 1));
-    }
+    writer.write_bits(static_cast<unsigned char>(value), BITS_IN_CHAR);
   }
 
   std::optional<std::pair<char, size_t>> decode_impl(
-    const EncodingType& buffer, const size_t position) const override
+    const BitVectorReader<EncodingType>& reader,
+    const size_t position) const override
   {
-    if (position + BITS_IN_CHAR > buffer.size()) {
+    if (position + BITS_IN_CHAR > reader.size()) {
       return std::nullopt;
     }
-    auto c = static_cast<char>(0);
-    for(size_t i = position; i < position + BITS_IN_CHAR; ++i) {
-      c = (c << 1) + buffer[i];
-    }
+    auto c = static_cast<char>(reader.read_bits(position, BITS_IN_CHAR));
     return std::make_optional(std::make_pair(c, BITS_IN_CHAR));
   }
 };
@@ -17,6 +17,7 @@
 #include <vector>
 
 // Include other headers from this project.
+#include "char_coder.h"
 #include "coder.h"
 #include "small_int_coder.h"
 #include "huffman_coder.h"
@@ -34,6 +35,41 @@ public:
 		// Nothing to do here. 
 	}
 
+	/**
+	 * Create a coder from an existing character Huffman coder, such as one
+	 * loaded from a codebook.
+	 *
+	 * @param huffman_coder - the coder used for each character.
+	 */
+	explicit CharHuffmanCoder(HuffmanCoder<char, EncodingType> huffman_coder)
+		: huffman_coder_{std::move(huffman_coder)}
+	{
+		// Nothing to do here.
+	}
+
+	/**
+	 * Read a codebook written by get_codebook with a CharCoder and create a
+	 * decode-only coder from it.
+	 *
+	 * @param buffer - the buffer containing the codebook.
+	 * @param position - the position at which the codebook starts.
+	 * @return - the coder and the number of bits read, or std::nullopt if the
+	 *           codebook is invalid.
+	 */
+	static std::optional<std::pair<CharHuffmanCoder, size_t>> load_codebook(
+		const EncodingType& buffer, const size_t position)
+	{
+		auto char_coder = std::make_shared<CharCoder<EncodingType>>();
+		auto loaded = HuffmanCoder<char, EncodingType>::load_codebook(
+			buffer, position,
+			std::static_pointer_cast<Coder<char, EncodingType>>(char_coder));
+		if (!loaded.has_value()) {
+			return std::nullopt;
+		}
+		return std::make_optional(std::make_pair(
+			CharHuffmanCoder{std::move(loaded->first)}, loaded->second));
+	}
+
 	inline bool valid_value(const SymbolType& value) const override
 	{
 		for(const auto& ch: value){
@@ -60,20 +96,21 @@ public:
 
 protected:
 
-	void encode_impl(const SymbolType& value, EncodingType* encoding) const override
+	void encode_impl(const SymbolType& value,
+	                 BitVectorWriter<EncodingType>& writer) const override
 	{
 		for(const auto& ch: value){
-			huffman_coder_.encode(ch, encoding);
+			huffman_coder_.encode(ch, writer);
 		}
-		huffman_coder_.encode(END_OF_STRING, encoding);
+		huffman_coder_.encode(END_OF_STRING, writer);
 	}
 
 	std::optional<std::pair<SymbolType, size_t>> decode_impl(
-		const EncodingType& buffer, size_t position) const override
+		const BitVectorReader<EncodingType>& reader, size_t position) const override
 	{
 		SymbolType value{};
-		for (size_t i = position; i < buffer.size();) {
-			auto decoded = huffman_coder_.decode(buffer, i);
+		for (size_t i = position; i < reader.size();) {
+			auto decoded = huffman_coder_.decode(reader, i);
 			if (!decoded.has_value()) {
 				return std::nullopt;
 			}
@@ -15,6 +15,7 @@
 #include <utility>
 
 // Include other headers from this project.
+#include "../bitvector/bit_cursor.h"
 
 // Include headers from other projects.
 
@@ -23,6 +24,9 @@
  * Abstract base class for encoding and decoding data types in binary.
  *
  * The base class provides two inverse methods: encode and decode.
+ * Implementations write through a BitVectorWriter and read through a
+ * BitVectorReader, so encoding into an existing buffer never creates
+ * intermediate bit vectors.
  *
  * @tparam DataType - the type of data to encode/decode.
  * @tparam EncodingType - the type of the encoded data (a bit vector or array).
@@ -32,6 +36,10 @@ class Coder
 {
  public:
 
+  // Type alias declarations
+  using Writer = BitVectorWriter<EncodingType>;
+  using Reader = BitVectorReader<EncodingType>;
+
   // Default constructor is fine.
   Coder() = default;
 
@@ -84,10 +92,32 @@ class Coder
     }
 
     // Call the internal implementation of the encoding algorithm.
-    encode_impl(value, buffer);
+    Writer writer{*buffer};
+    encode_impl(value, writer);
     return buffer;
   }
 
+  /**
+   * Encode a data value and append it through a writer.
+   *
+   * Unlike the pointer-based overload, this never allocates other than to
+   * grow the buffer underlying the writer, and is the one to use when
+   * encoding many values into the same buffer.
+   *
+   * @param value - the data value to encode.
+   * @param writer - the writer to append the encoding to.
+   * @return - true if the value was encoded, or false if the value is invalid
+   *           (in which case nothing is written).
+   */
+  bool encode(const DataType& value, Writer& writer) const
+  {
+    if (!valid_value(value)) {
+      return false;
+    }
+    encode_impl(value, writer);
+    return true;
+  }
+
   /**
    * Decode part of a binary bit vector into a DataType.
    *
@@ -100,12 +130,25 @@ class Coder
   std::optional<std::pair<DataType, size_t>> decode(const EncodingType& buffer,
     const size_t position = 0) const
   {
-    if (buffer.size() <= position) {
+    return decode(Reader{buffer}, position);
+  }
+
+  /**
+   * Decode part of a binary bit vector through a reader.
+   *
+   * @param reader - the reader for the buffer to decode.
+   * @param position - the position in the buffer to begin decoding from.
+   * @return - as in the overload taking the buffer directly.
+   */
+  std::optional<std::pair<DataType, size_t>> decode(const Reader& reader,
+    const size_t position = 0) const
+  {
+    if (reader.size() <= position) {
       return std::nullopt;
     }
     // To avoid declaring default parameters in a virtual function, this
     // function cannot be overridden and simply calls decode_impl internally.
-    return decode_impl(buffer, position);
+    return decode_impl(reader, position);
   }
 
   /**
@@ -133,14 +176,10 @@ class Coder
    * the specification for encode, and the detailed specifications with
    * respect to the encoding are given in overriding member functions.
    *
-   * @param value - the value to encode.
-   * @param encoding - a pointer to the EncodingType object in which to place
-   *                   the encoding (nullptr to create a new object).
-   * @return - nullptr in case of error, or an EncodingType object containing
-   *           the new encoding at the end.
+   * @param value - the value to encode, which is always valid.
+   * @param writer - the writer to append the encoding to.
    */
-  virtual void encode_impl(const DataType& value,
-                           EncodingType* encoding) const = 0;
+  virtual void encode_impl(const DataType& value, Writer& writer) const = 0;
 
   /**
    * Implement the decoding algorithm for the coder.
@@ -149,14 +188,14 @@ class Coder
    * the specification for decode, and the detailed specifications with
    * respect to the decoding are given in overriding member functions.
    *
-   * @param buffer - the buffer from which to read.
+   * @param reader - the reader for the buffer from which to read.
    * @param position - the starting index in the buffer to read from.
    * @return - a pair representing the decoded data and the number of bits
    *           read from the buffer. If there is an error in decoding, return
    *           std::nullopt.
    */
   virtual std::optional<std::pair<DataType, size_t>> decode_impl(
-    const EncodingType& buffer, size_t position) const = 0;
+    const Reader& reader, size_t position) const = 0;
 };
 
 #endif //CAPS_CODER_H
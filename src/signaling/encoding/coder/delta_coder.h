@@ -17,6 +17,13 @@
 
 // Include headers from other projects.
 
+/**
+ * Elias delta coder for nonnegative integers.
+ *
+ * As with GammaCoder, a value n is encoded as the delta code of n + 1: the bit
+ * width w of n + 1 is gamma-coded (as w - 1, since GammaCoder accepts zero),
+ * followed by the w - 1 low-order bits of n + 1.
+ */
 template <typename IntType, typename BitVectorType>
 class DeltaCoder: public Coder<IntType, BitVectorType>
 {
@@ -35,46 +42,46 @@ class DeltaCoder: public Coder<IntType, BitVectorType>
 
   inline size_t value_size(const IntType& value) const override
   {
-    auto binary_size = binary_coder_.value_size(value);
-    return gamma_coder_.value_size(binary_size);
+    auto binary_size = binary_coder_.value_size(value + 1);
+    return gamma_coder_.value_size(binary_size - 1) + binary_size - 1;
   }
 
  protected:
 
-  void encode_impl(const IntType& value, BitVectorType* encoding) const override
+  void encode_impl(const IntType& value,
+                   BitVectorWriter<BitVectorType>& writer) const override
   {
-    std::unique_ptr<BitVectorType> buffer{binary_coder_.encode(value)};
-    gamma_coder_.encode(buffer->size(), encoding);
-    for (size_t i = 1; i < buffer->size(); ++i) {
-      encoding->push_back((*buffer)[i]);
-    }
+    auto shifted_value = value + 1;
+    auto width = binary_coder_.value_size(shifted_value);
+    gamma_coder_.encode(width - 1, writer);
+    writer.write_bits(static_cast<uint64_t>(shifted_value), width - 1);
   }
 
   std::optional<std::pair<IntType, size_t>> decode_impl(
-    const BitVectorType& buffer, const size_t position) const override
+    const BitVectorReader<BitVectorType>& reader,
+    const size_t position) const override
   {
-    auto decoded_length = gamma_coder_.decode(buffer, position);
+    auto decoded_length = gamma_coder_.decode(reader, position);
     if (!decoded_length.has_value()) {
       return std::nullopt;
     }
-    const auto& [length, length_size] = *decoded_length;
-
-    binary_coder_.set_width(length_size - 1);
-    auto decoded_value = binary_coder_.decode(buffer, position + length_size);
-    binary_coder_.set_width(0);
-    if (!decoded_value.has_value()) {
+    const auto& [extra_bits, length_size] = *decoded_length;
+    if (extra_bits >= 64
+        || position + length_size + extra_bits > reader.size()) {
       return std::nullopt;
     }
-    const auto& [value, value_size] = *decoded_value;
 
-    return std::make_optional(std::make_pair(
-      value + (1 << length), length_size + value_size - 1));
+    auto shifted_value = static_cast<IntType>(
+      (static_cast<uint64_t>(1) << extra_bits)
+      | reader.read_bits(position + length_size, extra_bits));
+    return std::make_optional(std::make_pair(shifted_value - 1,
+                                             length_size + extra_bits));
   }
 
  private:
 
   GammaCoder<size_t, BitVectorType> gamma_coder_;
-  mutable BinaryCoder<IntType, BitVectorType> binary_coder_;
+  BinaryCoder<IntType, BitVectorType> binary_coder_;
 
 };
 
@@ -20,6 +20,15 @@
 
 // Include headers from other projects.
 
+/**
+ * Elias gamma coder for nonnegative integers.
+ *
+ * Since the Elias gamma code is only defined for positive integers, a value n
+ * is encoded as the gamma code of n + 1: the bit width w of n + 1 in unary
+ * (w - 1 zeros followed by a one), followed by the w - 1 low-order bits of
+ * n + 1. The leading one of the binary representation doubles as the unary
+ * terminator.
+ */
 template <typename IntType, typename BitVectorType>
 class GammaCoder: public Coder<IntType, BitVectorType>
 {
@@ -38,46 +47,47 @@ class GammaCoder: public Coder<IntType, BitVectorType>
 
   inline size_t value_size(const IntType& value) const override
   {
-    auto binary_size = binary_coder_.value_size(value);
-    return unary_coder_.value_size(binary_size) + binary_size - 1;
+    auto binary_size = binary_coder_.value_size(value + 1);
+    return 2 * binary_size - 1;
   }
 
  protected:
 
-  void encode_impl(const IntType& value, BitVectorType* encoding) const override
+  void encode_impl(const IntType& value,
+                   BitVectorWriter<BitVectorType>& writer) const override
   {
-    std::unique_ptr<BitVectorType> buffer{binary_coder_.encode(value)};
-    unary_coder_.encode(buffer->size(), encoding);
-    encoding->pop_back();
-    encoding->push_back(*buffer);
+    auto shifted_value = value + 1;
+    auto width = binary_coder_.value_size(shifted_value);
+    unary_coder_.encode(width - 1, writer);
+    writer.write_bits(static_cast<uint64_t>(shifted_value), width - 1);
   }
 
   std::optional<std::pair<IntType, size_t>> decode_impl(
-    const BitVectorType& buffer, const size_t position) const override
+    const BitVectorReader<BitVectorType>& reader,
+    const size_t position) const override
   {
-    auto decoded_length = unary_coder_.decode(buffer, position);
+    auto decoded_length = unary_coder_.decode(reader, position);
     if (!decoded_length.has_value()) {
       return std::nullopt;
     }
-    const auto& [length, length_size] = *decoded_length;
-
-    binary_coder_.set_width(length_size);
-    auto decoded_value = binary_coder_.decode(
-      buffer, position + length_size - 1);
-    binary_coder_.set_width(0);
-    if (!decoded_value.has_value()) {
+    const auto& [extra_bits, length_size] = *decoded_length;
+    if (extra_bits >= 64
+        || position + length_size + extra_bits > reader.size()) {
       return std::nullopt;
     }
-    const auto& [value, value_size] = *decoded_value;
 
-    return std::make_optional(std::make_pair(value,
-                                             length_size + value_size - 1));
+    // The unary terminator is the leading one of the binary representation.
+    auto shifted_value = static_cast<IntType>(
+      (static_cast<uint64_t>(1) << extra_bits)
+      | reader.read_bits(position + length_size, extra_bits));
+    return std::make_optional(std::make_pair(shifted_value - 1,
+                                             length_size + extra_bits));
   }
 
  private:
 
   UnaryCoder<size_t, BitVectorType> unary_coder_;
-  mutable BinaryCoder<IntType, BitVectorType> binary_coder_;
+  BinaryCoder<IntType, BitVectorType> binary_coder_;
 };
 
 #endif //CAPS_GAMMA_CODER_H
@@ -7,16 +7,21 @@
 #define CAPS_HUFFMAN_H
 
 // Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 
 // Include C++ standard libraries.
+#include <algorithm>
+#include <iostream>
+#include <memory>
 #include <optional>
-#include <queue>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 // Include other headers from this project.
+#include "binary_coder.h"
 #include "coder.h"
 #include "delta_coder.h"
 #include "string_coder.h"
@@ -28,12 +33,53 @@ class HuffmanCoder: public Coder<SymbolType, EncodingType>
 {
  public:
 
+  // The default limit on the length of a codeword.
+  constexpr static size_t DEFAULT_MAX_CODE_LENGTH = 24;
+
+  // The largest codeword length that can be stored in the decoding codes.
+  constexpr static size_t MAX_CODE_LENGTH = 31;
+
+  /**
+   * Create a coder from a map of symbols to counts.
+   *
+   * If an optimal Huffman code has codewords longer than max_code_length
+   * bits, the code is instead built by package-merge, which gives the
+   * optimal code with no codeword longer than the limit. The limit is raised
+   * if there are too many symbols to fit, and is at most MAX_CODE_LENGTH.
+   *
+   * @tparam MapType - an iterable associative array of symbols to counts.
+   * @param counts - the map of symbols to counts.
+   * @param max_code_length - the maximum length of a codeword in bits.
+   */
   template<typename MapType>
-  explicit HuffmanCoder(const MapType& counts)
+  explicit HuffmanCoder(const MapType& counts,
+                        size_t max_code_length = DEFAULT_MAX_CODE_LENGTH)
     : encoding_map_{}, decoding_symbols_{}, decoding_indices_{},
-      decoding_codes_{}, max_length_{0}
+      decoding_codes_{}, max_length_{0}, decoding_table_{}, table_bits_{0}
+  {
+    create_codebook_generic(counts, max_code_length);
+    create_decoding_table();
+  }
+
+  /**
+   * Create a decode-only coder from canonical decoding tables, such as those
+   * read back from a codebook by load_codebook.
+   *
+   * The encoding map is not rebuilt, so the resulting coder does not consider
+   * any value valid for encoding.
+   *
+   * @param symbols - the symbols in canonical order.
+   * @param indices - for each codeword length, the index of the first symbol.
+   * @param codes - for each codeword length, the first codeword.
+   */
+  HuffmanCoder(std::vector<SymbolType> symbols, std::vector<size_t> indices,
+               std::vector<int> codes)
+    : encoding_map_{}, decoding_symbols_{std::move(symbols)},
+      decoding_indices_{std::move(indices)},
+      decoding_codes_{std::move(codes)}, max_length_{decoding_indices_.size()},
+      decoding_table_{}, table_bits_{0}
   {
-    create_codebook_generic(counts);
+    create_decoding_table();
   }
 
   inline bool valid_value(const SymbolType& value) const override
@@ -84,74 +130,74 @@ class HuffmanCoder: public Coder<SymbolType, EncodingType>
     return buffer;
   }
 
-
- protected:
-
   /**
-   * A node in the Huffman tree.
+   * Read a codebook written by get_codebook and create a decode-only coder
+   * from it.
    *
-   * Note: each leaf node *should* be owned by only one non-leaf node since
-   *       Huffman trees are binary; however, because we use a custom
-   *       comparator function when constructing the tree, we cannot use a
-   *       unique_ptr to indicate the child nodes.
+   * @param buffer - the buffer containing the codebook.
+   * @param position - the position in the buffer at which the codebook starts.
+   * @param symbol_coder - the coder used to write the symbols of the codebook.
+   * @return - the coder along with the number of bits read, or std::nullopt
+   *           if the buffer does not contain a valid codebook.
    */
-  struct HuffmanNode
+  static std::optional<std::pair<HuffmanCoder, size_t>> load_codebook(
+    const EncodingType& buffer, const size_t position,
+    std::shared_ptr<Coder<SymbolType, EncodingType>> symbol_coder)
   {
+    DeltaCoder<size_t, EncodingType> delta_size_coder;
+    DeltaCoder<int, EncodingType> delta_int_coder;
+    auto current_position = position;
 
-    /**
-     * Create a leaf node in the Huffman tree.
-     *
-     * @param symbol - the symbol represented by the node.
-     * @param count - the count of the symbol in the input corpus.
-     */
-    HuffmanNode(SymbolType symbol, int count)
-      : symbol{std::shared_ptr<SymbolType>(new SymbolType(symbol))}, count{count}, size{1},
-        zero{}, one{}
-    {
-      // Nothing to do here.
+    // Read the symbols.
+    auto num_symbols = delta_size_coder.decode(buffer, current_position);
+    if (!num_symbols.has_value()) {
+      return std::nullopt;
     }
-
-    /**
-     * Create a non-left node in the Huffman tree.
-     *
-     * @param zero - a pointer to the Huffman node following the zero edge.
-     * @param one - a pointer to the Huffman node following the one edge.
-     */
-    HuffmanNode(std::shared_ptr<HuffmanNode> zero,
-                std::shared_ptr<HuffmanNode> one)
-      : symbol{std::shared_ptr<SymbolType>()}, count{zero->count + one->count},
-        size{zero->size + one->size}, zero{std::move(zero)}, one{std::move(one)}
-    {
-      // Nothing to do here.
+    current_position += num_symbols->second;
+    std::vector<SymbolType> symbols;
+    symbols.reserve(num_symbols->first);
+    for (size_t i = 0; i < num_symbols->first; ++i) {
+      auto symbol = symbol_coder->decode(buffer, current_position);
+      if (!symbol.has_value()) {
+        return std::nullopt;
+      }
+      symbols.push_back(std::move(symbol->first));
+      current_position += symbol->second;
     }
 
-    std::shared_ptr<SymbolType> symbol;
-    int count;
-    int size;
-    std::shared_ptr<HuffmanNode> zero;
-    std::shared_ptr<HuffmanNode> one;
-  };
-
-  /**
-   * Comparison functor for Huffman node pointers.
-   */
-  struct HuffmanNodeComp
-  {
-    bool operator()(const std::shared_ptr<HuffmanNode> lhs,
-                    const std::shared_ptr<HuffmanNode> rhs) const
-    {
-      if (lhs->count == rhs->count) {
-        if (lhs->size == rhs->size) {
-          if (lhs->size == 1) {
-            return lhs->symbol > rhs->symbol;
-          }
-          return true;
-        }
-        return lhs->size > rhs->size;
+    // Read the decoding indices and codes, one of each per codeword length.
+    auto num_indices = delta_size_coder.decode(buffer, current_position);
+    if (!num_indices.has_value() || num_indices->first > MAX_CODE_LENGTH) {
+      return std::nullopt;
+    }
+    current_position += num_indices->second;
+    std::vector<size_t> indices;
+    indices.reserve(num_indices->first);
+    for (size_t i = 0; i < num_indices->first; ++i) {
+      auto index = delta_size_coder.decode(buffer, current_position);
+      if (!index.has_value()) {
+        return std::nullopt;
       }
-      return lhs->count > rhs->count;
+      indices.push_back(index->first);
+      current_position += index->second;
     }
-  };
+    std::vector<int> codes;
+    codes.reserve(num_indices->first);
+    for (size_t i = 0; i < num_indices->first; ++i) {
+      auto code = delta_int_coder.decode(buffer, current_position);
+      if (!code.has_value()) {
+        return std::nullopt;
+      }
+      codes.push_back(code->first);
+      current_position += code->second;
+    }
+
+    return std::make_optional(std::make_pair(
+      HuffmanCoder{std::move(symbols), std::move(indices), std::move(codes)},
+      current_position - position));
+  }
+
+ protected:
 
   /**
    * Comparison functor for a key-count pair.
@@ -175,22 +221,46 @@ class HuffmanCoder: public Coder<SymbolType, EncodingType>
    * @tparam MapType - an iterable associative array type that supports
    *                   iteration through key-value pairs.
    * @param counts_map - the map of symbols to counts.
+   * @param max_code_length - the maximum length of a codeword.
    */
   template <typename MapType>
-  void create_codebook_generic(const MapType& counts_map)
+  void create_codebook_generic(const MapType& counts_map,
+                               size_t max_code_length)
   {
     size_t current_length = 0;
     auto current_count = 0;
     BinaryCoder<int, EncodingType> symbol_coder;
-    auto lengths = sorted_lengths(get_code_lengths(make_tree(counts_map)));
+    if (counts_map.begin() == counts_map.end()) {
+      return;
+    }
+    auto leaves = sorted_counts(counts_map);
+    auto code_lengths = minimum_redundancy_lengths(leaves);
+
+    // Rebuild the code with limited lengths only if the Huffman code exceeds
+    // the limit, which must leave room for every symbol.
+    size_t min_code_length = 1;
+    while ((static_cast<size_t>(1) << min_code_length) < leaves.size()) {
+      ++min_code_length;
+    }
+    max_code_length = std::max(max_code_length, min_code_length);
+    max_code_length = std::min(max_code_length, MAX_CODE_LENGTH);
+    if (code_lengths.front() > max_code_length) {
+      code_lengths = package_merge(leaves, max_code_length);
+    }
+    auto lengths = sorted_lengths(leaves, code_lengths);
+
+    // A single symbol is given a length of zero, but it still needs a one-bit
+    // codeword.
+    if (lengths.size() == 1) {
+      lengths.front().second = 1;
+    }
 
     max_length_ = lengths.back().second;
+    encoding_map_.reserve(lengths.size());
     decoding_symbols_.reserve(lengths.size());
     decoding_indices_.reserve(max_length_);
     decoding_codes_.reserve(max_length_);
 
-    std::cout<<max_length_<<std::endl;
-
     for (auto pair: lengths) {
       auto symbol = pair.first;
       auto codeword_length = pair.second;
@@ -215,141 +285,300 @@ class HuffmanCoder: public Coder<SymbolType, EncodingType>
       }
 
       // Add the symbol-codeword pair to the encoding map.
-      // TODO: make sure this doesn't leak memory or see if there is a safer
-      //       way to do this.
-      EncodingType* encoding = symbol_coder.encode(current_count);
-      encoding_map_.emplace(symbol, *encoding);
-      delete encoding;
+      EncodingType encoding;
+      symbol_coder.encode(current_count, &encoding);
+      encoding_map_.emplace(symbol, std::move(encoding));
     }
   }
 
   /**
-   * Create a Huffman tree out of a mapping of keys to counts.
+   * Sort the symbols in a mapping of symbols to counts by count, breaking
+   * ties by symbol.
+   *
+   * @param counts_map - the map of symbols to counts.
+   * @return - a vector of count-symbol pairs in increasing order.
    */
   template <typename MapType>
-  std::shared_ptr<HuffmanNode> make_tree(const MapType& counts)
+  std::vector<std::pair<uint64_t, SymbolType>> sorted_counts(
+    const MapType& counts_map) const
   {
-    using PtrType = std::shared_ptr<HuffmanNode>;
-    std::priority_queue<PtrType, std::vector<PtrType>, HuffmanNodeComp> heap;
-//    auto unique_symbols = 0;  // debug
-    for (auto it: counts) {
-      const auto& [symbol, count] = it;
-//      if (count == 1) {
-//        ++unique_symbols;
-//      }
-      heap.push(std::make_shared<HuffmanNode>(symbol, count));
+    std::vector<std::pair<uint64_t, SymbolType>> leaves;
+    for (const auto& [symbol, count]: counts_map) {
+      leaves.emplace_back(static_cast<uint64_t>(count), symbol);
     }
-//    std::cerr << unique_symbols << " unique symbols" << std::endl;
-    while (heap.size() > 1) {
-      auto first = heap.top();
-      heap.pop();
-      auto second = heap.top();
-      heap.pop();
-      heap.push(std::make_shared<HuffmanNode>(first, second));
-    }
-    return heap.top();
+    std::sort(leaves.begin(), leaves.end());
+    return leaves;
   }
 
   /**
-   * Get the lengths of each encoded symbol in a Huffman tree.
+   * Get the codeword lengths of a Huffman code, using the in-place algorithm
+   * of Moffat and Katajainen.
+   *
+   * The first pass combines the two lightest items into internal nodes from
+   * left to right, reusing the array for the weights of internal nodes and
+   * the parent of each combined node. The second pass turns parent pointers
+   * into internal node depths, and the third assigns the leaf depths from
+   * the number of internal nodes at each depth.
    *
-   * @param root - a pointer to the root of the Huffman tree.
-   * @return - a map of symbols to their respective encoding lengths in bits.
+   * @param leaves - the counts and symbols, sorted by increasing count.
+   * @return - the codeword length of each leaf, in the same order (and hence
+   *           in nonincreasing order). A single symbol gets a length of zero.
    */
-  std::unordered_map<SymbolType, size_t> get_code_lengths(
-    std::shared_ptr<HuffmanNode> root) const
+  std::vector<size_t> minimum_redundancy_lengths(
+    const std::vector<std::pair<uint64_t, SymbolType>>& leaves) const
   {
-    std::unordered_map<SymbolType, size_t> code_lengths;
-
-    // Perform a breadth-first search through the Huffman tree to get the
-    // length of each codeword.
-    std::queue<std::pair<std::shared_ptr<HuffmanNode>,
-                         size_t>> bfs_queue;
-    bfs_queue.push(std::make_pair(root, 0));
-    while (!bfs_queue.empty()) {
-      std::pair<std::shared_ptr<HuffmanNode>,
-                size_t> current_node = bfs_queue.front();
-      bfs_queue.pop();
-      if (current_node.first->symbol) {
-        code_lengths.emplace(*(current_node.first->symbol),
-                             current_node.second);
+    auto n = leaves.size();
+    std::vector<uint64_t> a(n);
+    for (size_t i = 0; i < n; ++i) {
+      a[i] = leaves[i].first;
+    }
+    if (n <= 1) {
+      return std::vector<size_t>(n, 0);
+    }
+
+    // Combine the lightest two items, which are either leaves (starting at
+    // leaf) or internal nodes (starting at root), into internal node next.
+    a[0] += a[1];
+    size_t root = 0, leaf = 2;
+    for (size_t next = 1; next < n - 1; ++next) {
+      if (leaf >= n || a[root] < a[leaf]) {
+        a[next] = a[root];
+        a[root++] = next;
+      } else {
+        a[next] = a[leaf++];
+      }
+      if (leaf >= n || (root < next && a[root] < a[leaf])) {
+        a[next] += a[root];
+        a[root++] = next;
       } else {
-        bfs_queue.push(std::make_pair(current_node.first->zero,
-                                      current_node.second + 1));
-        bfs_queue.push(std::make_pair(current_node.first->one,
-                                      current_node.second + 1));
+        a[next] += a[leaf++];
       }
     }
 
-    return code_lengths;
+    // Replace the parent of each internal node with its depth.
+    a[n - 2] = 0;
+    for (auto next = n - 2; next-- > 0;) {
+      a[next] = a[a[next]] + 1;
+    }
+
+    // Assign leaf depths from the right, filling the nodes available at each
+    // depth that are not used by internal nodes.
+    std::vector<size_t> lengths(n);
+    size_t available = 1, used = 0, depth = 0, next = n;
+    auto internal = static_cast<std::ptrdiff_t>(n) - 2;
+    while (available > 0) {
+      while (internal >= 0 && a[internal] == depth) {
+        ++used;
+        --internal;
+      }
+      while (available > used) {
+        lengths[--next] = depth;
+        --available;
+      }
+      available = 2 * used;
+      ++depth;
+      used = 0;
+    }
+    return lengths;
   }
 
   /**
-   * Sort a mapping of symbol-length pairs in order of length first and
-   * return the resulting order.
+   * Get the lengths of an optimal code with no codeword longer than a limit,
+   * using the package-merge algorithm.
+   *
+   * Symbols are sorted by count, and at each level from the deepest up, the
+   * items of the level below are paired into packages and merged with the
+   * symbols by weight. The 2n - 2 lightest items of the top level give the
+   * code: each symbol's codeword length is the number of selected items that
+   * contain it. Since symbols and packages are each selected in order of
+   * weight, only the item types of each level need to be kept.
    *
-   * @param code_lengths - a mapping of symbols to their code length.
+   * @param leaves - the counts and symbols, sorted by increasing count, with
+   *                 at least two symbols.
+   * @param max_code_length - the maximum codeword length, which must be large
+   *                          enough for the number of symbols.
+   * @return - the codeword length of each leaf, in the same order.
+   */
+  std::vector<size_t> package_merge(
+    const std::vector<std::pair<uint64_t, SymbolType>>& leaves,
+    size_t max_code_length) const
+  {
+    auto num_leaves = leaves.size();
+
+    // Build the merged list of each level, recording which items are leaves.
+    // The deepest level consists of the leaves alone.
+    std::vector<std::vector<bool>> leaf_flags(max_code_length);
+    leaf_flags[max_code_length - 1].assign(num_leaves, true);
+    std::vector<uint64_t> weights;
+    std::vector<uint64_t> merged;
+    weights.reserve(2 * num_leaves);
+    merged.reserve(2 * num_leaves);
+    for (const auto& leaf: leaves) {
+      weights.push_back(leaf.first);
+    }
+    for (auto level = max_code_length - 1; level > 0; --level) {
+      auto& flags = leaf_flags[level - 1];
+      flags.reserve(num_leaves + weights.size() / 2);
+      merged.clear();
+      size_t leaf = 0, package = 0;
+      auto num_packages = weights.size() / 2;
+      while (leaf < num_leaves || package < num_packages) {
+        auto package_weight = package < num_packages
+          ? weights[2 * package] + weights[2 * package + 1] : 0;
+        if (package == num_packages
+            || (leaf < num_leaves && leaves[leaf].first <= package_weight)) {
+          merged.push_back(leaves[leaf++].first);
+          flags.push_back(true);
+        } else {
+          merged.push_back(package_weight);
+          ++package;
+          flags.push_back(false);
+        }
+      }
+      weights.swap(merged);
+    }
+
+    // Select the lightest items of the top level and follow the selected
+    // packages down through the levels.
+    std::vector<size_t> lengths(num_leaves, 0);
+    auto selected = 2 * num_leaves - 2;
+    for (size_t level = 0; level < max_code_length && selected > 0; ++level) {
+      size_t selected_leaves = 0;
+      for (size_t i = 0; i < selected; ++i) {
+        if (leaf_flags[level][i]) {
+          ++lengths[selected_leaves++];
+        }
+      }
+      selected = 2 * (selected - selected_leaves);
+    }
+    return lengths;
+  }
+
+  /**
+   * Pair each symbol with its code length and sort the pairs in order of
+   * length first.
+   *
+   * @param leaves - the counts and symbols.
+   * @param code_lengths - the code length of each symbol in leaves.
    * @return - a vector of symbol-length pairs sorted by length first, then
    *           symbol.
    */
   std::vector<std::pair<SymbolType, size_t>> sorted_lengths(
-    const std::unordered_map<SymbolType, size_t>& code_lengths) const
+    const std::vector<std::pair<uint64_t, SymbolType>>& leaves,
+    const std::vector<size_t>& code_lengths) const
   {
-    std::vector<std::pair<SymbolType, size_t>> codebook_vector{code_lengths.begin(),
-                                                        code_lengths.end()};
+    std::vector<std::pair<SymbolType, size_t>> codebook_vector;
+    codebook_vector.reserve(leaves.size());
+    for (size_t i = 0; i < leaves.size(); ++i) {
+      codebook_vector.emplace_back(leaves[i].second, code_lengths[i]);
+    }
     std::sort(codebook_vector.begin(), codebook_vector.end(), CodebookComp());
     return codebook_vector;
   }
 
-  void encode_impl(const SymbolType& value, EncodingType* encoding) const override
+  void encode_impl(const SymbolType& value,
+                   BitVectorWriter<EncodingType>& writer) const override
   {
-    encoding->push_back(encoding_map_.at(value));
+    writer.write(encoding_map_.at(value));
   }
 
-  std::optional<std::pair<SymbolType, size_t>> decode_impl(
-    const EncodingType& buffer, size_t position) const override
+  /**
+   * Fill the decoding table from the canonical decoding tables.
+   *
+   * Each codeword of at most table_bits_ bits fills every table entry that
+   * it is a prefix of, and each longer codeword marks the entry for its
+   * first table_bits_ bits as the prefix of a long codeword.
+   */
+  void create_decoding_table()
   {
-    // Build a codeword from the selected position in the buffer.
-    EncodingType codeword;
-    codeword.reserve(max_length_);
-    for (size_t i = 0; i < max_length_; ++i) {
-      if (position + i >= buffer.size()) {
-        codeword.resize(max_length_);
-      } else {
-        codeword.push_back(buffer[position + i]);
+    table_bits_ = max_length_ < LOOKUP_BITS ? max_length_ : LOOKUP_BITS;
+    decoding_table_.assign(static_cast<size_t>(1) << table_bits_,
+                           DecodingEntry{0, 0});
+    for (size_t length = 1; length <= max_length_; ++length) {
+      auto first = decoding_indices_[length - 1];
+      auto last = length < max_length_ ? decoding_indices_[length]
+                                       : decoding_symbols_.size();
+      for (auto index = first;
+           index < last && index < decoding_symbols_.size(); ++index) {
+        auto code = static_cast<uint64_t>(decoding_codes_[length - 1])
+                    + (index - first);
+        if (length >= 64 || (code >> length) != 0) {
+          // The codebook is inconsistent, so leave the codeword undecodable.
+          continue;
+        }
+        if (length <= table_bits_) {
+          auto shift = table_bits_ - length;
+          auto begin = code << shift;
+          for (auto i = begin; i < begin + (static_cast<uint64_t>(1) << shift);
+               ++i) {
+            decoding_table_[i] = DecodingEntry{static_cast<uint32_t>(index),
+                                               static_cast<uint32_t>(length)};
+          }
+        } else {
+          decoding_table_[code >> (length - table_bits_)].length =
+            static_cast<uint32_t>(length);
+        }
       }
     }
+  }
+
+  /**
+   * Decode a symbol by looking up the next table_bits_ bits in the decoding
+   * table. Codewords longer than table_bits_ bits fall back to a search over
+   * the canonical decoding tables.
+   */
+  std::optional<std::pair<SymbolType, size_t>> decode_impl(
+    const BitVectorReader<EncodingType>& reader, size_t position) const override
+  {
+    if (decoding_symbols_.empty()) {
+      return std::nullopt;
+    }
 
-    // Attempt to decode the codeword as an integer. If this fails, decoding
-    // fails as well.
-    BinaryCoder<int, EncodingType> binary_coder(max_length_);
-    auto decode_option = binary_coder.decode(codeword);
-    if (!decode_option.has_value() || decode_option->second != max_length_) {
+    // Read a codeword of maximum length from the selected position in the
+    // buffer, padding it with unset bits if the buffer ends first.
+    auto codeword = reader.read_bits_padded(position, max_length_);
+    const auto& entry =
+      decoding_table_[codeword >> (max_length_ - table_bits_)];
+    if (entry.length == 0) {
       return std::nullopt;
     }
-    auto decode_int = decode_option->first;
+    auto [index, length] = entry.length <= table_bits_
+      ? std::make_pair(static_cast<size_t>(entry.symbol_index),
+                       static_cast<size_t>(entry.length))
+      : decode_long_codeword(static_cast<int>(codeword));
+    if (index >= decoding_symbols_.size()
+        || position + length > reader.size()) {
+      return std::nullopt;
+    }
+    return std::make_pair(decoding_symbols_[index], length);
+  }
 
+  /**
+   * Find the symbol index and length of a codeword that is longer than the
+   * decoding table allows.
+   *
+   * @param decode_int - the next max_length_ bits of the buffer.
+   * @return - the index of the symbol in decoding_symbols_ (which may be out
+   *           of range for an invalid codeword) and the codeword length.
+   */
+  std::pair<size_t, size_t> decode_long_codeword(int decode_int) const
+  {
     // If the integer represented by the bits is larger than the last element
     // in the decoding codes, then the codeword is of maximum length. Look up
     // the symbol corresponding to the offset from the symbol of maximum length.
     if (decode_int >= decoding_codes_.back()) {
-      return std::make_pair(
-        decoding_symbols_[decoding_indices_[max_length_ - 1] + decode_int
-                          - decoding_codes_[max_length_ - 1]],
-        max_length_);
+      return std::make_pair(decoding_indices_[max_length_ - 1] + decode_int
+                            - decoding_codes_[max_length_ - 1],
+                            max_length_);
     }
 
     // Otherwise, perform a binary search in the decoding codes to determine
     // the length of the codeword.
     auto index = binary_search(decode_int);
-
-    // Decode the buffer to get the symbol and return it along with the
-    // codeword length.
-    return std::make_pair(
-      decoding_symbols_[decoding_indices_[index]
-                        + (decode_int >> (max_length_ - index - 1)) -
-                        decoding_codes_[index]],
-      index + 1);
+    return std::make_pair(decoding_indices_[index]
+                          + (decode_int >> (max_length_ - index - 1))
+                          - decoding_codes_[index],
+                          index + 1);
   }
 
   size_t binary_search(int codeword) const
@@ -376,6 +605,24 @@ class HuffmanCoder: public Coder<SymbolType, EncodingType>
   std::vector<size_t> decoding_indices_;
   std::vector<int> decoding_codes_;
   size_t max_length_;
+
+  /**
+   * An entry of the decoding table for a prefix of table_bits_ bits.
+   *
+   * A length of zero marks a prefix that no codeword starts with, and a
+   * length greater than table_bits_ marks the prefix of a longer codeword.
+   */
+  struct DecodingEntry
+  {
+    uint32_t symbol_index;
+    uint32_t length;
+  };
+
+  // The maximum number of bits used to index the decoding table.
+  constexpr static size_t LOOKUP_BITS = 10;
+
+  std::vector<DecodingEntry> decoding_table_;
+  size_t table_bits_;
 };
 
 #endif //CAPS_HUFFMAN_H
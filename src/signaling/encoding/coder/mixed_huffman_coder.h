@@ -36,6 +36,51 @@ public:
 		// Nothing to do here. 
 	}
 
+	/**
+	 * Create a coder from existing string and character Huffman coders, such
+	 * as those loaded from a codebook.
+	 *
+	 * @param string_coder - the coder for labels encoded as whole strings.
+	 * @param char_coder - the coder for labels encoded character by character.
+	 */
+	MixedHuffmanCoder(HuffmanCoder<SymbolType, EncodingType> string_coder,
+	                  CharHuffmanCoder<SymbolType, EncodingType> char_coder)
+		: HuffmanCoder<SymbolType, EncodingType>(std::move(string_coder)),
+		  char_huffman_coder_{std::move(char_coder)}
+	{
+		// Nothing to do here.
+	}
+
+	/**
+	 * Read a codebook written by get_codebook and create a decode-only coder
+	 * from it.
+	 *
+	 * @param buffer - the buffer containing the codebook.
+	 * @param position - the position at which the codebook starts.
+	 * @param symbol_coder - the coder used to write the string symbols.
+	 * @return - the coder and the number of bits read, or std::nullopt if the
+	 *           codebook is invalid.
+	 */
+	static std::optional<std::pair<MixedHuffmanCoder, size_t>> load_codebook(
+		const EncodingType& buffer, const size_t position,
+		std::shared_ptr<Coder<SymbolType, EncodingType>> symbol_coder)
+	{
+		auto string_coder = HuffmanCoder<SymbolType, EncodingType>::load_codebook(
+			buffer, position, symbol_coder);
+		if (!string_coder.has_value()) {
+			return std::nullopt;
+		}
+		auto char_coder = CharHuffmanCoder<SymbolType, EncodingType>::load_codebook(
+			buffer, position + string_coder->second);
+		if (!char_coder.has_value()) {
+			return std::nullopt;
+		}
+		return std::make_optional(std::make_pair(
+			MixedHuffmanCoder{std::move(string_coder->first),
+			                  std::move(char_coder->first)},
+			string_coder->second + char_coder->second));
+	}
+
 	inline bool valid_value(const SymbolType& value) const override
 	{
 		return (HuffmanCoder<SymbolType, EncodingType>::valid_value(value)) || (char_huffman_coder_.valid_value(value));
@@ -55,7 +100,7 @@ public:
 	{
 		EncodingType buffer;
 		buffer.push_back(HuffmanCoder<SymbolType, EncodingType>::get_codebook(symbol_coder));
-		auto char_label_coder = std::make_shared<CharCoder<>>();
+		auto char_label_coder = std::make_shared<CharCoder<EncodingType>>();
 		buffer.push_back(char_huffman_coder_.get_codebook(
 			std::static_pointer_cast<Coder<char, EncodingType>>(char_label_coder)));
 		return buffer;
@@ -63,25 +108,26 @@ public:
 
 protected:
 
-	void encode_impl(const SymbolType& value, EncodingType* encoding) const override
+	void encode_impl(const SymbolType& value,
+	                 BitVectorWriter<EncodingType>& writer) const override
 	{
-		if ((HuffmanCoder<SymbolType, EncodingType>::encoding_map_.find(value))
-			!=(HuffmanCoder<SymbolType, EncodingType>::encoding_map_.end())){
-			encoding->push_back(true);
-			encoding->push_back(HuffmanCoder<SymbolType, EncodingType>::encoding_map_.at(value));
+		auto it = HuffmanCoder<SymbolType, EncodingType>::encoding_map_.find(value);
+		if (it != HuffmanCoder<SymbolType, EncodingType>::encoding_map_.end()){
+			writer.write_bit(true);
+			writer.write(it->second);
 		}else{
-			encoding->push_back(false);
-			char_huffman_coder_.encode(value, encoding);
+			writer.write_bit(false);
+			char_huffman_coder_.encode(value, writer);
 		}
 	}
 
 	std::optional<std::pair<SymbolType, size_t>> decode_impl(
-		const EncodingType& buffer, size_t position) const override
+		const BitVectorReader<EncodingType>& reader, size_t position) const override
 	{
-		if (buffer[position] == true){
-			return inc_size(HuffmanCoder<SymbolType, EncodingType>::decode_impl(buffer, position+1));
+		if (reader.read_bit(position) == true){
+			return inc_size(HuffmanCoder<SymbolType, EncodingType>::decode_impl(reader, position+1));
 		}else{
-			return inc_size(char_huffman_coder_.decode(buffer, position+1));
+			return inc_size(char_huffman_coder_.decode(reader, position+1));
 		}
 	}
 
@@ -35,6 +35,42 @@ public:
 		// Nothing to do here. 
 	}
 
+	/**
+	 * Create a coder from an existing Huffman coder for the frequent labels,
+	 * such as one loaded from a codebook.
+	 *
+	 * @param huffman_coder - the coder for labels in the codebook.
+	 */
+	explicit PartialHuffmanCoder(HuffmanCoder<SymbolType, EncodingType> huffman_coder)
+		: HuffmanCoder<SymbolType, EncodingType>(std::move(huffman_coder)),
+		  small_int_coder_{}
+	{
+		// Nothing to do here.
+	}
+
+	/**
+	 * Read a codebook written by get_codebook and create a decode-only coder
+	 * from it.
+	 *
+	 * @param buffer - the buffer containing the codebook.
+	 * @param position - the position at which the codebook starts.
+	 * @param symbol_coder - the coder used to write the symbols.
+	 * @return - the coder and the number of bits read, or std::nullopt if the
+	 *           codebook is invalid.
+	 */
+	static std::optional<std::pair<PartialHuffmanCoder, size_t>> load_codebook(
+		const EncodingType& buffer, const size_t position,
+		std::shared_ptr<Coder<SymbolType, EncodingType>> symbol_coder)
+	{
+		auto loaded = HuffmanCoder<SymbolType, EncodingType>::load_codebook(
+			buffer, position, symbol_coder);
+		if (!loaded.has_value()) {
+			return std::nullopt;
+		}
+		return std::make_optional(std::make_pair(
+			PartialHuffmanCoder{std::move(loaded->first)}, loaded->second));
+	}
+
 	inline bool valid_value(const SymbolType& value) const override
 	{
 		return (HuffmanCoder<SymbolType, EncodingType>::valid_value(value)) || (small_int_coder_.valid_value(value));
@@ -51,25 +87,26 @@ public:
 
 protected:
 
-	void encode_impl(const SymbolType& value, EncodingType* encoding) const override
+	void encode_impl(const SymbolType& value,
+	                 BitVectorWriter<EncodingType>& writer) const override
 	{
-		if ((HuffmanCoder<SymbolType, EncodingType>::encoding_map_.find(value))
-			!=(HuffmanCoder<SymbolType, EncodingType>::encoding_map_.end())){
-			encoding->push_back(true);
-			encoding->push_back(HuffmanCoder<SymbolType, EncodingType>::encoding_map_.at(value));
+		auto it = HuffmanCoder<SymbolType, EncodingType>::encoding_map_.find(value);
+		if (it != HuffmanCoder<SymbolType, EncodingType>::encoding_map_.end()){
+			writer.write_bit(true);
+			writer.write(it->second);
 		}else{
-			encoding->push_back(false);
-			small_int_coder_.encode(value, encoding);
+			writer.write_bit(false);
+			small_int_coder_.encode(value, writer);
 		}
 	}
 
 	std::optional<std::pair<SymbolType, size_t>> decode_impl(
-		const EncodingType& buffer, size_t position) const override
+		const BitVectorReader<EncodingType>& reader, size_t position) const override
 	{
-		if (buffer[position] == true){
-			return inc_size(HuffmanCoder<SymbolType, EncodingType>::decode_impl(buffer, position+1));
+		if (reader.read_bit(position) == true){
+			return inc_size(HuffmanCoder<SymbolType, EncodingType>::decode_impl(reader, position+1));
 		}else{
-			return inc_size(small_int_coder_.decode(buffer, position+1));
+			return inc_size(small_int_coder_.decode(reader, position+1));
 		}
 	}
 
@@ -82,7 +119,7 @@ protected:
 		}
 	}
 
-	SmallIntCoder<> small_int_coder_;
+	SmallIntCoder<SymbolType, EncodingType> small_int_coder_;
 };
 
 
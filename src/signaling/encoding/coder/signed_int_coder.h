@@ -46,21 +46,22 @@ class SignedIntCoder: public Coder<SignedIntType, EncodingType>
  protected:
 
   void encode_impl(const SignedIntType& value,
-                   EncodingType* encoding) const override
+                   BitVectorWriter<EncodingType>& writer) const override
   {
     auto negative = (value < 0);
-    encoding->push_back(negative);
-    base_coder_->encode(negative ? -value : value, encoding);
+    writer.write_bit(negative);
+    base_coder_->encode(negative ? -value : value, writer);
   }
 
   std::optional<std::pair<SignedIntType, size_t>> decode_impl(
-    const EncodingType& buffer, const size_t position) const override
+    const BitVectorReader<EncodingType>& reader,
+    const size_t position) const override
   {
-    auto decoded_value = base_coder_->decode(buffer, position + 1);
+    auto decoded_value = base_coder_->decode(reader, position + 1);
     if (!decoded_value.has_value()) {
       return std::nullopt;
     }
-    auto negative = buffer[position];
+    auto negative = reader.read_bit(position);
     const auto& [value, size] = *decoded_value;
     return std::make_optional(std::make_pair(negative ? -value : value,
                                              size + 1));
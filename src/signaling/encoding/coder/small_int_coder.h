@@ -27,7 +27,7 @@ class SmallIntCoder: public Coder<StringType, EncodingType>
 public:
 
 	SmallIntCoder(): 
-		Coder<StringType, EncodingType>{}
+		Coder<StringType, EncodingType>{}, encode_table{}, decode_table{}
 	{
 //		for(int i=0;i<256;i++) encode_table[i] = 0;
 //		for(int i=0;i<256;i++) decode_table[i] = 0;
@@ -37,7 +37,11 @@ public:
 
 	inline bool valid_value(const StringType& value) const override
 	{
-		return !value.empty();
+		if (value.empty()) return false;
+		for(auto c: value){
+			if (ctosi(c)==0) return false;
+		}
+		return true;
 	}
 
 	inline size_t value_size(const StringType& value) const override
@@ -47,28 +51,31 @@ public:
 
 protected:
 
-	void encode_impl(const StringType& value, EncodingType* buffer) const override {
+	void encode_impl(const StringType& value,
+	                 BitVectorWriter<EncodingType>& writer) const override {
 		for(auto itr = value.begin(); itr != value.end(); ++itr){
 			auto c = ctosi(*itr);
 			for(size_t i = 0; i < ENCODING_BITS; i++){
-				buffer->push_back((bool)(c&1));
+				writer.write_bit((bool)(c&1));
 				c>>=1;
 			}
 		}
 //		char_coder_.encode(static_cast<char>(tmp), buffer);
-		for(size_t i=0;i<ENCODING_BITS;i++) buffer->push_back(true);
+		for(size_t i=0;i<ENCODING_BITS;i++) writer.write_bit(true);
 	}
 
 	std::optional<std::pair<StringType, size_t>> 
-		decode_impl(const EncodingType& buffer, const size_t position) const override {
+		decode_impl(const BitVectorReader<EncodingType>& reader,
+		            const size_t position) const override {
 		std::string value;
-		for(size_t i = position; i < buffer.size(); i+= ENCODING_BITS){
+		for(size_t i = position; i < reader.size(); i+= ENCODING_BITS){
+			// Small ints are written least significant bit first.
 			auto si = 0;
 			size_t j;
-			for(j = i; j < buffer.size() && j - i < ENCODING_BITS; j++){
-				si = (si << 1) + buffer[j];
+			for(j = i; j < reader.size() && j - i < ENCODING_BITS; j++){
+				si |= static_cast<int>(reader.read_bit(j)) << (j - i);
 			}
-			if (j==buffer.size() && j - i < ENCODING_BITS){
+			if (j==reader.size() && j - i < ENCODING_BITS){
 				return std::nullopt;
 			}
 
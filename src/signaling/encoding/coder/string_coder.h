@@ -51,19 +51,18 @@ class StringCoder: public Coder<StringType, EncodingType>
    * the end of the returned encoding, where the last character has its
    *
    * @param value - as defined in the parent method.
-   * @param encoding - as defined in the parent method.
-   * @return - as defined in the parent method.
+   * @param writer - as defined in the parent method.
    */
   void encode_impl(const StringType& value,
-                         EncodingType* buffer) const override
+                   BitVectorWriter<EncodingType>& writer) const override
   {
     for (auto itr = value.begin(); itr != value.end(); ++itr) {
       // We use encode instead of encode_impl because the latter is protected
       // in CharCoder. Discard the return value for each of these calls.
       if (std::next(itr) == value.end()) {
-        char_coder_.encode(static_cast<char>(*itr | LAST_CHAR_BIT), buffer);
+        char_coder_.encode(static_cast<char>(*itr | LAST_CHAR_BIT), writer);
       } else {
-        char_coder_.encode(*itr, buffer);
+        char_coder_.encode(*itr, writer);
       }
     }
   }
@@ -78,18 +77,19 @@ class StringCoder: public Coder<StringType, EncodingType>
    * terminator after the starting position, return std::nullopt.
    * bits returned.
    *
-   * @param buffer - as defined in the parent method.
+   * @param reader - as defined in the parent method.
    * @param position - as defined in the parent method.
    * @return - as defined in the parent method.
    */
   std::optional<std::pair<StringType, size_t>> decode_impl(
-    const EncodingType& buffer, const size_t position) const override
+    const BitVectorReader<EncodingType>& reader,
+    const size_t position) const override
   {
     std::string value;
 
-    for (size_t i = position; i < buffer.size(); i += BITS_IN_CHAR) {
+    for (size_t i = position; i < reader.size(); i += BITS_IN_CHAR) {
       // Attempt to decode a character, and return an error if this step fails.
-      auto decoded = char_coder_.decode(buffer, i);
+      auto decoded = char_coder_.decode(reader, i);
       if (!decoded.has_value()) {
         return std::nullopt;
       }
@@ -49,16 +49,20 @@ class UnaryCoder: public Coder<IntType, EncodingType>
    * true) consists of n falses followed by a true.
    *
    * @param value - as defined in the parent method.
-   * @param encoding - as defined in the parent method.
-   * @return - as defined in the parent method.
+   * @param writer - as defined in the parent method.
    */
-  void encode_impl(const IntType& value, EncodingType* buffer) const override
+  void encode_impl(const IntType& value,
+                   BitVectorWriter<EncodingType>& writer) const override
   {
     // Append the unary encoding to the buffer.
-    for (IntType i = 0; i < value; ++i) {
-      buffer->push_back(!terminator_);
+    uint64_t fill = terminator_ ? 0 : ~static_cast<uint64_t>(0);
+    auto remaining = static_cast<size_t>(value);
+    while (remaining > 0) {
+      auto count = remaining < 64 ? remaining : 64;
+      writer.write_bits(fill, count);
+      remaining -= count;
     }
-    buffer->push_back(terminator_);
+    writer.write_bit(terminator_);
   }
 
   /**
@@ -69,19 +73,29 @@ class UnaryCoder: public Coder<IntType, EncodingType>
    * return this number as the decoded value, along with this number plus one
    * as the number of decoded bits. If the buffer does not contain a
    * terminator after the starting position, return std::nullopt.
-   * bits returned.
    *
-   * @param buffer - as defined in the parent method.
+   * The buffer is scanned up to 64 bits at a time.
+   *
+   * @param reader - as defined in the parent method.
    * @param position - as defined in the parent method.
    * @return - as defined in the parent method.
    */
   std::optional<std::pair<IntType, size_t>> decode_impl(
-    const EncodingType& buffer, const size_t position) const override
+    const BitVectorReader<EncodingType>& reader,
+    const size_t position) const override
   {
-    for (size_t i = position; i < buffer.size(); ++i) {
-      if (buffer[i] == terminator_) {
-        return std::make_optional(std::make_pair(i - position,
-                                                 i - position + 1));
+    for (size_t i = position; i < reader.size(); i += 64) {
+      auto count = reader.size() - i < 64 ? reader.size() - i : 64;
+      auto bits = reader.read_bits(i, count);
+      if (!terminator_) {
+        bits = ~bits & (~static_cast<uint64_t>(0) >> (64 - count));
+      }
+      if (bits != 0) {
+        // The terminator is the most significant set bit of the chunk.
+        auto offset = static_cast<size_t>(__builtin_clzll(bits))
+                      - (64 - count);
+        auto value = i + offset - position;
+        return std::make_optional(std::make_pair(value, value + 1));
       }
     }
     return std::nullopt;
@@ -0,0 +1,758 @@
+/**
+ * Decoder and query engine for FSAs encoded by the FSA encoders.
+ */
+
+#ifndef CAPS_FSA_DECODER_H
+#define CAPS_FSA_DECODER_H
+
+// Include C standard libraries.
+#include <cstdlib>
+
+// Include C++ standard libraries.
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../graph/labeled_graph/graph.h"
+#include "../bitvector/bitvector.h"
+#include "../coder/char_huffman_coder.h"
+#include "../coder/coder.h"
+#include "../coder/delta_coder.h"
+#include "../coder/huffman_coder.h"
+#include "../coder/mixed_huffman_coder.h"
+#include "../coder/partial_huffman_coder.h"
+#include "../coder/signed_int_coder.h"
+#include "../coder/small_int_coder.h"
+#include "../coder/string_coder.h"
+#include "../fsa_encoder/fsa_format.h"
+
+/**
+ * Read-only view of an encoded FSA.
+ *
+ * The decoder keeps only the encoding itself, the codebooks read from its
+ * prefix, and the positions of every few nodes in the encoding. Nodes are
+ * identified by their order number in the encoding (the root is node 0), and
+ * queries walk the node encodings directly instead of materializing a graph.
+ *
+ * @tparam BitVectorType - the BitVector type of the encoding.
+ */
+template <typename BitVectorType>
+class FSADecoder
+{
+ public:
+
+  // Type alias declarations
+  using NodeIndex = size_t;
+  using Edge = std::pair<std::string, NodeIndex>;
+
+  // By default, record the position of every 16th node in the encoding.
+  constexpr static size_t DEFAULT_INDEX_INTERVAL = 16;
+
+  // Explicitly disallow default construction.
+  FSADecoder() = delete;
+
+  // Default rule-of-five methods are fine.
+  FSADecoder(const FSADecoder& orig) = default;
+  FSADecoder(FSADecoder&& orig) noexcept = default;
+  FSADecoder& operator=(const FSADecoder& orig) = default;
+  FSADecoder& operator=(FSADecoder&& orig) noexcept = default;
+  virtual ~FSADecoder() = default;
+
+  /**
+   * Create a decoder from an encoded FSA.
+   *
+   * The whole encoding is checked when loading, so queries on the returned
+   * decoder do not need to handle malformed input.
+   *
+   * @param buffer - the encoding, as returned by FSAEncoder::encode. Any
+   *                 padding after the last node is ignored.
+   * @param index_interval - the decoder records the position of every
+   *                         index_interval-th node. Larger intervals use
+   *                         less memory but make each node lookup slower.
+   * @param count_paths - whether to count the strings accepted from every
+   *                      node, which rank, select and count_prefix need, at
+   *                      the cost of a word of memory per node.
+   * @return - the decoder, or std::nullopt if the buffer is not a valid
+   *           encoding.
+   */
+  static std::optional<FSADecoder> load(
+    BitVectorType buffer, size_t index_interval = DEFAULT_INDEX_INTERVAL,
+    bool count_paths = false)
+  {
+    FSADecoder decoder{std::move(buffer), index_interval};
+    size_t position = 0;
+    if (!decoder.read_header(position) || !decoder.read_prefix(position)
+        || !decoder.index_nodes(position)
+        || (count_paths && !decoder.count_paths())) {
+      return std::nullopt;
+    }
+    return std::make_optional(std::move(decoder));
+  }
+
+  /**
+   * Check whether the encoded FSA accepts a string.
+   *
+   * @param str - the string to check.
+   * @return - true if the string is accepted and false otherwise.
+   */
+  bool has_string(const std::string& str) const
+  {
+    if (num_nodes_ == 0) {
+      return false;
+    }
+
+    // Edge labels may span several characters, and more than one label out
+    // of a node may start with the same character, so keep a stack of
+    // partial matches to try.
+    std::vector<std::pair<NodeIndex, size_t>> stack;
+    stack.emplace_back(0, 0);
+    while (!stack.empty()) {
+      auto [node, matched] = stack.back();
+      stack.pop_back();
+      auto position = node_position(node);
+      auto accept = buffer_[position++];
+      if (matched == str.size()) {
+        if (accept) {
+          return true;
+        }
+        continue;
+      }
+
+      // Labels are encoded in sorted order, so stop once the first character
+      // of a label is past the next character of the string.
+      auto next_char = static_cast<unsigned char>(str[matched]);
+      while (buffer_[position]) {
+        auto [label, destination, size] = *read_edge(node, position + 1);
+        position += size + 1;
+        if (static_cast<unsigned char>(label.front()) > next_char) {
+          break;
+        }
+        if (str.compare(matched, label.size(), label) == 0) {
+          stack.emplace_back(destination, matched + label.size());
+        }
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Check whether the encoded FSA accepts each of a batch of strings, as
+   * FSALexicon::has_strings does for a graph.
+   *
+   * The strings are looked up in sorted order, and each lookup starts from
+   * the positions reached by its longest common prefix with the previous
+   * string, so the nodes along shared prefixes are decoded once per batch
+   * rather than once per string.
+   *
+   * @param strings - the strings to check, in any order.
+   * @return - for each string, whether it is accepted.
+   */
+  std::vector<bool> has_strings(
+    const std::vector<std::string_view>& strings) const
+  {
+    std::vector<bool> found(strings.size(), false);
+    if (num_nodes_ == 0) {
+      return found;
+    }
+    std::vector<size_t> order(strings.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&strings](size_t lhs, size_t rhs) {
+      return strings[lhs] < strings[rhs];
+    });
+
+    // The positions reached by each prefix of the previous string, up to the
+    // longest one that the FSA has a path for.
+    std::vector<std::vector<LabelPosition>> path{{{0, {}}}};
+    size_t depth = 0;
+    std::string_view previous;
+    for (auto idx: order) {
+      auto str = strings[idx];
+      auto length = std::min(previous.length(), str.length());
+      auto common = static_cast<size_t>(
+        std::mismatch(str.begin(), str.begin() + length, previous.begin()).first
+        - str.begin());
+      depth = std::min(depth, common);
+      previous = str;
+      while (depth < str.length()) {
+        if (path.size() == depth + 1) {
+          path.emplace_back();
+        }
+        step_positions(path[depth], str[depth], path[depth + 1]);
+        if (path[depth + 1].empty()) {
+          break;
+        }
+        ++depth;
+      }
+      found[idx] = depth == str.length()
+                   && std::any_of(path[depth].begin(), path[depth].end(),
+                                  [this](const LabelPosition& position) {
+                                    return position.second.empty()
+                                           && get_accept(position.first);
+                                  });
+    }
+    return found;
+  }
+
+  /**
+   * Get the position of a string among the accepted strings in
+   * lexicographic order, as PathCounts::rank does for a graph.
+   *
+   * The decoder must have been loaded with count_paths.
+   *
+   * @param str - the string.
+   * @return - the number of accepted strings less than str, or std::nullopt
+   *           if str is not accepted.
+   */
+  std::optional<size_t> rank(const std::string& str) const
+  {
+    if (num_nodes_ == 0) {
+      return std::nullopt;
+    }
+
+    // The strings that branch off each partial match to the left all sort
+    // before str.
+    size_t rank = 0;
+    bool found = false;
+    std::vector<std::pair<NodeIndex, size_t>> stack;
+    stack.emplace_back(0, 0);
+    while (!stack.empty()) {
+      auto [node, matched] = stack.back();
+      stack.pop_back();
+      auto position = node_position(node);
+      auto accept = buffer_[position++];
+      if (matched == str.size()) {
+        found = found || accept;
+        continue;
+      }
+      if (accept) {
+        ++rank;
+      }
+      while (buffer_[position]) {
+        auto [label, destination, size] = *read_edge(node, position + 1);
+        position += size + 1;
+        auto order = str.compare(matched, label.size(), label);
+        if (order == 0) {
+          stack.emplace_back(destination, matched + label.size());
+        } else if (order > 0) {
+          rank += path_counts_[destination];
+        } else {
+          // The rest of the labels are even greater.
+          break;
+        }
+      }
+    }
+    return found ? std::make_optional(rank) : std::nullopt;
+  }
+
+  /**
+   * Get an accepted string by its position in lexicographic order.
+   *
+   * The decoder must have been loaded with count_paths.
+   *
+   * @param rank - the position of the string.
+   * @return - the string, or std::nullopt if rank is not less than the
+   *           number of accepted strings.
+   */
+  std::optional<std::string> select(size_t rank) const
+  {
+    if (num_nodes_ == 0 || rank >= path_counts_.front()) {
+      return std::nullopt;
+    }
+    std::string str;
+    NodeIndex node = 0;
+    while (!get_accept(node) || rank > 0) {
+      if (get_accept(node)) {
+        --rank;
+      }
+      for (auto& [label, destination]: get_out_edges(node)) {
+        if (rank < path_counts_[destination]) {
+          str += label;
+          node = destination;
+          break;
+        }
+        rank -= path_counts_[destination];
+      }
+    }
+    return str;
+  }
+
+  /**
+   * Count the accepted strings that start with a prefix.
+   *
+   * The decoder must have been loaded with count_paths.
+   *
+   * @param prefix - the prefix, which may end within a label.
+   * @return - the number of strings.
+   */
+  size_t count_prefix(const std::string& prefix) const
+  {
+    if (num_nodes_ == 0) {
+      return 0;
+    }
+    size_t count = 0;
+    std::vector<std::pair<NodeIndex, size_t>> stack;
+    stack.emplace_back(0, 0);
+    while (!stack.empty()) {
+      auto [node, matched] = stack.back();
+      stack.pop_back();
+      if (matched == prefix.size()) {
+        count += path_counts_[node];
+        continue;
+      }
+      auto position = node_position(node) + 1;
+      auto next_char = static_cast<unsigned char>(prefix[matched]);
+      while (buffer_[position]) {
+        auto [label, destination, size] = *read_edge(node, position + 1);
+        position += size + 1;
+        if (static_cast<unsigned char>(label.front()) > next_char) {
+          break;
+        }
+        auto length = std::min(label.size(), prefix.size() - matched);
+        if (prefix.compare(matched, length, label, 0, length) != 0) {
+          continue;
+        }
+        // A prefix that ends within the label counts every string through
+        // the edge.
+        if (length < label.size()) {
+          count += path_counts_[destination];
+        } else {
+          stack.emplace_back(destination, matched + length);
+        }
+      }
+    }
+    return count;
+  }
+
+  /**
+   * @return - whether the decoder was loaded with count_paths.
+   */
+  bool has_path_counts() const
+  {
+    return path_counts_.size() == num_nodes_;
+  }
+
+  /**
+   * Get whether a node is an accept node.
+   *
+   * @param node - the order number of the node.
+   * @return - true if the node is an accept node and false otherwise.
+   */
+  bool get_accept(NodeIndex node) const
+  {
+    return buffer_[node_position(node)];
+  }
+
+  /**
+   * Get the out-edges of a node in label order.
+   *
+   * @param node - the order number of the node.
+   * @return - the label and destination of each out-edge of the node.
+   */
+  std::vector<Edge> get_out_edges(NodeIndex node) const
+  {
+    std::vector<Edge> edges;
+    auto position = node_position(node) + 1;
+    while (buffer_[position]) {
+      auto [label, destination, size] = *read_edge(node, position + 1);
+      position += size + 1;
+      edges.emplace_back(std::move(label), destination);
+    }
+    return edges;
+  }
+
+  /**
+   * Rebuild the encoded FSA in a graph.
+   *
+   * Nodes are created in their encoding order and every edge is added with
+   * its decoded label, so the result is equal to the graph that was encoded.
+   *
+   * @param graph - a graph consisting only of its root node, which becomes
+   *                the root of the decoded FSA.
+   */
+  void decode_graph(LabeledGraph& graph) const
+  {
+    if (num_nodes_ == 0) {
+      return;
+    }
+    std::vector<Node*> nodes;
+    nodes.reserve(num_nodes_);
+    nodes.push_back(graph.get_root());
+    while (nodes.size() < num_nodes_) {
+      nodes.push_back(graph.add_node());
+    }
+
+    // Nodes are stored consecutively, so read them in a single pass rather
+    // than looking each one up in the index.
+    auto position = node_positions_.front();
+    for (NodeIndex node = 0; node < num_nodes_; ++node) {
+      graph.set_accept(nodes[node], buffer_[position++]);
+      while (buffer_[position++]) {
+        auto [label, destination, size] = *read_edge(node, position);
+        position += size;
+        graph.add_edge(nodes[node], nodes[destination], label);
+      }
+    }
+  }
+
+  FSAFormat get_format() const
+  {
+    return format_;
+  }
+
+  size_t get_num_nodes() const
+  {
+    return num_nodes_;
+  }
+
+  /**
+   * Get the approximate memory used by the decoder, excluding codebooks.
+   *
+   * @return - the size of the encoding, node index and path counts in
+   *           bytes.
+   */
+  size_t memory_size() const
+  {
+    return buffer_.capacity() / BITS_IN_CHAR
+           + node_positions_.capacity() * sizeof(size_t)
+           + path_counts_.capacity() * sizeof(size_t);
+  }
+
+ protected:
+
+  // A position in the FSA, viewed as if every edge had a single character:
+  // the rest of the label of an edge, which is empty at a node, and its
+  // destination.
+  using LabelPosition = std::pair<NodeIndex, std::string>;
+
+  /**
+   * Get the positions after a character from a set of positions.
+   *
+   * @param positions - the positions.
+   * @param c - the character.
+   * @param next - the set to replace with the positions after c.
+   */
+  void step_positions(const std::vector<LabelPosition>& positions, char c,
+                      std::vector<LabelPosition>& next) const
+  {
+    next.clear();
+    for (const auto& [node, rest]: positions) {
+      if (!rest.empty()) {
+        if (rest.front() == c) {
+          next.emplace_back(node, rest.substr(1));
+        }
+        continue;
+      }
+      // Labels are encoded in sorted order, so stop once the first character
+      // of a label is past c.
+      auto position = node_position(node) + 1;
+      while (buffer_[position]) {
+        auto [label, destination, size] = *read_edge(node, position + 1);
+        position += size + 1;
+        if (static_cast<unsigned char>(label.front())
+            > static_cast<unsigned char>(c)) {
+          break;
+        }
+        if (label.front() == c) {
+          next.emplace_back(destination, label.substr(1));
+        }
+      }
+    }
+  }
+
+  /**
+   * A decoded edge along with the size of its encoding in bits.
+   */
+  struct DecodedEdge
+  {
+    std::string label;
+    NodeIndex destination;
+    size_t size;
+  };
+
+  FSADecoder(BitVectorType buffer, size_t index_interval)
+    : buffer_{std::move(buffer)}, format_{FSAFormat::kPlain}, num_nodes_{0},
+      label_coder_{}, destination_coder_{},
+      index_interval_{index_interval == 0 ? 1 : index_interval},
+      node_positions_{}, path_counts_{}
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * Read the format and number of nodes written by FSAEncoder::add_header.
+   *
+   * @param position - the position of the header, which is advanced past it.
+   * @return - true if the header is valid and false otherwise.
+   */
+  bool read_header(size_t& position)
+  {
+    DeltaCoder<size_t, BitVectorType> size_coder;
+    auto format = size_coder.decode(buffer_, position);
+    if (!format.has_value()
+        || format->first > static_cast<size_t>(FSAFormat::kChar)) {
+      return false;
+    }
+    format_ = static_cast<FSAFormat>(format->first);
+    position += format->second;
+
+    auto num_nodes = size_coder.decode(buffer_, position);
+    if (!num_nodes.has_value()) {
+      return false;
+    }
+    num_nodes_ = num_nodes->first;
+    position += num_nodes->second;
+    return true;
+  }
+
+  /**
+   * Set up the label and destination coders for the format, reading any
+   * codebooks written by the add_prefix method of the encoder.
+   *
+   * @param position - the position of the prefix, which is advanced past it.
+   * @return - true if the prefix is valid and false otherwise.
+   */
+  bool read_prefix(size_t& position)
+  {
+    using LabelType = std::string;
+    using LabelAbstractType = Coder<LabelType, BitVectorType>;
+    using DestType = int;
+    using DestAbstractType = Coder<DestType, BitVectorType>;
+
+    auto string_coder = std::static_pointer_cast<LabelAbstractType>(
+      std::make_shared<StringCoder<LabelType, BitVectorType>>());
+    switch (format_) {
+      case FSAFormat::kPlain:
+        label_coder_ = string_coder;
+        break;
+      case FSAFormat::kChar:
+        label_coder_ = std::make_shared<SmallIntCoder<LabelType,
+                                                      BitVectorType>>();
+        break;
+      case FSAFormat::kHuffman:
+        label_coder_ = load_coder(HuffmanCoder<LabelType, BitVectorType>::
+          load_codebook(buffer_, position, string_coder), position);
+        break;
+      case FSAFormat::kMixedHuffman:
+        label_coder_ = load_coder(MixedHuffmanCoder<LabelType, BitVectorType>::
+          load_codebook(buffer_, position, string_coder), position);
+        break;
+      case FSAFormat::kPartialHuffman:
+        label_coder_ = load_coder(PartialHuffmanCoder<LabelType,
+                                                      BitVectorType>::
+          load_codebook(buffer_, position, string_coder), position);
+        break;
+      case FSAFormat::kCharHuffman:
+        label_coder_ = load_coder(CharHuffmanCoder<LabelType, BitVectorType>::
+          load_codebook(buffer_, position), position);
+        break;
+    }
+    if (!label_coder_) {
+      return false;
+    }
+
+    // Only the plain and character formats leave the destination coder as
+    // the default; every other format writes a Huffman codebook for it.
+    if (format_ == FSAFormat::kPlain || format_ == FSAFormat::kChar) {
+      destination_coder_ = std::make_shared<DeltaCoder<DestType,
+                                                       BitVectorType>>();
+    } else {
+      auto dest_coder = std::make_shared<SignedIntCoder<DestType,
+                                                        BitVectorType>>(
+        new DeltaCoder<DestType, BitVectorType>);
+      destination_coder_ = load_coder(
+        HuffmanCoder<DestType, BitVectorType>::load_codebook(
+          buffer_, position,
+          std::static_pointer_cast<DestAbstractType>(dest_coder)),
+        position);
+    }
+    return static_cast<bool>(destination_coder_);
+  }
+
+  /**
+   * Record the position of every index_interval_-th node, checking that
+   * every node in the encoding can be decoded.
+   *
+   * @param position - the position of the first node.
+   * @return - true if all nodes are valid and false otherwise.
+   */
+  bool index_nodes(size_t position)
+  {
+    node_positions_.reserve(num_nodes_ / index_interval_ + 1);
+    for (NodeIndex node = 0; node < num_nodes_; ++node) {
+      if (node % index_interval_ == 0) {
+        node_positions_.push_back(position);
+      }
+      if (position >= buffer_.size()) {
+        return false;
+      }
+      ++position;
+      while (true) {
+        if (position >= buffer_.size()) {
+          return false;
+        }
+        if (!buffer_[position++]) {
+          break;
+        }
+        auto edge = read_edge(node, position);
+        if (!edge.has_value() || edge->destination >= num_nodes_) {
+          return false;
+        }
+        position += edge->size;
+      }
+    }
+    buffer_.shrink_to_fit();
+    node_positions_.shrink_to_fit();
+    return true;
+  }
+
+  /**
+   * Count the strings accepted from every node reachable from the root, in
+   * a depth-first search that finishes each node after its children.
+   *
+   * @return - true if the encoded FSA is acyclic and false otherwise.
+   */
+  bool count_paths()
+  {
+    // A node is unvisited, on the search stack, or counted.
+    enum class State: char { unvisited, open, counted };
+    std::vector<State> states(num_nodes_, State::unvisited);
+    path_counts_.assign(num_nodes_, 0);
+    if (num_nodes_ == 0) {
+      return true;
+    }
+
+    struct Frame
+    {
+      NodeIndex node;
+      std::vector<Edge> edges;
+      size_t next;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({0, get_out_edges(0), 0});
+    states[0] = State::open;
+    while (!stack.empty()) {
+      auto& frame = stack.back();
+      if (frame.next < frame.edges.size()) {
+        auto child = frame.edges[frame.next++].second;
+        if (states[child] == State::open) {
+          return false;
+        }
+        if (states[child] == State::unvisited) {
+          states[child] = State::open;
+          stack.push_back({child, get_out_edges(child), 0});
+        }
+        continue;
+      }
+      size_t count = get_accept(frame.node) ? 1 : 0;
+      for (const auto& [label, child]: frame.edges) {
+        count += path_counts_[child];
+      }
+      path_counts_[frame.node] = count;
+      states[frame.node] = State::counted;
+      stack.pop_back();
+    }
+    path_counts_.shrink_to_fit();
+    return true;
+  }
+
+  /**
+   * Find the position of a node's encoding by skipping forward from the
+   * closest indexed node.
+   *
+   * @param node - the order number of the node.
+   * @return - the position of the accept bit of the node.
+   */
+  size_t node_position(NodeIndex node) const
+  {
+    auto position = node_positions_[node / index_interval_];
+    for (size_t i = 0; i < node % index_interval_; ++i) {
+      ++position;
+      while (buffer_[position++]) {
+        position += read_edge(node, position)->size;
+      }
+    }
+    return position;
+  }
+
+  /**
+   * Decode an edge as written by FSAEncoder::encode_edge.
+   *
+   * @param source - the order number of the source node.
+   * @param position - the position of the encoding of the label.
+   * @return - the decoded edge, or std::nullopt if decoding fails.
+   */
+  std::optional<DecodedEdge> read_edge(NodeIndex source,
+                                       size_t position) const
+  {
+    auto label = label_coder_->decode(buffer_, position);
+    if (!label.has_value() || label->first.empty()) {
+      return std::nullopt;
+    }
+    auto current_position = position + label->second;
+    if (current_position >= buffer_.size()) {
+      return std::nullopt;
+    }
+
+    // The destination is either the next node in the ordering, or a signed
+    // difference from the order number of the source.
+    NodeIndex destination = source + 1;
+    if (!buffer_[current_position++]) {
+      if (current_position >= buffer_.size()) {
+        return std::nullopt;
+      }
+      bool negative = buffer_[current_position++];
+      auto diff = destination_coder_->decode(buffer_, current_position);
+      if (!diff.has_value() || diff->first <= 0) {
+        return std::nullopt;
+      }
+      current_position += diff->second;
+      auto offset = static_cast<NodeIndex>(diff->first);
+      if (negative && offset > source) {
+        return std::nullopt;
+      }
+      destination = negative ? source - offset : source + offset;
+    }
+    return std::make_optional(DecodedEdge{std::move(label->first),
+                                          destination,
+                                          current_position - position});
+  }
+
+  /**
+   * Take ownership of a coder loaded from a codebook.
+   *
+   * @param loaded - the loaded coder and the size of its codebook.
+   * @param position - the position of the codebook, which is advanced past
+   *                   it if the coder was loaded.
+   * @return - a pointer to the coder, or the null pointer if loading failed.
+   */
+  template <typename LoadedType>
+  static std::shared_ptr<LoadedType> load_coder(
+    std::optional<std::pair<LoadedType, size_t>> loaded, size_t& position)
+  {
+    if (!loaded.has_value()) {
+      return nullptr;
+    }
+    position += loaded->second;
+    return std::make_shared<LoadedType>(std::move(loaded->first));
+  }
+
+  BitVectorType buffer_;
+  FSAFormat format_;
+  size_t num_nodes_;
+
+  std::shared_ptr<Coder<std::string, BitVectorType>> label_coder_;
+  std::shared_ptr<Coder<int, BitVectorType>> destination_coder_;
+
+  size_t index_interval_;
+  std::vector<size_t> node_positions_;
+  // The number of strings accepted from each node, if counted at loading.
+  std::vector<size_t> path_counts_;
+};
+
+#endif //CAPS_FSA_DECODER_H
@@ -39,17 +39,22 @@ public:
 			std::static_pointer_cast<DestCoderType>(destination_coder);
 */	}
 
-/*
 protected:
 
+	FSAFormat format() const override
+	{
+		return FSAFormat::kChar;
+	}
+/*
+
   std::unordered_map<int, int> get_ordering_diff_counts(
     const FSALexicon& lexicon) const
   {
     std::unordered_map<int, int> diff_counts;
-    for (const auto& source: lexicon.get_graph().get_nodes()) {
+    for (auto source: lexicon.get_graph().get_nodes()) {
       for (const auto& [label, child]: source->get_out_edges()) {
         auto diff = FSAEncoder<BitVectorType>::node_to_order_.at(child)
-          - FSAEncoder<BitVectorType>::node_to_order_.at(source.get());
+          - FSAEncoder<BitVectorType>::node_to_order_.at(source);
         diff = diff < 0 ? -diff : diff;
         if (diff_counts.find(diff) == diff_counts.end()) {
           diff_counts[diff] = 1;
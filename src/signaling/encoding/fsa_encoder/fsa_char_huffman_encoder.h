@@ -29,7 +29,7 @@ class FSACharHuffmanEncoder: public FSAEncoder<BitVectorType>
     : FSAEncoder<BitVectorType>{lexicon}
   {
     FSAEncoder<BitVectorType>::order_nodes();
-    auto diff_counts = get_ordering_diff_counts(lexicon);
+    auto diff_counts = FSAEncoder<BitVectorType>::get_ordering_diff_counts();
     auto destination_coder = std::make_shared<HuffmanCoder<int, BitVectorType>>(
       diff_counts);
     using DestCoderType = Coder<int, BitVectorType>;
@@ -47,6 +47,11 @@ class FSACharHuffmanEncoder: public FSAEncoder<BitVectorType>
 
  protected:
 
+  FSAFormat format() const override
+  {
+    return FSAFormat::kCharHuffman;
+  }
+
   void add_prefix(BitVectorType& buffer) override
   {
 //    std::cerr << "Adding prefix" << std::endl;
@@ -76,29 +81,10 @@ class FSACharHuffmanEncoder: public FSAEncoder<BitVectorType>
     buffer.push_back(dest_codebook);
   }
 
-  const LabeledGraph::LabelMap& get_label_counts(
+  LabeledGraph::LabelMap get_label_counts(
     const FSALexicon& lexicon) const
   {
-    return const_cast<const LabeledGraph::LabelMap&>(lexicon.get_graph().get_label_counts());
-  }
-
-  std::unordered_map<int, int> get_ordering_diff_counts(
-    const FSALexicon& lexicon) const
-  {
-    std::unordered_map<int, int> diff_counts;
-    for (const auto& source: lexicon.get_graph().get_nodes()) {
-      for (const auto& [label, child]: source->get_out_edges()) {
-        auto diff = FSAEncoder<BitVectorType>::node_to_order_.at(child)
-          - FSAEncoder<BitVectorType>::node_to_order_.at(source.get());
-        diff = diff < 0 ? -diff : diff;
-        if (diff_counts.find(diff) == diff_counts.end()) {
-          diff_counts[diff] = 1;
-        } else {
-          ++diff_counts[diff];
-        }
-      }
-    }
-    return diff_counts;
+    return lexicon.get_graph().get_label_counts();
   }
 
   std::unordered_map<char, size_t> get_new_counts(const LabeledGraph::LabelMap& counts) const{
@@ -6,17 +6,26 @@
 #define CAPS_FSA_ENCODER_H
 
 // Include standard C++ libraries.
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <stack>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 // Include other headers from this projects.
 #include "../../common/contains.h"
 #include "../../common/compare.h"
-#include "../../graph/ordering.h"
+#include "../../graph/frozen_graph/frozen_graph.h"
 #include "../../lexicon/fsa_lexicon/fsa_lexicon.h"
+#include "../bitvector/bit_cursor.h"
 #include "../bitvector/bitvector.h"
 #include "../coder/string_coder.h"
 #include "../coder/binary_coder.h"
+#include "../coder/delta_coder.h"
+#include "fsa_format.h"
 
 /**
  * Base class for a generic FSA encoder.
@@ -29,7 +38,7 @@ class FSAEncoder
  public:
 
   // Type alias declarations
-  using NodeHandle = const Node*;
+  using NodeHandle = FrozenGraph::NodeId;
   using Dist = int;
 
   // Explicitly disallow default construction.
@@ -38,12 +47,15 @@ class FSAEncoder
   /**
    * Constructor.
    *
-   * Create an FSAEncoder instance from a graph.
+   * Create an FSAEncoder instance from a lexicon. The encoder reads the
+   * lexicon's graph through a FrozenGraph copy, so later changes to the
+   * lexicon are not reflected in the encoding.
    *
-   * @param graph - a constant reference to the graph for the encoder to encode.
+   * @param lexicon - a constant reference to the lexicon to encode.
    */
   explicit FSAEncoder(const FSALexicon& lexicon)
-    : lexicon_{lexicon}, node_to_order_{}, order_to_node_{}
+    : lexicon_{lexicon}, graph_{lexicon.get_graph()}, node_to_order_{},
+      order_to_node_{}, label_codes_{}
   {
     // Nothing to do here.
     auto label_coder =
@@ -52,7 +64,7 @@ class FSAEncoder
     label_coder_ = std::static_pointer_cast<LabelCoderType>(label_coder);
 
     auto destination_coder =
-      std::make_shared<BinaryCoder<int, BitVectorType>>();
+      std::make_shared<DeltaCoder<int, BitVectorType>>();
     using DestCoderType = Coder<int, BitVectorType>;
     destination_coder_ = std::static_pointer_cast<DestCoderType>(
       destination_coder);
@@ -66,8 +78,13 @@ class FSAEncoder
   virtual ~FSAEncoder() = default;
 
   /**
+   * Encode the lexicon.
    *
-   * @return
+   * Nodes and edges are written directly to the returned buffer, so apart
+   * from growing the buffer, the encoding pass does not allocate per node or
+   * per edge.
+   *
+   * @return - the encoding of the lexicon.
    */
   virtual BitVectorType encode()
   {
@@ -75,9 +92,9 @@ class FSAEncoder
     BitVectorType buffer;
     add_header(buffer);
     add_prefix(buffer);
-    for (const auto& [index, node]: order_to_node_) {
-      auto node_encoding = encode_node(node);
-      buffer.push_back(node_encoding);
+    BitVectorWriter<BitVectorType> writer{buffer};
+    for (auto node: order_to_node_) {
+      encode_node(node, writer);
     }
     add_suffix(buffer);
     return buffer;
@@ -110,11 +127,13 @@ class FSAEncoder
 
     // The DFS explores children by maximum distance from the sink node (desc.)
     auto distance_map = max_distances();
-    std::unordered_set<NodeHandle> visited;
+    std::vector<bool> visited(graph_.get_num_nodes(), false);
+    node_to_order_.assign(graph_.get_num_nodes(), -1);
+    order_to_node_.reserve(graph_.get_num_nodes());
 
     // Populate DFS stack with root node
     std::stack<NodeHandle> stack;
-    stack.emplace(lexicon_.get_graph().get_root());
+    stack.emplace(graph_.get_root());
 
     // Set up queue for ordering child nodes in the DFS
     std::priority_queue<PairType, std::vector<PairType>,
@@ -124,17 +143,17 @@ class FSAEncoder
     while (!stack.empty()) {
       auto node = stack.top();
       stack.pop();
-      if (visited.find(node) != visited.end()) {
+      if (visited[node]) {
         continue;
       }
-      auto order_number = node_to_order_.size();
-      //std::cout << "node_to_order_[" << node->get_id() << "] = " << order_number << std::endl;
-      node_to_order_.emplace(node, static_cast<int>(order_number));
-      order_to_node_.emplace(order_number, node);
-      visited.emplace(node);
-      
-      for (const auto& [label, child]: node->get_out_edges()) {
-        queue.emplace(child, distance_map.at(child));
+      auto order_number = order_to_node_.size();
+      node_to_order_[node] = static_cast<int>(order_number);
+      order_to_node_.push_back(node);
+      visited[node] = true;
+
+      for (auto edge: graph_.get_out_edges(node)) {
+        auto child = graph_.get_target(edge);
+        queue.emplace(child, distance_map[child]);
       }
       while (!queue.empty()) {
         stack.emplace(queue.top().first);
@@ -143,10 +162,30 @@ class FSAEncoder
     }
   }
 
+  /**
+   * The format identifier written to the header of the encoding.
+   *
+   * Subclasses that change the label or destination coders (and hence the
+   * codebooks written by add_prefix) must override this.
+   *
+   * @return - the format of the encoding.
+   */
+  virtual FSAFormat format() const
+  {
+    return FSAFormat::kPlain;
+  }
+
+  /**
+   * Write the header of the encoding, consisting of the format identifier
+   * followed by the number of nodes in the FSA.
+   *
+   * @param buffer - the buffer to which the header is appended.
+   */
   virtual void add_header(BitVectorType& buffer)
   {
-    (void)buffer;
-    // TODO
+    DeltaCoder<size_t, BitVectorType> size_coder;
+    size_coder.encode(static_cast<size_t>(format()), &buffer);
+    size_coder.encode(graph_.get_num_nodes(), &buffer);
   }
 
   virtual void add_prefix(BitVectorType&)
@@ -160,81 +199,133 @@ class FSAEncoder
   }
 
   /**
-   * Encode a node in the graph as a bitvector.
-   * @param node
-   * @return
+   * Encode a node in the graph.
+   *
+   * The node is encoded as its accept bit followed by its out-edges in label
+   * order. Each edge is preceded by a set bit, and the list of edges is
+   * terminated by an unset bit so that a decoder can find where the next
+   * node begins.
+   *
+   * @param node - the node to encode.
+   * @param writer - the writer to append the encoding of the node to.
    */
-  virtual BitVectorType encode_node(const Node* node)
+  virtual void encode_node(NodeHandle node,
+                           BitVectorWriter<BitVectorType>& writer)
   {
-    BitVectorType buffer;
-    buffer.push_back(node->get_accept());
-    for (const auto& [label, parent]: node->get_out_edges()) {
-      auto&& edge_encoding = encode_edge(node, parent, label);
-      buffer.push_back(*edge_encoding);
+    writer.write_bit(graph_.get_accept(node));
+    for (auto edge: graph_.get_out_edges(node)) {
+      writer.write_bit(true);
+      encode_edge(node, graph_.get_target(edge), graph_.get_label(edge),
+                  writer);
     }
-    return buffer;
+    writer.write_bit(false);
   }
 
   /**
-   * Encode an edge in the graph as a bitvector.
-   * @param label
-   * @param dst
-   * @return
+   * Encode an edge in the graph.
+   *
+   * The edge is encoded as its label, followed by a set bit if the
+   * destination is the next node in the ordering, or otherwise an unset bit,
+   * a sign bit, and the absolute difference between the order numbers of the
+   * destination and source. The code of each distinct label is computed once
+   * and looked up by label ID afterwards.
+   *
+   * @param src - the source of the edge.
+   * @param dst - the destination of the edge.
+   * @param label - the label of the edge.
+   * @param writer - the writer to append the encoding of the edge to.
    */
-  virtual std::unique_ptr<BitVectorType> encode_edge(
-    const Node* src, const Node* dst, const std::string& label)
+  virtual void encode_edge(NodeHandle src, NodeHandle dst, const Label& label,
+                           BitVectorWriter<BitVectorType>& writer)
   {
-    // Create an encoding of the label in the buffer.
-    auto buffer = std::unique_ptr<BitVectorType>(label_coder_->encode(label));
+    writer.write(label_code(label));
 
     // Check if the destination is next from the source in the ordering.
-    auto order_diff = FSAEncoder<BitVectorType>::node_to_order_.at(dst) -
-                      FSAEncoder<BitVectorType>::node_to_order_.at(src);
+    auto order_diff = node_to_order_[dst] - node_to_order_[src];
     bool next = (order_diff == 1);
-    buffer->push_back(next);
+    writer.write_bit(next);
 
     // If the destination does not follow the source, encode the difference.
     if (!next) {
       bool negative = order_diff < 0;
-      buffer->push_back(negative);
-      auto destination_encoding = std::unique_ptr<BitVectorType>(
-        destination_coder_->encode(negative ? -order_diff : order_diff));
-      buffer->push_back(*destination_encoding);
+      writer.write_bit(negative);
+      destination_coder_->encode(negative ? -order_diff : order_diff, writer);
+    }
+  }
+
+  /**
+   * Get the code of a label, encoding it with the label coder the first time
+   * the label is seen.
+   *
+   * @param label - a label of the frozen graph.
+   * @return - the code of the label, which is empty if the label coder cannot
+   *           encode it.
+   */
+  const BitVectorType& label_code(const Label& label)
+  {
+    if (label.id() >= label_codes_.size()) {
+      label_codes_.resize(graph_.get_labels().size());
+    }
+    auto& code = label_codes_[label.id()];
+    if (!code.has_value()) {
+      code.emplace();
+      label_coder_->encode(std::string{label.str()}, &*code);
     }
-    return std::move(buffer);
+    return *code;
   }
 
   /**
    * Find the maximum distance from each node in the internal graph to the
    * destination node.
-   * @param dest
-   * @return
+   * @return - the distances, indexed by node ID.
    */
-  std::unordered_map<NodeHandle, int> max_distances() const
+  std::vector<Dist> max_distances() const
   {
-    std::unordered_map<NodeHandle, int> map;
-    for (const auto& node: reverse_topological_order(lexicon_.get_graph())) {
-      if (map.find(node) == map.end()) {
-        map.emplace(node, 0);
+    // Node IDs are a topological order, so going through the nodes backwards
+    // computes the distances of the children of each node before its own.
+    std::vector<Dist> distances(graph_.get_num_nodes(), 0);
+    for (auto node = graph_.get_num_nodes(); node-- > 0;) {
+      Dist dist = 0;
+      for (auto edge: graph_.get_out_edges(node)) {
+        dist = std::max(dist, distances[graph_.get_target(edge)] + 1);
       }
-      for (const auto& [label, parent]: node->get_in_edges()) {
-        auto dist = map.at(node) + 1;
-        if (map.find(parent) == map.end() || dist > map.at(parent)) {
-          map.emplace(parent, dist);
-        }
+      distances[node] = dist;
+    }
+    return distances;
+  }
+
+  /**
+   * Count the absolute differences between the order numbers of the source
+   * and destination of each edge.
+   *
+   * @return - a map from each difference to the number of edges with it.
+   */
+  std::unordered_map<int, int> get_ordering_diff_counts() const
+  {
+    std::unordered_map<int, int> diff_counts;
+    for (NodeHandle source = 0; source < graph_.get_num_nodes(); ++source) {
+      for (auto edge: graph_.get_out_edges(source)) {
+        auto diff = node_to_order_[graph_.get_target(edge)]
+                    - node_to_order_[source];
+        ++diff_counts[diff < 0 ? -diff : diff];
       }
     }
-    return map;
+    return diff_counts;
   }
 
   const FSALexicon& lexicon_;
+  FrozenGraph graph_;
 
-  // TODO: This could be replaced with boost bimap
-  std::unordered_map<NodeHandle, int> node_to_order_;
-  std::map<int, NodeHandle> order_to_node_;
+  // The order number of each node (indexed by node ID) and the node with
+  // each order number.
+  std::vector<int> node_to_order_;
+  std::vector<NodeHandle> order_to_node_;
 
   std::shared_ptr<Coder<std::string, BitVectorType>> label_coder_;
   std::shared_ptr<Coder<int, BitVectorType>> destination_coder_;
+
+  // The codes of the labels encoded so far, indexed by label ID.
+  std::vector<std::optional<BitVectorType>> label_codes_;
 };
 
 #endif //CAPS_FSA_ENCODER_H
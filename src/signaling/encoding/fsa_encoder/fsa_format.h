@@ -0,0 +1,27 @@
+/**
+ * Identifiers for the encoding formats written by the FSA encoders.
+ */
+
+#ifndef CAPS_FSA_FORMAT_H
+#define CAPS_FSA_FORMAT_H
+
+// Include C standard libraries.
+#include <cstdlib>
+
+/**
+ * The format of an encoded FSA, written at the start of the encoding header.
+ *
+ * Each FSA encoder writes a distinct format so that a decoder can tell which
+ * codebooks follow the header and how the labels and destinations of each
+ * edge are encoded.
+ */
+enum class FSAFormat: size_t {
+  kPlain = 0,
+  kHuffman = 1,
+  kMixedHuffman = 2,
+  kPartialHuffman = 3,
+  kCharHuffman = 4,
+  kChar = 5,
+};
+
+#endif //CAPS_FSA_FORMAT_H
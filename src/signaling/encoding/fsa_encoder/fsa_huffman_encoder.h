@@ -33,7 +33,7 @@ class FSAHuffmanEncoder: public FSAEncoder<BitVectorType>
       std::static_pointer_cast<LabelCoderType>(label_coder);
     FSAEncoder<BitVectorType>::order_nodes();
 
-    auto diff_counts = get_ordering_diff_counts(lexicon);
+    auto diff_counts = FSAEncoder<BitVectorType>::get_ordering_diff_counts();
     auto destination_coder = std::make_shared<HuffmanCoder<int, BitVectorType>>(
       diff_counts);
     using DestCoderType = Coder<int, BitVectorType>;
@@ -49,6 +49,11 @@ class FSAHuffmanEncoder: public FSAEncoder<BitVectorType>
 
  protected:
 
+  FSAFormat format() const override
+  {
+    return FSAFormat::kHuffman;
+  }
+
   void add_prefix(BitVectorType& buffer) override
   {
 //    std::cerr << "Adding prefix" << std::endl;
@@ -83,25 +88,6 @@ class FSAHuffmanEncoder: public FSAEncoder<BitVectorType>
   {
     return lexicon.get_graph().get_label_counts();
   }
-
-  std::unordered_map<int, int> get_ordering_diff_counts(
-    const FSALexicon& lexicon) const
-  {
-    std::unordered_map<int, int> diff_counts;
-    for (const auto& source: lexicon.get_graph().get_nodes()) {
-      for (const auto& [label, child]: source->get_out_edges()) {
-        auto diff = FSAEncoder<BitVectorType>::node_to_order_.at(child)
-          - FSAEncoder<BitVectorType>::node_to_order_.at(source.get());
-        diff = diff < 0 ? -diff : diff;
-        if (diff_counts.find(diff) == diff_counts.end()) {
-          diff_counts[diff] = 1;
-        } else {
-          ++diff_counts[diff];
-        }
-      }
-    }
-    return diff_counts;
-  }
 };
 
 #endif //CAPS_FSA_HUFFMAN_ENCODER_H
@@ -29,7 +29,7 @@ class FSAMixedHuffmanEncoder: public FSAEncoder<BitVectorType>
     : FSAEncoder<BitVectorType>{lexicon}
   {
     FSAEncoder<BitVectorType>::order_nodes();
-    auto diff_counts = get_ordering_diff_counts(lexicon);
+    auto diff_counts = FSAEncoder<BitVectorType>::get_ordering_diff_counts();
     auto destination_coder = std::make_shared<HuffmanCoder<int, BitVectorType>>(
       diff_counts);
     using DestCoderType = Coder<int, BitVectorType>;
@@ -44,7 +44,8 @@ class FSAMixedHuffmanEncoder: public FSAEncoder<BitVectorType>
     LabeledGraph::LabelMap counts3{};
 //  size_t cnt=0, saved=0;
     for (auto& [symbol, count]: counts1){
-      if (temp_char_coder->value_size(symbol)>temp_string_coder->value_size(symbol)){
+      if (!temp_char_coder->valid_value(symbol) ||
+          temp_char_coder->value_size(symbol)>temp_string_coder->value_size(symbol)){
         counts3.emplace(symbol, count);
       }else{
         for(auto c: symbol){
@@ -68,6 +69,11 @@ class FSAMixedHuffmanEncoder: public FSAEncoder<BitVectorType>
 
  protected:
 
+  FSAFormat format() const override
+  {
+    return FSAFormat::kMixedHuffman;
+  }
+
   void add_prefix(BitVectorType& buffer) override
   {
 //    std::cerr << "Adding prefix" << std::endl;
@@ -97,29 +103,10 @@ class FSAMixedHuffmanEncoder: public FSAEncoder<BitVectorType>
     buffer.push_back(dest_codebook);
   }
 
-  const LabeledGraph::LabelMap& get_label_counts(
-    const FSALexicon& lexicon) const
-  {
-    return const_cast<const LabeledGraph::LabelMap&>(lexicon.get_graph().get_label_counts());
-  }
-
-  std::unordered_map<int, int> get_ordering_diff_counts(
+  LabeledGraph::LabelMap get_label_counts(
     const FSALexicon& lexicon) const
   {
-    std::unordered_map<int, int> diff_counts;
-    for (const auto& source: lexicon.get_graph().get_nodes()) {
-      for (const auto& [label, child]: source->get_out_edges()) {
-        auto diff = FSAEncoder<BitVectorType>::node_to_order_.at(child)
-          - FSAEncoder<BitVectorType>::node_to_order_.at(source.get());
-        diff = diff < 0 ? -diff : diff;
-        if (diff_counts.find(diff) == diff_counts.end()) {
-          diff_counts[diff] = 1;
-        } else {
-          ++diff_counts[diff];
-        }
-      }
-    }
-    return diff_counts;
+    return lexicon.get_graph().get_label_counts();
   }
 
   std::pair<LabeledGraph::LabelMap, std::unordered_map<char, size_t>> get_new_counts(const LabeledGraph::LabelMap& counts) const{
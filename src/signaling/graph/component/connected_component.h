@@ -34,7 +34,7 @@ class ConnectedComponent
 
   using NodeHandle = const Node*;
   using NodeSet = std::unordered_set<NodeHandle>;
-  using LabelCountSet = std::unordered_map<std::string, size_t>;
+  using LabelCountSet = std::unordered_map<Node::Label, size_t>;
 
   explicit ConnectedComponent(NodeSet nodes);
 
@@ -26,6 +26,9 @@
  * be reached from one another by following a series of directed edges or
  * reverse directed edges that only pass through nodes in the component.
  *
+ * The reverse edges are read from Node::get_in_edges, so if the nodes belong
+ * to a LabeledGraph, the graph must have an in-edge index.
+ *
  * @param nodes - set of nodes from which to make connected components.
  * @return - the set of connected components (as ConnectedComponent instances).
  */
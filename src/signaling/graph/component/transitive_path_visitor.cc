@@ -50,7 +50,7 @@ void TransitivePathVisitor::visit_node(const Node* node)
 
 void TransitivePathVisitor::visit_edge(const Node* source,
                                        const Node* destination,
-                                       const std::string& label)
+                                       const Node::Label& label)
 {
 //  std::cerr << source << ", " << destination << ", " << label << std::endl;
   if (source == nullptr || destination == nullptr) {
@@ -58,15 +58,20 @@ void TransitivePathVisitor::visit_edge(const Node* source,
   }
   for (const auto& path_label: transitive_paths_[source]) {
 //    std::cerr << "add " << path_label + label << std::endl;
-    transitive_paths_[destination].emplace(path_label + label);
+    transitive_paths_[destination].emplace(
+      std::string{path_label}.append(label.str()));
   }
 }
 
 bool TransitivePathVisitor::should_visit_edge(const Node* source,
                                               const Node* dest,
-                                              const std::string&) const
+                                              const Node::Label&) const
 {
+  // Paths only pass through the component, so they do not continue past a
+  // downstream node that is also upstream of the component (e.g., an accept
+  // node in the middle of a chain of component nodes).
   auto b = source != nullptr && dest != nullptr
+         && (source == source_ || component_.has_node(source))
          && (component_.has_node(dest)
              || (component_.has_node(source)
                  && component_.has_downstream_node(dest)));
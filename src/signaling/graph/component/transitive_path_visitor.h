@@ -42,10 +42,10 @@ class TransitivePathVisitor: public ConstEdgeVisitor<OutEdgeTraits>
   void visit_node(const Node* node) override;
 
   void visit_edge(const Node* source, const Node* destination,
-                  const std::string& label) override;
+                  const Node::Label& label) override;
 
   bool should_visit_edge(const Node* source, const Node* dest,
-                         const std::string&) const override;
+                         const Node::Label&) const override;
 
   const std::vector<Path>& get_result() const;
 
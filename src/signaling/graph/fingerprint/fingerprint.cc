@@ -0,0 +1,414 @@
+/**
+ * Fingerprints of the right languages of the nodes of a LabeledGraph.
+ */
+
+// Include header file.
+#include "fingerprint.h"
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+// Include C++ standard libraries.
+#include <algorithm>
+#include <iomanip>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "../ordering.h"
+
+// Include headers from other projects.
+#include <boost/functional/hash.hpp>
+
+namespace {
+
+// The finalizer of splitmix64.
+uint64_t mix(uint64_t value) noexcept
+{
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+uint64_t rotate(uint64_t value, int bits) noexcept
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ * Start the fingerprint of a node with its accept flag.
+ */
+Fingerprint start_node(bool accept) noexcept
+{
+  return accept ? Fingerprint{0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL}
+                : Fingerprint{0xa4093822299f31d0ULL, 0x082efa98ec4e6c89ULL};
+}
+
+/**
+ * Add an edge with a single-character label to the fingerprint of a node.
+ *
+ * The lanes are mixed with different constants, and each lane also depends
+ * on the other, so that the two lanes together behave like a 128-bit hash.
+ */
+Fingerprint add_edge(const Fingerprint& node, char label,
+                     const Fingerprint& target) noexcept
+{
+  auto symbol = static_cast<uint64_t>(static_cast<unsigned char>(label)) + 1;
+  auto high = mix(rotate(node.high, 23)
+                  ^ mix(target.high + symbol * 0x9e3779b97f4a7c15ULL));
+  auto low = mix(rotate(node.low, 41)
+                 ^ mix(target.low ^ (symbol * 0xc2b2ae3d27d4eb4fULL + high)));
+  return {high, low};
+}
+
+// The fingerprint of the empty language, i.e., of a non-accepting node
+// without edges.
+const Fingerprint EMPTY = start_node(false);
+
+/**
+ * Fold the characters of a label (or the end of one) into the fingerprint
+ * of its target, as if each character were an edge of its own.
+ *
+ * @param label - the characters of the label.
+ * @param target - the fingerprint of the target of the edge.
+ * @return - the fingerprint of the strings spelled by the label followed by
+ *           a string in the right language of the target.
+ */
+Fingerprint add_chain(std::string_view label, Fingerprint target) noexcept
+{
+  if (target == EMPTY) {
+    return EMPTY;
+  }
+  for (auto idx = label.length(); idx-- > 0;) {
+    target = add_edge(start_node(false), label[idx], target);
+  }
+  return target;
+}
+
+}  // namespace
+
+bool operator==(const Fingerprint& lhs, const Fingerprint& rhs) noexcept
+{
+  return lhs.high == rhs.high && lhs.low == rhs.low;
+}
+
+bool operator!=(const Fingerprint& lhs, const Fingerprint& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+std::ostream& operator<<(std::ostream& out, const Fingerprint& fingerprint)
+{
+  auto flags = out.flags();
+  auto fill = out.fill('0');
+  out << std::hex << std::setw(16) << fingerprint.high << std::setw(16)
+      << fingerprint.low;
+  out.flags(flags);
+  out.fill(fill);
+  return out;
+}
+
+bool operator==(const SubtreeChange& lhs, const SubtreeChange& rhs)
+{
+  return lhs.prefix == rhs.prefix && lhs.kind == rhs.kind;
+}
+
+/**
+ * A position in a graph, viewed as if every edge had a single character:
+ * either a node or a point within the label of an edge.
+ */
+class GraphFingerprints::Position
+{
+ public:
+
+  explicit Position(const Node* node) noexcept
+    : node{node}, rest{}, target{node}
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * The position within an edge from which the rest of the label leads to
+   * the target, or the target itself if the rest is empty.
+   */
+  Position(std::string_view rest, const Node* target) noexcept
+    : node{rest.empty() ? target : nullptr}, rest{rest}, target{target}
+  {
+    // Nothing to do here.
+  }
+
+  bool get_accept() const noexcept
+  {
+    return node != nullptr && node->get_accept();
+  }
+
+  /**
+   * Call a function with the first character and the rest of each edge out
+   * of the position, in label order.
+   */
+  template <typename Function>
+  void for_each_child(Function function) const
+  {
+    if (node == nullptr) {
+      function(rest.front(), Position{rest.substr(1), target});
+      return;
+    }
+    for (const auto& [label, child]: node->get_out_edges()) {
+      function(label.front(), Position{label.str().substr(1), child});
+    }
+  }
+
+  // The node at the position, or nullptr if the position is within an edge.
+  const Node* node;
+  // The rest of the label of the edge, if the position is within one.
+  std::string_view rest;
+  const Node* target;
+};
+
+namespace {
+
+bool char_less(char lhs, char rhs) noexcept
+{
+  // Labels are ordered as strings, which compare characters as unsigned.
+  return static_cast<unsigned char>(lhs) < static_cast<unsigned char>(rhs);
+}
+
+}  // namespace
+
+GraphFingerprints::GraphFingerprints(const LabeledGraph& graph)
+  : graph_{graph}, fingerprints_(graph.get_nodes().capacity(), EMPTY)
+{
+  // Children come before their parents in reverse topological order, so the
+  // fingerprints of a node's children are known when it is reached.
+  for (const auto* node: reverse_topological_order(graph_)) {
+    const auto& edges = node->get_out_edges();
+    bool deterministic = std::adjacent_find(
+      edges.begin(), edges.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first.front() == rhs.first.front();
+      }) == edges.end();
+    if (!deterministic) {
+      fingerprints_[node->get_index()] = expand({Position{node}});
+      continue;
+    }
+    auto fingerprint = start_node(node->get_accept());
+    for (const auto& [label, child]: edges) {
+      auto target = add_chain(label.str().substr(1),
+                              fingerprints_[child->get_index()]);
+      if (target != EMPTY) {
+        fingerprint = add_edge(fingerprint, label.front(), target);
+      }
+    }
+    fingerprints_[node->get_index()] = fingerprint;
+  }
+}
+
+Fingerprint GraphFingerprints::get_root() const
+{
+  return get_node(graph_.get_root());
+}
+
+Fingerprint GraphFingerprints::get_node(const Node* node) const
+{
+  return fingerprints_[node->get_index()];
+}
+
+std::optional<Fingerprint> GraphFingerprints::get_prefix(
+  std::string_view prefix) const
+{
+  PositionSet positions{Position{graph_.get_root()}};
+  for (auto c: prefix) {
+    PositionSet next;
+    for (const auto& position: positions) {
+      position.for_each_child([c, &next](char first, const Position& child) {
+        if (first == c) {
+          next.push_back(child);
+        }
+      });
+    }
+    positions.swap(next);
+  }
+  auto fingerprint = get_positions(positions);
+  if (fingerprint == EMPTY) {
+    return std::nullopt;
+  }
+  return fingerprint;
+}
+
+bool GraphFingerprints::same_language(const GraphFingerprints& other) const
+{
+  return get_root() == other.get_root();
+}
+
+bool GraphFingerprints::same_subtree(const GraphFingerprints& other,
+                                     std::string_view prefix) const
+{
+  return get_prefix(prefix) == other.get_prefix(prefix);
+}
+
+std::vector<SubtreeChange> GraphFingerprints::changed_subtrees(
+  const GraphFingerprints& other, size_t max_changes) const
+{
+  std::vector<SubtreeChange> changes;
+  // The changes found below each pair of nodes that has been compared, with
+  // the prefix leading to the pair removed, so that they can be repeated for
+  // every other prefix that leads to the same pair.
+  using NodePair = std::pair<const Node*, const Node*>;
+  std::unordered_map<NodePair, std::vector<SubtreeChange>,
+                     boost::hash<NodePair>> cache;
+
+  // Each entry holds the positions in this graph reached by a prefix, the
+  // positions reached by the same prefix in the other graph, and the prefix.
+  // Children are pushed in reverse order, so that prefixes are popped in
+  // lexicographic order. Below the children of a pair of nodes, an entry
+  // holding the index of the first change found for the pair is pushed, which
+  // is popped once all changes below the pair have been found.
+  std::vector<std::tuple<PositionSet, PositionSet, std::string,
+                         std::optional<size_t>>> stack;
+  stack.emplace_back(PositionSet{Position{graph_.get_root()}},
+                     PositionSet{Position{other.graph_.get_root()}}, "",
+                     std::nullopt);
+  while (!stack.empty() && changes.size() < max_changes) {
+    auto [lhs, rhs, prefix, first_change] = std::move(stack.back());
+    stack.pop_back();
+    if (first_change.has_value()) {
+      auto& cached = cache[{lhs.front().node, rhs.front().node}];
+      for (auto i = *first_change; i < changes.size(); ++i) {
+        cached.push_back({changes[i].prefix.substr(prefix.length()),
+                          changes[i].kind});
+      }
+      continue;
+    }
+    auto lhs_fingerprint = get_positions(lhs);
+    auto rhs_fingerprint = other.get_positions(rhs);
+    if (lhs_fingerprint == rhs_fingerprint) {
+      continue;
+    }
+    if (lhs_fingerprint == EMPTY) {
+      changes.push_back({std::move(prefix), SubtreeChange::Kind::added});
+      continue;
+    }
+    if (rhs_fingerprint == EMPTY) {
+      changes.push_back({std::move(prefix), SubtreeChange::Kind::removed});
+      continue;
+    }
+    if (lhs.size() == 1 && lhs.front().node != nullptr && rhs.size() == 1
+        && rhs.front().node != nullptr) {
+      auto cached = cache.find({lhs.front().node, rhs.front().node});
+      if (cached != cache.end()) {
+        for (const auto& change: cached->second) {
+          if (changes.size() == max_changes) {
+            break;
+          }
+          changes.push_back({prefix + change.prefix, change.kind});
+        }
+        continue;
+      }
+      stack.emplace_back(lhs, rhs, prefix, changes.size());
+    }
+    auto accept = [](const PositionSet& positions) {
+      return std::any_of(positions.begin(), positions.end(),
+                         [](const Position& p) { return p.get_accept(); });
+    };
+    if (accept(lhs) != accept(rhs)) {
+      changes.push_back({prefix, SubtreeChange::Kind::accept_changed});
+    }
+
+    // Pair up the children of both sides by their first characters.
+    auto lhs_children = get_children(lhs);
+    auto rhs_children = get_children(rhs);
+    std::vector<std::tuple<char, PositionSet, PositionSet>> children;
+    auto lhs_child = lhs_children.begin();
+    auto rhs_child = rhs_children.begin();
+    while (lhs_child != lhs_children.end()
+           || rhs_child != rhs_children.end()) {
+      if (rhs_child == rhs_children.end()
+          || (lhs_child != lhs_children.end()
+              && char_less(lhs_child->first, rhs_child->first))) {
+        children.emplace_back(lhs_child->first, std::move(lhs_child->second),
+                              PositionSet{});
+        ++lhs_child;
+      } else if (lhs_child == lhs_children.end()
+                 || char_less(rhs_child->first, lhs_child->first)) {
+        children.emplace_back(rhs_child->first, PositionSet{},
+                              std::move(rhs_child->second));
+        ++rhs_child;
+      } else {
+        children.emplace_back(lhs_child->first, std::move(lhs_child->second),
+                              std::move(rhs_child->second));
+        ++lhs_child;
+        ++rhs_child;
+      }
+    }
+    for (auto child = children.rbegin(); child != children.rend(); ++child) {
+      auto& [c, lhs_positions, rhs_positions] = *child;
+      stack.emplace_back(std::move(lhs_positions), std::move(rhs_positions),
+                         prefix + c, std::nullopt);
+    }
+  }
+  return changes;
+}
+
+std::vector<std::pair<char, GraphFingerprints::PositionSet>>
+GraphFingerprints::get_children(const PositionSet& positions)
+{
+  std::vector<std::pair<char, Position>> edges;
+  for (const auto& position: positions) {
+    position.for_each_child([&edges](char c, const Position& child) {
+      edges.emplace_back(c, child);
+    });
+  }
+  // The edges out of a single position are already sorted.
+  if (positions.size() > 1) {
+    std::stable_sort(edges.begin(), edges.end(),
+                     [](const auto& lhs, const auto& rhs) {
+                       return char_less(lhs.first, rhs.first);
+                     });
+  }
+  std::vector<std::pair<char, PositionSet>> children;
+  for (const auto& [c, child]: edges) {
+    if (children.empty() || children.back().first != c) {
+      children.emplace_back(c, PositionSet{});
+    }
+    children.back().second.push_back(child);
+  }
+  return children;
+}
+
+Fingerprint GraphFingerprints::get_positions(
+  const PositionSet& positions) const
+{
+  if (positions.empty()) {
+    return EMPTY;
+  }
+  if (positions.size() > 1) {
+    return expand(positions);
+  }
+  const auto& position = positions.front();
+  if (position.node != nullptr) {
+    return get_node(position.node);
+  }
+  return add_chain(position.rest, get_node(position.target));
+}
+
+Fingerprint GraphFingerprints::expand(const PositionSet& positions) const
+{
+  // The positions stand for the union of their languages, as if the graph
+  // were determinized on the fly.
+  auto accept = std::any_of(positions.begin(), positions.end(),
+                            [](const Position& p) { return p.get_accept(); });
+  auto fingerprint = start_node(accept);
+  for (const auto& [c, children]: get_children(positions)) {
+    auto target = get_positions(children);
+    if (target != EMPTY) {
+      fingerprint = add_edge(fingerprint, c, target);
+    }
+  }
+  return fingerprint;
+}
@@ -0,0 +1,203 @@
+/**
+ * Fingerprints of the right languages of the nodes of a LabeledGraph.
+ */
+
+#ifndef CAPS_FINGERPRINT_H
+#define CAPS_FINGERPRINT_H
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+// Include C++ standard libraries.
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "../labeled_graph/graph.h"
+#include "../node/node.h"
+
+// Include headers from other projects.
+
+/**
+ * A 128-bit hash of a set of strings.
+ *
+ * Fingerprints are not cryptographic: two different languages have the same
+ * fingerprint with negligible probability, but inputs could be crafted to
+ * collide.
+ */
+struct Fingerprint
+{
+  uint64_t high;
+  uint64_t low;
+};
+
+bool operator==(const Fingerprint& lhs, const Fingerprint& rhs) noexcept;
+
+bool operator!=(const Fingerprint& lhs, const Fingerprint& rhs) noexcept;
+
+/**
+ * Print a fingerprint as 32 hexadecimal digits.
+ */
+std::ostream& operator<<(std::ostream& out, const Fingerprint& fingerprint);
+
+namespace std {
+  template<> struct hash<Fingerprint>
+  {
+    size_t operator()(const Fingerprint& fingerprint) const noexcept
+    {
+      return static_cast<size_t>(fingerprint.low);
+    }
+  };
+}
+
+/**
+ * A difference between the languages of two graphs, found by
+ * GraphFingerprints::changed_subtrees.
+ */
+struct SubtreeChange
+{
+  enum class Kind {
+    // The prefix itself was added to or removed from the language, but the
+    // strings that extend it were not necessarily changed.
+    accept_changed,
+    // Every string starting with the prefix was added.
+    added,
+    // Every string starting with the prefix was removed.
+    removed
+  };
+
+  std::string prefix;
+  Kind kind;
+};
+
+bool operator==(const SubtreeChange& lhs, const SubtreeChange& rhs);
+
+/**
+ * Bottom-up (Merkle-style) fingerprints of the right language of every node
+ * of a graph, i.e., the set of strings spelled by the paths from the node to
+ * an accepting node.
+ *
+ * A node's fingerprint is combined from its accept flag and, for each of its
+ * outgoing edges in label order, the edge's label and the fingerprint of its
+ * target, so all the fingerprints are computed in a single pass over the
+ * graph in reverse topological order. Labels of several characters are
+ * hashed as chains of single-character edges, edges to nodes with an empty
+ * right language are ignored, and out-edges of a node that start with the
+ * same character (which compaction can create) are hashed as a single edge
+ * to the union of their languages. The fingerprint therefore only depends
+ * on the language, and not on how the graph was compacted or minimized.
+ *
+ * Comparing the fingerprints of two graphs checks whether they accept the
+ * same strings in time linear in their sizes, without enumerating the
+ * strings. The fingerprints refer to the nodes of the graph by index, so
+ * they are invalidated by any change to the graph.
+ */
+class GraphFingerprints
+{
+ public:
+
+  /**
+   * Compute the fingerprints of the nodes reachable from the root of a graph.
+   *
+   * @param graph - the graph, which must outlive the fingerprints.
+   */
+  explicit GraphFingerprints(const LabeledGraph& graph);
+
+  /**
+   * @return - the fingerprint of the strings accepted by the graph.
+   */
+  Fingerprint get_root() const;
+
+  /**
+   * Get the fingerprint of a node's right language.
+   *
+   * @param node - a node reachable from the root of the graph.
+   * @return - the fingerprint.
+   */
+  Fingerprint get_node(const Node* node) const;
+
+  /**
+   * Get the fingerprint of the strings that complete a prefix, i.e., of
+   * {s : prefix + s is accepted by the graph}.
+   *
+   * @param prefix - the prefix, which may end within a label.
+   * @return - the fingerprint, or std::nullopt if no accepted string starts
+   *           with the prefix.
+   */
+  std::optional<Fingerprint> get_prefix(std::string_view prefix) const;
+
+  /**
+   * Check whether two graphs accept the same strings.
+   */
+  bool same_language(const GraphFingerprints& other) const;
+
+  /**
+   * Check whether the strings that complete a prefix are the same in two
+   * graphs.
+   *
+   * @param other - the fingerprints of the other graph.
+   * @param prefix - the prefix.
+   * @return - true if both graphs accept the same strings starting with the
+   *           prefix (including if neither accepts any).
+   */
+  bool same_subtree(const GraphFingerprints& other,
+                    std::string_view prefix) const;
+
+  /**
+   * Find where the language of another graph differs from that of this one.
+   *
+   * Both graphs are walked from their roots at the same time, descending
+   * only into subtrees whose fingerprints differ, so the time taken depends
+   * on the size of the changes rather than of the graphs. Each change is
+   * reported at the shortest prefix that covers it. A pair of nodes reached by
+   * several prefixes is only compared once, and the changes found below it
+   * are repeated under each of those prefixes.
+   *
+   * @param other - the fingerprints of the graph to compare with, whose
+   *                strings are considered the new ones.
+   * @param max_changes - the number of changes after which to stop.
+   * @return - the changes, in lexicographic order of their prefixes.
+   */
+  std::vector<SubtreeChange> changed_subtrees(
+    const GraphFingerprints& other, size_t max_changes = SIZE_MAX) const;
+
+ private:
+
+  class Position;
+  // The positions reached by the same prefix, which may be several if more
+  // than one label out of a node starts with the same character.
+  using PositionSet = std::vector<Position>;
+
+  /**
+   * Group the edges out of a set of positions by their first characters.
+   *
+   * @param positions - the positions.
+   * @return - each character that starts an edge, in order, and the
+   *           positions after the character.
+   */
+  static std::vector<std::pair<char, PositionSet>> get_children(
+    const PositionSet& positions);
+
+  /**
+   * Get the fingerprint of the union of the right languages of positions.
+   */
+  Fingerprint get_positions(const PositionSet& positions) const;
+
+  /**
+   * Compute the fingerprint of the union of the right languages of positions
+   * from the fingerprints of their children.
+   */
+  Fingerprint expand(const PositionSet& positions) const;
+
+  const LabeledGraph& graph_;
+  // The fingerprints of the nodes, indexed by node index.
+  std::vector<Fingerprint> fingerprints_;
+};
+
+#endif //CAPS_FINGERPRINT_H
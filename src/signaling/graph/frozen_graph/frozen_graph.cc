@@ -0,0 +1,451 @@
+/**
+ * Read-only graph with edges stored in compressed sparse row arrays.
+ */
+
+// Include header file.
+#include "frozen_graph.h"
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Include C++ standard libraries.
+#include <algorithm>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "../node/node.h"
+
+// Include headers from other projects.
+
+namespace {
+
+// Checkpoint header: the magic string, the format version, and a value that
+// reads differently on a machine with another byte order.
+constexpr char CHECKPOINT_MAGIC[8] = {'C', 'A', 'P', 'S', 'C', 'K', 'P', 'T'};
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+constexpr uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304;
+
+// Every section of a checkpoint starts at a multiple of this many bytes.
+constexpr size_t CHECKPOINT_ALIGNMENT = 8;
+
+// Arrays are read in chunks of at most this many bytes, so that a corrupted
+// length in the header fails at the end of the stream instead of allocating
+// memory for the whole length up front.
+constexpr size_t READ_CHUNK_SIZE = 1 << 20;
+
+void write_padding(std::ostream& out_stream, size_t size)
+{
+  static constexpr char zeros[CHECKPOINT_ALIGNMENT] = {};
+  out_stream.write(zeros, (CHECKPOINT_ALIGNMENT - size % CHECKPOINT_ALIGNMENT)
+                          % CHECKPOINT_ALIGNMENT);
+}
+
+template <typename T>
+void write_value(std::ostream& out_stream, T value)
+{
+  out_stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void write_array(std::ostream& out_stream, const T* data, size_t size)
+{
+  out_stream.write(reinterpret_cast<const char*>(data), size * sizeof(T));
+  write_padding(out_stream, size * sizeof(T));
+}
+
+bool skip_padding(std::istream& in_stream, size_t size)
+{
+  char padding[CHECKPOINT_ALIGNMENT];
+  auto length = (CHECKPOINT_ALIGNMENT - size % CHECKPOINT_ALIGNMENT)
+                % CHECKPOINT_ALIGNMENT;
+  return static_cast<bool>(in_stream.read(padding, length));
+}
+
+template <typename T>
+bool read_value(std::istream& in_stream, T& value)
+{
+  return static_cast<bool>(in_stream.read(reinterpret_cast<char*>(&value),
+                                          sizeof(T)));
+}
+
+template <typename T>
+bool read_array(std::istream& in_stream, std::vector<T>& values, size_t size)
+{
+  values.clear();
+  while (values.size() < size) {
+    auto position = values.size();
+    auto chunk = std::min(size - position, READ_CHUNK_SIZE / sizeof(T));
+    values.resize(position + chunk);
+    if (!in_stream.read(reinterpret_cast<char*>(values.data() + position),
+                        chunk * sizeof(T))) {
+      return false;
+    }
+  }
+  return skip_padding(in_stream, size * sizeof(T));
+}
+
+}  // namespace
+
+FrozenGraph::FrozenGraph()
+  : offsets_{0, 0}, targets_{}, label_ids_{}, accept_{false}, num_accept_{0},
+    label_pool_{std::make_shared<const LabelPool>()}, labels_{}
+{
+  // Nothing to do here.
+}
+
+FrozenGraph::FrozenGraph(const LabeledGraph& graph)
+  : offsets_{}, targets_{}, label_ids_{}, accept_{}, num_accept_{0},
+    label_pool_{}, labels_{}
+{
+  // Number the nodes in reverse postorder of a depth-first search from the
+  // root, which is a topological order. The children of each node are
+  // visited in reverse label order, so that the first child finishes last
+  // and (unless it was already visited) is numbered right after its parent.
+  std::vector<NodeId> ids(graph.get_nodes().capacity(), NO_NODE);
+  std::vector<const Node*> postorder;
+  postorder.reserve(graph.get_num_nodes());
+
+  // Each entry holds a node and the number of its children left to visit.
+  std::vector<std::pair<const Node*, size_t>> stack;
+  const Node* root = graph.get_root();
+  ids[root->get_index()] = 0;
+  stack.emplace_back(root, root->get_out_degree());
+  while (!stack.empty()) {
+    auto& [node, remaining] = stack.back();
+    if (remaining == 0) {
+      postorder.push_back(node);
+      stack.pop_back();
+      continue;
+    }
+    --remaining;
+    const Node* child = (node->get_out_edges().begin() + remaining)->second;
+    // Mark the child as discovered (with any ID) before visiting it.
+    auto& child_id = ids[child->get_index()];
+    if (child_id == NO_NODE) {
+      child_id = 0;
+      stack.emplace_back(child, child->get_out_degree());
+    }
+  }
+  auto num_nodes = postorder.size();
+  for (size_t i = 0; i < num_nodes; ++i) {
+    ids[postorder[i]->get_index()] = static_cast<NodeId>(num_nodes - 1 - i);
+  }
+
+  // Copy the edges in order of their sources, interning each label the first
+  // time it is seen.
+  auto label_pool = std::make_shared<LabelPool>();
+  std::vector<Label::Id> label_map(graph.get_labels().size(), Label::NO_ID);
+  offsets_.reserve(num_nodes + 1);
+  targets_.reserve(graph.get_num_edges());
+  label_ids_.reserve(graph.get_num_edges());
+  accept_.reserve(num_nodes);
+  offsets_.push_back(0);
+  for (auto node_itr = postorder.rbegin(); node_itr != postorder.rend();
+       ++node_itr) {
+    const auto* node = *node_itr;
+    accept_.push_back(node->get_accept());
+    if (node->get_accept()) {
+      ++num_accept_;
+    }
+    for (const auto& [label, child]: node->get_out_edges()) {
+      auto& label_id = label_map[label.id()];
+      if (label_id == Label::NO_ID) {
+        labels_.push_back(label_pool->intern(label.str()));
+        label_id = labels_.back().id();
+      }
+      targets_.push_back(ids[child->get_index()]);
+      label_ids_.push_back(label_id);
+    }
+    offsets_.push_back(targets_.size());
+  }
+  label_pool_ = std::move(label_pool);
+}
+
+size_t FrozenGraph::get_num_nodes() const noexcept
+{
+  return accept_.size();
+}
+
+size_t FrozenGraph::get_num_edges() const noexcept
+{
+  return targets_.size();
+}
+
+size_t FrozenGraph::get_num_accept() const noexcept
+{
+  return num_accept_;
+}
+
+FrozenGraph::NodeId FrozenGraph::get_root() const noexcept
+{
+  return 0;
+}
+
+bool FrozenGraph::get_accept(NodeId node) const
+{
+  return accept_[node];
+}
+
+size_t FrozenGraph::get_out_degree(NodeId node) const
+{
+  return offsets_[node + 1] - offsets_[node];
+}
+
+FrozenGraph::EdgeRange FrozenGraph::get_out_edges(NodeId node) const
+{
+  return {offsets_[node], offsets_[node + 1]};
+}
+
+FrozenGraph::NodeId FrozenGraph::get_target(EdgeId edge) const
+{
+  return targets_[edge];
+}
+
+const Label& FrozenGraph::get_label(EdgeId edge) const
+{
+  return labels_[label_ids_[edge]];
+}
+
+Label::Id FrozenGraph::get_label_id(EdgeId edge) const
+{
+  return label_ids_[edge];
+}
+
+FrozenGraph::NodeId FrozenGraph::follow_out_edge(NodeId node,
+                                                 std::string_view label) const
+{
+  auto edge = lower_bound(node, label);
+  if (edge == offsets_[node + 1] || labels_[label_ids_[edge]] != label) {
+    return NO_NODE;
+  }
+  return targets_[edge];
+}
+
+bool FrozenGraph::has_string(std::string_view str) const
+{
+  // Follow the first matching edge out of each node, and only keep the other
+  // matching edges (which only exist if labels span several characters) to
+  // try if the first one fails.
+  std::vector<std::pair<NodeId, size_t>> alternatives;
+  auto node = get_root();
+  size_t idx = 0;
+  while (true) {
+    if (idx == str.length()) {
+      if (accept_[node]) {
+        return true;
+      }
+    } else {
+      // Out-edges are sorted by label, so only the labels starting with the
+      // next character of the string need to be checked.
+      auto last = offsets_[node + 1];
+      auto next = NO_NODE;
+      size_t next_idx = 0;
+      for (auto edge = lower_bound(node, str.substr(idx, 1));
+           edge < last && labels_[label_ids_[edge]].front() == str[idx];
+           ++edge) {
+        const auto& label = labels_[label_ids_[edge]];
+        if (str.compare(idx, label.length(), label.str()) != 0) {
+          continue;
+        }
+        auto target = targets_[edge];
+        if (next == NO_NODE) {
+          next = target;
+          next_idx = idx + label.length();
+        } else {
+          alternatives.emplace_back(target, idx + label.length());
+        }
+      }
+      if (next != NO_NODE) {
+        node = next;
+        idx = next_idx;
+        continue;
+      }
+    }
+    if (alternatives.empty()) {
+      return false;
+    }
+    std::tie(node, idx) = alternatives.back();
+    alternatives.pop_back();
+  }
+}
+
+size_t FrozenGraph::count_strings() const
+{
+  // Every edge goes to a larger ID, so count from the last node backwards.
+  std::vector<size_t> counts(get_num_nodes());
+  for (auto node = get_num_nodes(); node-- > 0;) {
+    size_t count = accept_[node] ? 1 : 0;
+    for (auto edge = offsets_[node]; edge < offsets_[node + 1]; ++edge) {
+      count += counts[targets_[edge]];
+    }
+    counts[node] = count;
+  }
+  return counts[get_root()];
+}
+
+const LabelPool& FrozenGraph::get_labels() const
+{
+  return *label_pool_;
+}
+
+FrozenGraph::EdgeId FrozenGraph::lower_bound(NodeId node,
+                                             std::string_view label) const
+{
+  auto first = label_ids_.begin() + offsets_[node];
+  auto last = label_ids_.begin() + offsets_[node + 1];
+  auto edge = std::lower_bound(first, last, label,
+                               [this](Label::Id id, std::string_view value) {
+                                 return labels_[id] < value;
+                               });
+  return static_cast<EdgeId>(edge - label_ids_.begin());
+}
+
+LabeledGraph::LabelMap FrozenGraph::get_label_counts() const
+{
+  std::vector<size_t> counts(labels_.size());
+  for (auto label_id: label_ids_) {
+    ++counts[label_id];
+  }
+  LabeledGraph::LabelMap label_counts;
+  for (Label::Id id = 0; id < counts.size(); ++id) {
+    label_counts.emplace(labels_[id].str(), counts[id]);
+  }
+  return label_counts;
+}
+
+void FrozenGraph::thaw(LabeledGraph& graph) const
+{
+  std::vector<Node*> nodes;
+  nodes.reserve(get_num_nodes());
+  nodes.push_back(graph.get_root());
+  while (nodes.size() < get_num_nodes()) {
+    nodes.push_back(graph.add_node());
+  }
+  for (NodeId node = 0; node < get_num_nodes(); ++node) {
+    graph.set_accept(nodes[node], accept_[node]);
+    for (auto edge = offsets_[node]; edge < offsets_[node + 1]; ++edge) {
+      graph.add_edge(nodes[node], nodes[targets_[edge]],
+                     labels_[label_ids_[edge]].str());
+    }
+  }
+}
+
+void FrozenGraph::write(std::ostream& out_stream) const
+{
+  out_stream.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+  write_value(out_stream, CHECKPOINT_VERSION);
+  write_value(out_stream, CHECKPOINT_BYTE_ORDER);
+  write_value<uint64_t>(out_stream, get_num_nodes());
+  write_value<uint64_t>(out_stream, get_num_edges());
+  write_value<uint64_t>(out_stream, labels_.size());
+
+  // The labels are stored as one string, and label n spans the characters
+  // from label_offsets[n] up to label_offsets[n + 1].
+  std::vector<uint64_t> label_offsets;
+  label_offsets.reserve(labels_.size() + 1);
+  label_offsets.push_back(0);
+  for (const auto& label: labels_) {
+    label_offsets.push_back(label_offsets.back() + label.length());
+  }
+  write_value<uint64_t>(out_stream, label_offsets.back());
+  write_array(out_stream, label_offsets.data(), label_offsets.size());
+  for (const auto& label: labels_) {
+    out_stream.write(label.str().data(), label.length());
+  }
+  write_padding(out_stream, label_offsets.back());
+
+  static_assert(sizeof(EdgeId) == sizeof(uint64_t));
+  static_assert(sizeof(Label::Id) == sizeof(uint32_t));
+  write_array(out_stream, offsets_.data(), offsets_.size());
+  write_array(out_stream, targets_.data(), targets_.size());
+  write_array(out_stream, label_ids_.data(), label_ids_.size());
+  std::vector<uint8_t> accept(accept_.begin(), accept_.end());
+  write_array(out_stream, accept.data(), accept.size());
+}
+
+std::optional<FrozenGraph> FrozenGraph::read(std::istream& in_stream)
+{
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  uint32_t version, byte_order;
+  uint64_t num_nodes, num_edges, num_labels, label_length;
+  if (!in_stream.read(magic, sizeof(magic))
+      || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0
+      || !read_value(in_stream, version) || version != CHECKPOINT_VERSION
+      || !read_value(in_stream, byte_order)
+      || byte_order != CHECKPOINT_BYTE_ORDER
+      || !read_value(in_stream, num_nodes) || !read_value(in_stream, num_edges)
+      || !read_value(in_stream, num_labels)
+      || !read_value(in_stream, label_length)
+      || num_nodes == 0 || num_nodes >= NO_NODE || num_labels >= Label::NO_ID) {
+    return std::nullopt;
+  }
+
+  // Intern the labels in order, so that each one gets the ID it had when the
+  // graph was written.
+  std::vector<uint64_t> label_offsets;
+  std::vector<char> label_chars;
+  if (!read_array(in_stream, label_offsets, num_labels + 1)
+      || label_offsets.front() != 0 || label_offsets.back() != label_length
+      || !std::is_sorted(label_offsets.begin(), label_offsets.end())
+      || !read_array(in_stream, label_chars, label_length)) {
+    return std::nullopt;
+  }
+  FrozenGraph graph;
+  auto label_pool = std::make_shared<LabelPool>();
+  graph.labels_.reserve(num_labels);
+  for (size_t id = 0; id < num_labels; ++id) {
+    graph.labels_.push_back(label_pool->intern(
+      {label_chars.data() + label_offsets[id],
+       label_offsets[id + 1] - label_offsets[id]}));
+    // A label written twice would be interned only once.
+    if (label_pool->size() != id + 1) {
+      return std::nullopt;
+    }
+  }
+  graph.label_pool_ = std::move(label_pool);
+
+  std::vector<uint8_t> accept;
+  if (!read_array(in_stream, graph.offsets_, num_nodes + 1)
+      || !read_array(in_stream, graph.targets_, num_edges)
+      || !read_array(in_stream, graph.label_ids_, num_edges)
+      || !read_array(in_stream, accept, num_nodes)) {
+    return std::nullopt;
+  }
+
+  // Check that the arrays describe a graph with the properties the other
+  // methods rely on: edges in range, sorted by label within each node, and
+  // only going to nodes with larger IDs.
+  if (graph.offsets_.front() != 0 || graph.offsets_.back() != num_edges) {
+    return std::nullopt;
+  }
+  for (NodeId node = 0; node < num_nodes; ++node) {
+    auto first = graph.offsets_[node];
+    auto last = graph.offsets_[node + 1];
+    if (last < first || last > num_edges) {
+      return std::nullopt;
+    }
+    for (auto edge = first; edge < last; ++edge) {
+      auto target = graph.targets_[edge];
+      auto label_id = graph.label_ids_[edge];
+      if (target <= node || target >= num_nodes || label_id >= num_labels
+          || (edge > first && !(graph.labels_[graph.label_ids_[edge - 1]]
+                                < graph.labels_[label_id]))) {
+        return std::nullopt;
+      }
+    }
+  }
+  graph.accept_.assign(accept.begin(), accept.end());
+  graph.num_accept_ = static_cast<size_t>(
+    std::count(graph.accept_.begin(), graph.accept_.end(), true));
+  return graph;
+}
@@ -0,0 +1,275 @@
+/**
+ * Read-only graph with edges stored in compressed sparse row arrays.
+ */
+
+#ifndef CAPS_FROZEN_GRAPH_H
+#define CAPS_FROZEN_GRAPH_H
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+// Include C++ standard libraries.
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Include other headers from this project.
+#include "../labeled_graph/graph.h"
+#include "../node/label.h"
+
+/**
+ * Immutable copy of a LabeledGraph for passes that only read the graph, such
+ * as encoding and lookups.
+ *
+ * Nodes are identified by dense IDs rather than pointers, and the edges of
+ * all nodes are stored contiguously in the order of their sources: the
+ * out-edges of node n are the edges with IDs from get_out_edges(n).begin()
+ * up to get_out_edges(n).end(), sorted by label. Each edge is stored as the
+ * ID of its target and the ID of its label, so a pass over the graph reads
+ * a few flat arrays in order instead of following pointers between nodes.
+ *
+ * Node IDs are a topological order of the graph: the root has ID 0, and
+ * every edge goes from a node to one with a larger ID. A node's first child
+ * (by label) is numbered directly after it where possible, so following the
+ * first edge out of each node tends to stay within the same cache lines.
+ *
+ * Only nodes reachable from the root of the original graph are kept.
+ */
+class FrozenGraph
+{
+ public:
+
+  // Alias declarations
+  using NodeId = uint32_t;
+  using EdgeId = size_t;
+
+  // The ID returned when no node matches.
+  static constexpr NodeId NO_NODE = UINT32_MAX;
+
+  /**
+   * Range of the IDs of consecutive edges.
+   */
+  class EdgeRange
+  {
+   public:
+
+    class iterator
+    {
+     public:
+
+      explicit iterator(EdgeId edge) noexcept
+        : edge_{edge}
+      {
+        // Nothing to do here.
+      }
+
+      EdgeId operator*() const noexcept
+      {
+        return edge_;
+      }
+
+      iterator& operator++() noexcept
+      {
+        ++edge_;
+        return *this;
+      }
+
+      bool operator==(const iterator& other) const noexcept
+      {
+        return edge_ == other.edge_;
+      }
+
+      bool operator!=(const iterator& other) const noexcept
+      {
+        return edge_ != other.edge_;
+      }
+
+     private:
+
+      EdgeId edge_;
+    };
+
+    EdgeRange(EdgeId first, EdgeId last) noexcept
+      : first_{first}, last_{last}
+    {
+      // Nothing to do here.
+    }
+
+    iterator begin() const noexcept
+    {
+      return iterator{first_};
+    }
+
+    iterator end() const noexcept
+    {
+      return iterator{last_};
+    }
+
+    size_t size() const noexcept
+    {
+      return last_ - first_;
+    }
+
+    bool empty() const noexcept
+    {
+      return first_ == last_;
+    }
+
+   private:
+
+    EdgeId first_;
+    EdgeId last_;
+  };
+
+  /**
+   * Create a graph with a single root node and no edges.
+   */
+  FrozenGraph();
+
+  /**
+   * Copy the nodes reachable from the root of a graph.
+   *
+   * @param graph - the graph to copy.
+   */
+  explicit FrozenGraph(const LabeledGraph& graph);
+
+  // The default copy constructor, move constructor, assignment operators, and
+  // destructor are fine. Copies share the (immutable) label pool.
+
+  size_t get_num_nodes() const noexcept;
+
+  size_t get_num_edges() const noexcept;
+
+  size_t get_num_accept() const noexcept;
+
+  /**
+   * @return - the ID of the root node, which is always 0.
+   */
+  NodeId get_root() const noexcept;
+
+  bool get_accept(NodeId node) const;
+
+  size_t get_out_degree(NodeId node) const;
+
+  /**
+   * Get the IDs of a node's outgoing edges, which are sorted by label.
+   *
+   * @param node - the ID of the node.
+   * @return - the range of edge IDs.
+   */
+  EdgeRange get_out_edges(NodeId node) const;
+
+  NodeId get_target(EdgeId edge) const;
+
+  const Label& get_label(EdgeId edge) const;
+
+  /**
+   * Get the ID of an edge's label in the graph's label pool.
+   *
+   * @param edge - the ID of the edge.
+   * @return - the ID of the label.
+   */
+  Label::Id get_label_id(EdgeId edge) const;
+
+  /**
+   * Get the target of a node's outgoing edge with a given label.
+   *
+   * @param node - the ID of the source node.
+   * @param label - the label of the edge.
+   * @return - the ID of the target, or NO_NODE if there is no such edge.
+   */
+  NodeId follow_out_edge(NodeId node, std::string_view label) const;
+
+  /**
+   * Check whether the graph accepts a string.
+   *
+   * Labels may span several characters (e.g., after compaction), in which
+   * case every label that is a prefix of the rest of the string is tried.
+   *
+   * @param str - the string to look up.
+   * @return - true if a path from the root spells the string and ends at an
+   *           accepting node.
+   */
+  bool has_string(std::string_view str) const;
+
+  /**
+   * Count the strings accepted by the graph.
+   *
+   * @return - the number of paths from the root to an accepting node.
+   */
+  size_t count_strings() const;
+
+  /**
+   * Get the pool of the graph's labels, which contains exactly the labels of
+   * its edges.
+   *
+   * @return
+   */
+  const LabelPool& get_labels() const;
+
+  LabeledGraph::LabelMap get_label_counts() const;
+
+  /**
+   * Copy the graph into an empty LabeledGraph.
+   *
+   * Nodes are added in order of their IDs, so the root of the frozen graph
+   * becomes the root of the LabeledGraph.
+   *
+   * @param graph - a graph consisting only of its root node.
+   */
+  void thaw(LabeledGraph& graph) const;
+
+  /**
+   * Write the graph to a stream in the binary checkpoint format.
+   *
+   * The format is a short header followed by the label strings and the
+   * arrays of the graph exactly as they are laid out in memory, each padded
+   * to a multiple of 8 bytes so that a mapped file could use them in place.
+   * Values are written in the byte order of the machine, which the header
+   * records so that a checkpoint is only read back on a matching machine.
+   *
+   * @param out_stream - the stream to write to.
+   */
+  void write(std::ostream& out_stream) const;
+
+  /**
+   * Read a graph written by write.
+   *
+   * The arrays are checked as they are read, so a truncated or corrupted
+   * checkpoint is rejected rather than producing an invalid graph.
+   *
+   * @param in_stream - the stream to read from.
+   * @return - the graph, or std::nullopt if the stream does not contain a
+   *           valid checkpoint.
+   */
+  static std::optional<FrozenGraph> read(std::istream& in_stream);
+
+ private:
+
+  /**
+   * Find the first of a node's outgoing edges whose label is not less than a
+   * string.
+   *
+   * @param node - the ID of the node.
+   * @param label - the string to compare the labels with.
+   * @return - the ID of the edge, or the end of the node's edges if there is
+   *           no such edge.
+   */
+  EdgeId lower_bound(NodeId node, std::string_view label) const;
+
+  // The edges out of node n are those from offsets_[n] up to offsets_[n + 1].
+  std::vector<EdgeId> offsets_;
+  std::vector<NodeId> targets_;
+  std::vector<Label::Id> label_ids_;
+  std::vector<bool> accept_;
+  size_t num_accept_;
+
+  std::shared_ptr<const LabelPool> label_pool_;
+  // The labels of the pool, indexed by ID.
+  std::vector<Label> labels_;
+};
+
+#endif //CAPS_FROZEN_GRAPH_H
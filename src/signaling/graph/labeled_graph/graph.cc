@@ -3,43 +3,72 @@
 #include "graph.h"
 
 // Include C++ standard libraries.
-#include <unordered_set>
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 // Include other headers from this project.
 #include "../../common/contains.h"
 #include "../../common/hash.h"
 #include "../../common/type_debug.h"
 
+namespace {
+
+// Building the in-edge index of a smaller graph is not worth starting a
+// thread for.
+constexpr size_t MIN_NODES_PER_THREAD = 1 << 16;
+
+// Run a function for each share of some work, on a thread per share, and
+// wait for all of them to finish.
+void run_shares(size_t num_shares, const std::function<void(size_t)>& run)
+{
+  std::vector<std::thread> threads;
+  for (size_t share = 1; share < num_shares; ++share) {
+    threads.emplace_back(run, share);
+  }
+  run(0);
+  for (auto& thread: threads) {
+    thread.join();
+  }
+}
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 // PUBLIC METHODS
 ////////////////////////////////////////////////////////////////////////////////
 
 LabeledGraph::LabeledGraph()
-  : root_{new Node}, num_accept_{0}, num_edges_{0}, compacted_{false}, nodes_{},
-    source_counts_{}, dest_counts_{}, label_counts_{}
+  : root_{nullptr}, num_accept_{0}, num_edges_{0}, compacted_{false},
+    in_edge_index_{false}, nodes_{}, source_counts_{}, dest_counts_{},
+    labels_{}, label_counts_{}
 {
-  nodes_.emplace(root_);
+  root_ = nodes_.allocate();
 }
 
 LabeledGraph::LabeledGraph(const LabeledGraph& orig)
-  : root_{nullptr}, num_accept_{0}, num_edges_{0}, compacted_{false}, nodes_{},
-    source_counts_{}, dest_counts_{}, label_counts_{}
+  : root_{nullptr}, num_accept_{0}, num_edges_{0}, compacted_{false},
+    in_edge_index_{orig.in_edge_index_}, nodes_{}, source_counts_{},
+    dest_counts_{}, labels_{}, label_counts_{}
 {
   // Create a translation table of node pointers from the original graph.
   std::unordered_map<Node*, Node*> node_table;
-  for (const auto& orig_node: orig.get_nodes()) {
-    auto orig_node_ptr = orig_node.get();
+  for (auto orig_node: orig.get_nodes()) {
     auto copy_node = add_unattached_node();
-    if (orig_node_ptr == orig.root_) {
+    if (orig_node == orig.root_) {
       root_ = copy_node;
     }
-    node_table.emplace(orig_node.get(), copy_node);
+    node_table.emplace(orig_node, copy_node);
   }
 
   // Add the edges to the graph.
-  for (const auto& orig_node: orig.get_nodes()) {
-    auto copy_node = node_table.at(orig_node.get());
+  for (auto orig_node: orig.get_nodes()) {
+    auto copy_node = node_table.at(orig_node);
     copy_node->set_accept(orig_node->get_accept());
     for (auto out_edge: orig_node->get_out_edges()) {
       const auto& [label, downstream_node] = out_edge;
@@ -49,6 +78,20 @@ LabeledGraph::LabeledGraph(const LabeledGraph& orig)
   }
 }
 
+void LabeledGraph::swap(LabeledGraph& other) noexcept
+{
+  std::swap(root_, other.root_);
+  std::swap(num_accept_, other.num_accept_);
+  std::swap(num_edges_, other.num_edges_);
+  std::swap(compacted_, other.compacted_);
+  std::swap(in_edge_index_, other.in_edge_index_);
+  nodes_.swap(other.nodes_);
+  source_counts_.swap(other.source_counts_);
+  dest_counts_.swap(other.dest_counts_);
+  labels_.swap(other.labels_);
+  label_counts_.swap(other.label_counts_);
+}
+
 Node* LabeledGraph::get_root() const
 {
   return root_;
@@ -89,14 +132,36 @@ const LabeledGraph::NodeMap& LabeledGraph::get_dest_counts() const
   return dest_counts_;
 }
 
-const LabeledGraph::LabelMap& LabeledGraph::get_label_counts() const
+LabeledGraph::LabelMap LabeledGraph::get_label_counts() const
+{
+  LabelMap counts;
+  for (Node::Label::Id id = 0; id < label_counts_.size(); ++id) {
+    if (label_counts_[id] > 0) {
+      counts.emplace(labels_.at(id).str(), label_counts_[id]);
+    }
+  }
+  return counts;
+}
+
+size_t LabeledGraph::get_label_count(const Node::Label& label) const
+{
+  return label.id() < label_counts_.size() ? label_counts_[label.id()] : 0;
+}
+
+size_t LabeledGraph::get_label_count(std::string_view label) const
+{
+  auto interned = labels_.find(label);
+  return interned.has_value() ? get_label_count(*interned) : 0;
+}
+
+const LabelPool& LabeledGraph::get_labels() const
 {
-  return label_counts_;
+  return labels_;
 }
 
 void LabeledGraph::set_accept(Node* node, bool accept)
 {
-  if (node == nullptr || nodes_.find(node) == nodes_.end()) {
+  if (!has_node(node)) {
     return;
   }
   if (!node->get_accept() && accept) {
@@ -108,17 +173,28 @@ void LabeledGraph::set_accept(Node* node, bool accept)
 }
 
 LabeledGraph::NodeHandle LabeledGraph::add_node(Node* source,
-                                                const std::string& label)
+                                                std::string_view label)
 {
   return add_edge(source, label);
 }
 
+LabeledGraph::NodeHandle LabeledGraph::add_node()
+{
+  return add_unattached_node();
+}
+
 void LabeledGraph::remove_node(Node* node)
 {
   // Only remove a node if it is in the graph.
   if (node == nullptr || !has_node(node)) {
     return;
   }
+  // The parents of the node can only be found with the in-edge index. If this
+  // call builds it, it also drops it again.
+  bool indexed = has_in_edge_index();
+  if (node->get_in_degree() > 0) {
+    build_in_edge_index();
+  }
 
   // Create a list of edges to delete first to prevent invalidating iterators.
   std::vector<Node::HalfEdge> in_edges;
@@ -141,30 +217,31 @@ void LabeledGraph::remove_node(Node* node)
   }
 
   remove_raw_node(node);
+  if (!indexed) {
+    drop_in_edge_index();
+  }
 }
 
 void LabeledGraph::add_edge(Node* source, Node* destination,
-                            const std::string& label)
+                            std::string_view label)
 {
   // If either the source or destination are not in the graph, do nothing.
-  if (source == nullptr || destination == nullptr) {
-    return;
-  }
-  if (nodes_.find(source) == nodes_.end()) {
-    return;
-  }
-  if (nodes_.find(destination) == nodes_.end()) {
+  if (!has_node(source) || !has_node(destination)) {
     return;
   }
+  auto interned = labels_.intern(label);
   // If the outgoing label exists at the source, remove it to ensure that the
   // destination of that edge is updated correctly.
-  Node* existing_child = nullptr;
-  if (source->has_out_label(label)) {
-    existing_child = source->follow_out_edge(label);
-    remove_edge(source, label);
+  auto existing_child = source->follow_out_edge(interned);
+  if (existing_child != nullptr) {
+    remove_edge(source, interned);
+  }
+  source->add_out_edge(interned, destination);
+  if (in_edge_index_) {
+    destination->add_in_edge(interned, source);
+  } else {
+    destination->count_in_edge();
   }
-  source->add_out_edge(label, destination);
-  destination->add_in_edge(label, source);
   if (existing_child != nullptr && existing_child->get_in_degree() == 0) {
     remove_node(existing_child);
   }
@@ -172,18 +249,19 @@ void LabeledGraph::add_edge(Node* source, Node* destination,
   ++num_edges_;
   ++source_counts_[source];
   ++dest_counts_[destination];
-  ++label_counts_[label];
+  label_counts_.resize(labels_.size(), 0);
+  ++label_counts_[interned.id()];
 }
 
 LabeledGraph::NodeHandle LabeledGraph::add_edge(Node* source,
-                                                const std::string& label)
+                                                std::string_view label)
 {
   auto new_node = add_unattached_node();
   add_edge(source, new_node, label);
   return new_node;
 }
 
-void LabeledGraph::remove_edge(Node* source, const std::string& label)
+void LabeledGraph::remove_edge(Node* source, std::string_view label)
 {
   // Do nothing if the source is null or does not have the label.
   if (source == nullptr || !has_node(source)) {
@@ -191,12 +269,84 @@ void LabeledGraph::remove_edge(Node* source, const std::string& label)
   }
 
   // Remove the edge from both incident nodes' edge maps.
-  auto dest = source->follow_out_edge(label);
-  if (dest == nullptr || !has_node(dest)) {
+  const auto& out_edges = source->get_out_edges();
+  auto edge = out_edges.find(label);
+  if (edge == out_edges.end() || !has_node(edge->second)) {
     return;
   }
 
-  remove_raw_edge(source, dest, label);
+  // Copy the edge, since removing it invalidates the iterator.
+  auto [edge_label, dest] = *edge;
+  remove_raw_edge(source, dest, edge_label);
+}
+
+void LabeledGraph::build_in_edge_index()
+{
+  if (in_edge_index_) {
+    return;
+  }
+  in_edge_index_ = true;
+
+  size_t num_threads = std::min<size_t>(
+    std::thread::hardware_concurrency(),
+    nodes_.capacity() / MIN_NODES_PER_THREAD);
+  if (num_threads <= 1) {
+    for (auto node: nodes_) {
+      for (const auto& [label, child]: node->get_out_edges()) {
+        child->index_in_edge(label, node);
+      }
+    }
+    return;
+  }
+
+  // Each thread first reads the outgoing edges of its share of the nodes,
+  // and sorts them into a bucket per share of the arena chunks by their
+  // destinations. Each thread then stores the edges from every thread's
+  // bucket for its share, so every edge is read once and no two threads
+  // modify the same node (or, for the most part, the same cache line).
+  using Bucket = std::vector<std::pair<Node*, Node::HalfEdge>>;
+  std::vector<std::vector<Bucket>> buckets(num_threads,
+                                           std::vector<Bucket>(num_threads));
+  auto get_share = [num_threads](const Node* node) {
+    return node->get_index() / NodeSet::CHUNK_SIZE % num_threads;
+  };
+  auto collect_share = [this, num_threads, &buckets, &get_share](
+    size_t share) {
+    auto first = nodes_.capacity() * share / num_threads;
+    auto last = nodes_.capacity() * (share + 1) / num_threads;
+    for (auto index = first; index < last; ++index) {
+      auto node = nodes_.at(static_cast<NodeSet::Index>(index));
+      if (!nodes_.contains(node)) {
+        continue;
+      }
+      for (const auto& [label, child]: node->get_out_edges()) {
+        buckets[share][get_share(child)].emplace_back(
+          child, Node::HalfEdge{label, node});
+      }
+    }
+  };
+  auto index_share = [&buckets](size_t share) {
+    for (auto& thread_buckets: buckets) {
+      for (const auto& [child, in_edge]: thread_buckets[share]) {
+        child->index_in_edge(in_edge.first, in_edge.second);
+      }
+      // Release each bucket as soon as its edges are stored.
+      Bucket{}.swap(thread_buckets[share]);
+    }
+  };
+  run_shares(num_threads, collect_share);
+  run_shares(num_threads, index_share);
+}
+
+void LabeledGraph::drop_in_edge_index()
+{
+  if (!in_edge_index_) {
+    return;
+  }
+  for (auto node: nodes_) {
+    node->clear_in_edges();
+  }
+  in_edge_index_ = false;
 }
 
 using namespace std;
@@ -233,9 +383,7 @@ void LabeledGraph::print_graph(string filename) const {
 
 LabeledGraph::NodeHandle LabeledGraph::add_unattached_node()
 {
-  auto new_node = new Node;
-  nodes_.emplace(new_node);
-  return new_node;
+  return nodes_.allocate();
 }
 
 void LabeledGraph::remove_raw_node(Node* node)
@@ -248,39 +396,39 @@ void LabeledGraph::remove_raw_node(Node* node)
   }
   source_counts_.erase(node);
   dest_counts_.erase(node);
-  nodes_.erase(nodes_.find(node));
+  nodes_.release(node);
 }
 
 void LabeledGraph::remove_raw_edge(Node* source, Node* dest,
-                                   const std::string& label)
+                                   const Node::Label& label)
 {
-  if (source == nullptr || dest == nullptr) {
+  if (source == nullptr || dest == nullptr || !has_node(source)
+      || !source->has_out_edge(label, dest)) {
     return;
   }
-  if (has_node(source) && source->has_out_edge(label, dest)) {
-    remove_raw_out_edge(source, label);
-  }
-  if (has_node(dest) && dest->has_in_edge(label, source)) {
+  remove_raw_out_edge(source, label);
+  if (has_node(dest)) {
     remove_raw_in_edge(dest, source, label);
   }
   --num_edges_;
-  --label_counts_[label];
-  if (label_counts_[label] == 0) {
-    label_counts_.erase(label);
-  }
+  --label_counts_[label.id()];
 }
 
 void LabeledGraph::remove_raw_in_edge(Node* node, Node* parent,
-                                      const std::string& label)
+                                      const Node::Label& label)
 {
-  node->remove_in_edge(label, parent);
+  if (in_edge_index_) {
+    node->remove_in_edge(label, parent);
+  } else {
+    node->uncount_in_edge();
+  }
   --dest_counts_[node];
   if (dest_counts_[node] == 0) {
     dest_counts_.erase(node);
   }
 }
 
-void LabeledGraph::remove_raw_out_edge(Node* node, const std::string& label)
+void LabeledGraph::remove_raw_out_edge(Node* node, const Node::Label& label)
 {
   node->remove_out_edge(label);
   --source_counts_[node];
@@ -291,7 +439,12 @@ void LabeledGraph::remove_raw_out_edge(Node* node, const std::string& label)
 
 bool LabeledGraph::has_node(Node* node) const
 {
-  return nodes_.find(node) != nodes_.end();
+  return nodes_.contains(node);
+}
+
+bool LabeledGraph::has_in_edge_index() const
+{
+  return in_edge_index_;
 }
 
 bool operator==(const LabeledGraph& lhs, const LabeledGraph& rhs)
@@ -318,8 +471,9 @@ bool operator==(const LabeledGraph& lhs, const LabeledGraph& rhs)
   std::queue<PairType> queue;
   queue.emplace(left_root, right_root);
   while (!queue.empty()) {
-    // Get a pair of node pointers from the queue.
-    const auto& [first, second] = queue.front();
+    // Get a pair of node pointers from the queue. Copy it, since popping
+    // destroys the front element.
+    auto [first, second] = queue.front();
     queue.pop();
 
     // Reject if nodes do not have the same accept status or if their
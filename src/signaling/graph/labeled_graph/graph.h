@@ -6,13 +6,15 @@
 #include <memory>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <queue>
-#include <string>
+#include <vector>
 
 // Include other header files from this project.
+#include "../node/label.h"
 #include "../node/node.h"
-#include "../../common/pointer_comparator.h"
+#include "../node/node_arena.h"
 
 /**
  * Directed graph with unique root node and string-labeled edges.
@@ -23,7 +25,7 @@ class LabeledGraph
 
   // Alias declarations
   using NodeHandle = Node*;
-  using NodeSet = std::set<std::unique_ptr<Node>, pointer_comparator<Node>>;
+  using NodeSet = NodeArena;
   using NodeMap = std::unordered_map<NodeHandle, size_t>;
   using LabelMap = std::unordered_map<std::string, size_t>;
 
@@ -49,6 +51,16 @@ class LabeledGraph
    */
   LabeledGraph(const LabeledGraph& orig);
 
+  /**
+   * Swap the contents of two graphs.
+   *
+   * No nodes are copied, so pointers to nodes in either graph remain valid
+   * and refer to nodes of the other graph after the swap.
+   *
+   * @param other - the graph to swap with.
+   */
+  void swap(LabeledGraph& other) noexcept;
+
   // Accessors
 
   /**
@@ -77,12 +89,77 @@ class LabeledGraph
 
   const NodeMap& get_dest_counts() const;
 
-  const LabelMap& get_label_counts() const;
+  /**
+   * Get the number of edges with each label.
+   *
+   * The counts are kept by label ID, so the map is built on each call.
+   *
+   * @return - a map from each label in use to the number of edges with it.
+   */
+  LabelMap get_label_counts() const;
+
+  /**
+   * Get the number of edges with a label.
+   *
+   * @param label - a label interned by this graph.
+   * @return - the number of edges with the label.
+   */
+  size_t get_label_count(const Node::Label& label) const;
+
+  /**
+   * Get the number of edges with a label.
+   *
+   * @param label - the string of the label.
+   * @return - the number of edges with the label, which is 0 if no edge has
+   *           ever had it.
+   */
+  size_t get_label_count(std::string_view label) const;
+
+  /**
+   * Get the pool of labels interned by the graph.
+   *
+   * Every edge label is interned when the edge is added, so labels can be
+   * identified by their IDs in the pool. Labels are never removed from the
+   * pool, even when no edge has them any more.
+   *
+   * @return
+   */
+  const LabelPool& get_labels() const;
 
   bool has_node(Node* node) const;
 
+  /**
+   * Check whether the graph stores the incoming edges of its nodes.
+   *
+   * @return - true if Node::get_in_edges returns the incoming edges of every
+   *           node in the graph, and false if it returns empty sets.
+   */
+  bool has_in_edge_index() const;
+
   // Operations
 
+  /**
+   * Store the incoming edges of every node, and keep storing them as edges
+   * are added and removed, until drop_in_edge_index is called.
+   *
+   * The in-degree of each node is always maintained, but only a few
+   * algorithms (such as finding connected components for compaction) need
+   * the incoming edges themselves, so building a graph does not store them
+   * by default. The outgoing edges are read once, split across threads by
+   * their source nodes, and then stored, split across threads by their
+   * destination nodes. Large graphs therefore need memory for a copy of
+   * their edges while the index is built. If the graph already has an
+   * in-edge index, do nothing.
+   */
+  void build_in_edge_index();
+
+  /**
+   * Stop storing the incoming edges of the nodes and release their memory.
+   *
+   * If the graph has no in-edge index, do nothing.
+   */
+  void drop_in_edge_index();
+
   /**
    * Set the accept state of a node in the graph.
    *
@@ -95,11 +172,27 @@ class LabeledGraph
    */
   void set_accept(Node* node, bool accept);
 
-  NodeHandle add_node(Node* source, const std::string& label);
+  NodeHandle add_node(Node* source, std::string_view label);
+
+  /**
+   * Add a node with no edges to the graph.
+   *
+   * The caller is responsible for connecting the node to the rest of the
+   * graph, e.g., when rebuilding a graph from a list of nodes and edges.
+   *
+   * @return - a pointer to the new node.
+   */
+  NodeHandle add_node();
 
   /**
    * Remove a node from the graph.
    *
+   * The edges into the node are removed as well. If the node has incoming
+   * edges but the graph has no in-edge index, the index is built for the call
+   * and dropped afterwards, since the parents of the node cannot be found
+   * otherwise. Callers removing many such nodes should build the index
+   * first.
+   *
    * Preconditions:
    *   * node is a non-null pointer.
    *   * The node is a member of the graph (i.e., has_node(node) is true).
@@ -112,11 +205,22 @@ class LabeledGraph
    */
   void remove_node(Node* node);
 
-  void add_edge(Node* source, Node* destination, const std::string& label);
+  /**
+   * Add an edge to the graph, replacing any edge from the source with the
+   * same label.
+   *
+   * If either node is not in the graph, do nothing. If the replaced edge was
+   * the last edge into its destination, the destination is removed.
+   *
+   * @param source - the source of the edge.
+   * @param destination - the destination of the edge.
+   * @param label - the label of the edge, which is interned by the graph.
+   */
+  void add_edge(Node* source, Node* destination, std::string_view label);
 
-  NodeHandle add_edge(Node* source, const std::string& label);
+  NodeHandle add_edge(Node* source, std::string_view label);
 
-  void remove_edge(Node* source, const std::string& label);
+  void remove_edge(Node* source, std::string_view label);
 
   void print_graph(std::string filename) const;
 
@@ -126,20 +230,23 @@ class LabeledGraph
 
   void remove_raw_node(Node* node);
 
-  void remove_raw_edge(Node* source, Node* dest, const std::string& label);
+  void remove_raw_edge(Node* source, Node* dest, const Node::Label& label);
 
-  void remove_raw_in_edge(Node* node, Node* parent, const std::string& label);
+  void remove_raw_in_edge(Node* node, Node* parent, const Node::Label& label);
 
-  void remove_raw_out_edge(Node* node, const std::string& label);
+  void remove_raw_out_edge(Node* node, const Node::Label& label);
 
   Node* root_;
   size_t num_accept_;
   size_t num_edges_;
   bool compacted_;
+  bool in_edge_index_;
   NodeSet nodes_;
   NodeMap source_counts_;
   NodeMap dest_counts_;
-  LabelMap label_counts_;
+  LabelPool labels_;
+  // The number of edges with each label, indexed by label ID.
+  std::vector<size_t> label_counts_;
 
 };
 
@@ -0,0 +1,242 @@
+/**
+ * Edge labels interned in a pool of contiguous string storage.
+ */
+
+// Include header file.
+#include "label.h"
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Include C++ standard libraries.
+#include <array>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+
+// Include headers from other projects.
+
+namespace {
+
+// Strings are copied into blocks of this many characters. Longer strings get
+// a block of their own.
+constexpr size_t BLOCK_SIZE = 1 << 16;
+constexpr size_t MAX_SHARED_LENGTH = BLOCK_SIZE / 4;
+
+constexpr size_t NUM_CHARS = 256;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Label methods
+////////////////////////////////////////////////////////////////////////////////
+
+Label::Label() noexcept
+  : entry_{nullptr}
+{
+  static const Entry empty{"", 0, NO_ID, std::hash<std::string_view>{}(""),
+                           nullptr};
+  entry_ = &empty;
+}
+
+Label::Label(const Entry* entry) noexcept
+  : entry_{entry}
+{
+  // Nothing to do here.
+}
+
+Label::Id Label::id() const noexcept
+{
+  return entry_->id;
+}
+
+std::string_view Label::str() const noexcept
+{
+  return {entry_->data, entry_->length};
+}
+
+Label::operator std::string_view() const noexcept
+{
+  return str();
+}
+
+size_t Label::length() const noexcept
+{
+  return entry_->length;
+}
+
+bool Label::empty() const noexcept
+{
+  return entry_->length == 0;
+}
+
+char Label::front() const noexcept
+{
+  return entry_->data[0];
+}
+
+size_t Label::hash() const noexcept
+{
+  return entry_->hash;
+}
+
+bool operator==(const Label& lhs, const Label& rhs) noexcept
+{
+  // A pool holds each string once, so labels from the same pool only need to
+  // be compared by their strings if they come from different pools.
+  return lhs.entry_ == rhs.entry_
+         || (lhs.entry_->owner != rhs.entry_->owner && lhs.str() == rhs.str());
+}
+
+bool operator<(const Label& lhs, const Label& rhs) noexcept
+{
+  return lhs.entry_ != rhs.entry_ && lhs.str() < rhs.str();
+}
+
+bool operator!=(const Label& lhs, const Label& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+bool operator<(const Label& lhs, std::string_view rhs) noexcept
+{
+  return lhs.str() < rhs;
+}
+
+bool operator<(std::string_view lhs, const Label& rhs) noexcept
+{
+  return lhs < rhs.str();
+}
+
+bool operator==(const Label& lhs, std::string_view rhs) noexcept
+{
+  return lhs.str() == rhs;
+}
+
+bool operator==(std::string_view lhs, const Label& rhs) noexcept
+{
+  return lhs == rhs.str();
+}
+
+std::ostream& operator<<(std::ostream& out, const Label& label)
+{
+  return out << label.str();
+}
+
+size_t hash_value(const Label& label) noexcept
+{
+  return label.hash();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LabelPool methods
+////////////////////////////////////////////////////////////////////////////////
+
+struct LabelPool::Storage
+{
+  // Copy a string into the blocks and return the copy.
+  const char* store(std::string_view text)
+  {
+    if (text.length() > MAX_SHARED_LENGTH) {
+      blocks.emplace_back(new char[text.length()]);
+      std::memcpy(blocks.back().get(), text.data(), text.length());
+      return blocks.back().get();
+    }
+    if (text.length() > block_remaining) {
+      blocks.emplace_back(new char[BLOCK_SIZE]);
+      block_position = blocks.back().get();
+      block_remaining = BLOCK_SIZE;
+    }
+    auto copy = block_position;
+    std::memcpy(copy, text.data(), text.length());
+    block_position += text.length();
+    block_remaining -= text.length();
+    return copy;
+  }
+
+  std::vector<std::unique_ptr<char[]>> blocks;
+  char* block_position = nullptr;
+  size_t block_remaining = 0;
+
+  // A deque never moves its elements, so labels can point to them.
+  std::deque<Label::Entry> entries;
+  std::unordered_map<std::string_view, const Label::Entry*> index;
+
+  // Labels of a single character are by far the most common, so they are
+  // found without hashing.
+  std::array<const Label::Entry*, NUM_CHARS> chars{};
+};
+
+LabelPool::LabelPool()
+  : storage_{std::make_unique<Storage>()}
+{
+  // Nothing to do here.
+}
+
+LabelPool::~LabelPool() = default;
+
+Label LabelPool::intern(std::string_view text)
+{
+  const Label::Entry** char_entry = nullptr;
+  if (text.length() == 1) {
+    char_entry = &storage_->chars[static_cast<unsigned char>(text.front())];
+    if (*char_entry != nullptr) {
+      return Label{*char_entry};
+    }
+  } else {
+    auto existing = storage_->index.find(text);
+    if (existing != storage_->index.end()) {
+      return Label{existing->second};
+    }
+  }
+
+  auto hash = std::hash<std::string_view>{}(text);
+  auto data = storage_->store(text);
+  auto id = static_cast<Label::Id>(storage_->entries.size());
+  storage_->entries.push_back(
+    {data, static_cast<uint32_t>(text.length()), id, hash, storage_.get()});
+  const auto* entry = &storage_->entries.back();
+  if (char_entry != nullptr) {
+    *char_entry = entry;
+  } else {
+    storage_->index.emplace(std::string_view{data, text.length()}, entry);
+  }
+  return Label{entry};
+}
+
+std::optional<Label> LabelPool::find(std::string_view text) const
+{
+  if (text.length() == 1) {
+    auto entry = storage_->chars[static_cast<unsigned char>(text.front())];
+    return entry != nullptr ? std::make_optional(Label{entry}) : std::nullopt;
+  }
+  auto existing = storage_->index.find(text);
+  if (existing == storage_->index.end()) {
+    return std::nullopt;
+  }
+  return Label{existing->second};
+}
+
+Label LabelPool::at(Label::Id id) const
+{
+  return Label{&storage_->entries[id]};
+}
+
+size_t LabelPool::size() const noexcept
+{
+  return storage_->entries.size();
+}
+
+void LabelPool::swap(LabelPool& other) noexcept
+{
+  storage_.swap(other.storage_);
+}
@@ -0,0 +1,172 @@
+/**
+ * Edge labels interned in a pool of contiguous string storage.
+ */
+
+#ifndef CAPS_LABEL_H
+#define CAPS_LABEL_H
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+// Include C++ standard libraries.
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+// Include other headers from this project.
+
+// Include headers from other projects.
+
+/**
+ * Handle to a string interned in a LabelPool.
+ *
+ * A label is the size of a pointer and is cheap to copy, compare, and hash.
+ * Each label has a dense ID within its pool that can be used to index side
+ * tables, and a hash of its string computed when it was interned. Labels
+ * from the same pool are equal exactly when they are the same handle; labels
+ * from different pools are equal when their strings are. Labels are ordered
+ * by their strings, so edges sorted by label are in lexicographic order.
+ *
+ * A label stays valid for as long as the pool that interned it exists
+ * (including after the pool is swapped with another).
+ */
+class Label
+{
+ public:
+
+  using Id = uint32_t;
+
+  // The ID of the default-constructed (empty) label, which is not in any pool.
+  static constexpr Id NO_ID = UINT32_MAX;
+
+  /**
+   * Create an empty label that does not belong to any pool.
+   */
+  Label() noexcept;
+
+  Id id() const noexcept;
+
+  std::string_view str() const noexcept;
+
+  operator std::string_view() const noexcept;
+
+  size_t length() const noexcept;
+
+  bool empty() const noexcept;
+
+  char front() const noexcept;
+
+  /**
+   * Get the hash of the label's string, which is the same for equal labels
+   * from different pools.
+   */
+  size_t hash() const noexcept;
+
+  friend bool operator==(const Label& lhs, const Label& rhs) noexcept;
+
+  friend bool operator<(const Label& lhs, const Label& rhs) noexcept;
+
+ private:
+
+  friend class LabelPool;
+
+  struct Entry
+  {
+    const char* data;
+    uint32_t length;
+    Id id;
+    size_t hash;
+    // Identifies the storage the entry belongs to.
+    const void* owner;
+  };
+
+  explicit Label(const Entry* entry) noexcept;
+
+  const Entry* entry_;
+};
+
+bool operator!=(const Label& lhs, const Label& rhs) noexcept;
+
+// Compare labels with strings, for lookups by string.
+bool operator<(const Label& lhs, std::string_view rhs) noexcept;
+bool operator<(std::string_view lhs, const Label& rhs) noexcept;
+bool operator==(const Label& lhs, std::string_view rhs) noexcept;
+bool operator==(std::string_view lhs, const Label& rhs) noexcept;
+
+std::ostream& operator<<(std::ostream& out, const Label& label);
+
+// Allow labels to be hashed with boost::hash.
+size_t hash_value(const Label& label) noexcept;
+
+namespace std {
+  template<> struct hash<Label>
+  {
+    size_t operator()(const Label& label) const noexcept
+    {
+      return label.hash();
+    }
+  };
+}
+
+/**
+ * Interner that gives each distinct string a Label with a dense ID.
+ *
+ * The strings are copied into large shared blocks rather than allocated one
+ * at a time, and are never moved or freed until the pool is destroyed, so a
+ * graph stores each distinct label once however many edges carry it.
+ */
+class LabelPool
+{
+ public:
+
+  LabelPool();
+
+  ~LabelPool();
+
+  // Labels refer to the storage of their pool, so the pool cannot be copied.
+  LabelPool(const LabelPool& orig) = delete;
+
+  LabelPool& operator=(const LabelPool& orig) = delete;
+
+  /**
+   * Get the label for a string, adding the string to the pool if needed.
+   *
+   * @param text - the string to intern.
+   * @return - the label, whose ID is the number of distinct strings interned
+   *           before it.
+   */
+  Label intern(std::string_view text);
+
+  /**
+   * Get the label for a string without adding it.
+   *
+   * @param text - the string to look for.
+   * @return - the label, or std::nullopt if the string is not in the pool.
+   */
+  std::optional<Label> find(std::string_view text) const;
+
+  /**
+   * @param id - the ID of a label in the pool.
+   * @return - the label with the ID.
+   */
+  Label at(Label::Id id) const;
+
+  /**
+   * @return - the number of distinct strings in the pool, which is one more
+   *           than the largest ID.
+   */
+  size_t size() const noexcept;
+
+  void swap(LabelPool& other) noexcept;
+
+ private:
+
+  struct Storage;
+
+  std::unique_ptr<Storage> storage_;
+};
+
+#endif //CAPS_LABEL_H
@@ -5,18 +5,31 @@
 // Include header file.
 #include "node.h"
 
+// Include C standard libraries.
+#include <cstdint>
+
 // Include C++ standard libraries.
+#include <functional>
 #include <iostream>
 #include <optional>
 #include <string>
+#include <string_view>
 
 // Include other headers from this project.
 #include "../../common/contains.h"
 
 // Include headers from other projects.
 
+namespace {
+
+// Combined with the out-edge hash of accepting nodes.
+constexpr size_t ACCEPT_HASH = 0x9e3779b97f4a7c15ULL;
+
+}  // namespace
+
 Node::Node()
-  : accept_{false}, in_edges_{}, out_edges_{}
+  : accept_{false}, in_edges_{}, in_degree_{0}, out_edges_{}, out_hash_{0},
+    index_{NO_INDEX}
 {
   // Nothing to do here.
 #ifdef DEBUG
@@ -31,7 +44,7 @@ bool Node::get_accept() const noexcept
 
 size_t Node::get_in_degree() const noexcept
 {
-  return in_edges_.size();
+  return in_degree_;
 }
 
 size_t Node::get_out_degree() const noexcept
@@ -44,12 +57,12 @@ bool Node::has_in_edge(const Label& label, Node* source) const
   return contains(in_edges_, std::make_pair(label, source));
 }
 
-bool Node::has_out_edge(const Label& label, const Node* target) const
+bool Node::has_out_edge(std::string_view label, const Node* target) const
 {
   return follow_out_edge(label) == target;
 }
 
-bool Node::has_out_label(const Label& label) const
+bool Node::has_out_label(std::string_view label) const
 {
   return out_edges_.find(label) != out_edges_.end();
 }
@@ -61,35 +74,46 @@ void Node::set_accept(bool accept) noexcept
 
 void Node::add_in_edge(const Label& label, Node* source)
 {
-  in_edges_.emplace(label, source);
+  if (in_edges_.emplace(label, source).second) {
+    ++in_degree_;
+  }
 }
 
 void Node::remove_in_edge(const Label& label, Node* source)
 {
-  in_edges_.erase(std::make_pair(label, source));
+  if (in_edges_.erase(std::make_pair(label, source)) > 0) {
+    --in_degree_;
+  }
 }
 
 void Node::add_out_edge(const Label& label, Node* target)
 {
-  out_edges_.emplace(label, target);
+  if (out_edges_.emplace(label, target).second) {
+    out_hash_ += out_edge_hash(label, target);
+  }
 }
 
-void Node::remove_out_edge(const Label& label)
+void Node::remove_out_edge(std::string_view label)
 {
-  out_edges_.erase(label);
+  auto edge = out_edges_.find(label);
+  if (edge != out_edges_.end()) {
+    out_hash_ -= out_edge_hash(edge->first, edge->second);
+    out_edges_.erase(edge);
+  }
 }
 
-Node* Node::follow_out_edge(const Label& label) const
+Node* Node::follow_out_edge(std::string_view label) const
 {
-  return has_out_label(label) ? out_edges_.at(label) : nullptr;
+  auto edge = out_edges_.find(label);
+  return edge != out_edges_.end() ? edge->second : nullptr;
 }
 
-const std::set<Node::HalfEdge>& Node::get_in_edges() const
+const Node::InEdgeSet& Node::get_in_edges() const
 {
   return in_edges_;
 }
 
-const std::map<Node::Label, Node*>& Node::get_out_edges() const
+const Node::OutEdgeSet& Node::get_out_edges() const
 {
   return out_edges_;
 }
@@ -117,6 +141,59 @@ ReverseIterable<Node::OutEdgeSet> Node::get_reverse_out_edges() const
   return {out_edges_};
 }
 
+size_t Node::get_out_hash() const noexcept
+{
+  // The accept flag is applied last, since XOR does not commute with the
+  // sum of the edge terms.
+  return accept_ ? out_hash_ ^ ACCEPT_HASH : out_hash_;
+}
+
+Node::Index Node::get_index() const noexcept
+{
+  return index_;
+}
+
+void Node::reset() noexcept
+{
+  accept_ = false;
+  in_edges_.clear();
+  in_degree_ = 0;
+  out_edges_.clear();
+  out_hash_ = 0;
+}
+
+void Node::count_in_edge() noexcept
+{
+  ++in_degree_;
+}
+
+void Node::uncount_in_edge() noexcept
+{
+  --in_degree_;
+}
+
+void Node::index_in_edge(const Label& label, Node* source)
+{
+  in_edges_.emplace(label, source);
+}
+
+void Node::clear_in_edges() noexcept
+{
+  in_edges_.clear();
+}
+
+size_t Node::out_edge_hash(const Label& label, const Node* target)
+{
+  // The edge terms are summed, so mix each one (with the finalizer of
+  // splitmix64) to keep the sum well distributed.
+  size_t hash = std::hash<Label>{}(label);
+  boost::hash_combine(hash, target);
+  uint64_t mixed = hash;
+  mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+  return static_cast<size_t>(mixed ^ (mixed >> 31));
+}
+
 bool operator==(const Node& lhs, const Node& rhs)
 {
   return (lhs.get_accept() == rhs.get_accept()
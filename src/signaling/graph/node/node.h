@@ -9,15 +9,20 @@
 
 //#define DEBUG
 
+// Include C standard libraries.
+#include <cstdint>
+
 // Include C++ standard libraries.
-#include <map>
 #include <memory>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 
 // Include other headers from this project.
+#include "../../common/flat_set.h"
 #include "../../common/iterable.h"
+#include "label.h"
 
 // Include headers from other projects.
 #include <boost/functional/hash.hpp>
@@ -32,10 +37,20 @@ class Node
 
   // Alias declarations
   using NodeHandle = Node*;
-  using Label = std::string;
+  // Labels are interned by the graph that owns the node (see LabelPool).
+  using Label = ::Label;
   using HalfEdge = std::pair<Label, NodeHandle>;
+  // Out-edges are kept in a flat set sorted by label, with room for the common
+  // case of a few edges inside the node itself. In-edges stay in a tree,
+  // since nodes shared by many strings (such as the final accept node) can
+  // have in-degrees in the tens of thousands, and each insertion into a flat
+  // set would then take time linear in the in-degree.
   using InEdgeSet = std::set<HalfEdge>;
-  using OutEdgeSet = std::map<Label, NodeHandle>;
+  using OutEdgeSet = FlatSet<HalfEdge, FirstKey, 2>;
+  using Index = uint32_t;
+
+  // The index of a node that is not stored in a NodeArena.
+  static constexpr Index NO_INDEX = UINT32_MAX;
 
   /**
    * Create an empty node.
@@ -55,6 +70,9 @@ class Node
 
   /**
    * Get the node's in-degree (i.e., the number of incoming edges).
+   *
+   * The in-degree is always kept up to date, even when the graph that owns
+   * the node does not index its incoming edges.
    * @return
    */
   size_t get_in_degree() const noexcept;
@@ -81,14 +99,14 @@ class Node
    * @param source
    * @return
    */
-  bool has_out_edge(const Label& label, const Node* source) const;
+  bool has_out_edge(std::string_view label, const Node* source) const;
 
   /**
    * Check whether a node has an outgoing edge with a given label.
    * @param label
    * @return
    */
-  bool has_out_label(const Label& label) const;
+  bool has_out_label(std::string_view label) const;
 
   /**
    * Set the node's accept flag value.
@@ -131,7 +149,7 @@ class Node
    * single outgoing edge with a given label at any time.
    * @param label
    */
-  void remove_out_edge(const Label& label);
+  void remove_out_edge(std::string_view label);
 
   /**
    * Get a pointer to the target node of a node's outgoing edge with a given
@@ -139,19 +157,23 @@ class Node
    * @param label
    * @return
    */
-  Node* follow_out_edge(const Label& label) const;
+  Node* follow_out_edge(std::string_view label) const;
 
   /**
    * Get the set of a node's incoming edges.
+   *
+   * A LabeledGraph only stores the incoming edges of its nodes while it has
+   * an in-edge index (see LabeledGraph::build_in_edge_index). Otherwise, the
+   * set is empty even if the in-degree is not.
    * @return
    */
-  const std::set<HalfEdge>& get_in_edges() const;
+  const InEdgeSet& get_in_edges() const;
 
   /**
    * Get the set of a node's outgoing edges.
    * @return
    */
-  const std::map<Label, Node*>& get_out_edges() const;
+  const OutEdgeSet& get_out_edges() const;
 
   /**
    * Get the set of a node's incoming edges in reverse order.
@@ -178,10 +200,67 @@ class Node
 
   std::string get_id() const;
 
+  /**
+   * Get a hash of the node's accept flag value and outgoing edges.
+   *
+   * The hash is combined from a term for each outgoing edge and is updated
+   * whenever the accept flag or an outgoing edge changes, so nodes with the
+   * same right language can be found without iterating over their edges.
+   * @return
+   */
+  size_t get_out_hash() const noexcept;
+
+  /**
+   * Get the index of the node's slot in the NodeArena that stores it.
+   * @return the index, or NO_INDEX if the node is not stored in an arena.
+   */
+  Index get_index() const noexcept;
+
  private:
+  // The arena sets the index of each node it stores, and resets nodes that are
+  // released so that their slots can be reused.
+  friend class NodeArena;
+
+  // The graph counts incoming edges without storing them when it has no
+  // in-edge index, and fills or clears the in-edge sets of its nodes when the
+  // index is built or dropped.
+  friend class LabeledGraph;
+
+  static size_t out_edge_hash(const Label& label, const Node* target);
+
+  /**
+   * Remove all edges and unset the accept flag, keeping the index.
+   */
+  void reset() noexcept;
+
+  /**
+   * Count an incoming edge in the in-degree without storing it.
+   */
+  void count_in_edge() noexcept;
+
+  /**
+   * Uncount an incoming edge from the in-degree without removing it.
+   */
+  void uncount_in_edge() noexcept;
+
+  /**
+   * Store an incoming edge that is already counted in the in-degree.
+   * @param label
+   * @param source
+   */
+  void index_in_edge(const Label& label, Node* source);
+
+  /**
+   * Release the stored incoming edges, keeping the in-degree.
+   */
+  void clear_in_edges() noexcept;
+
   bool accept_;
   InEdgeSet in_edges_;
+  size_t in_degree_;
   OutEdgeSet out_edges_;
+  size_t out_hash_;
+  Index index_;
 };
 
 /**
@@ -0,0 +1,163 @@
+/**
+ * Chunked storage for the nodes of a graph, addressed by dense 32-bit indices.
+ */
+
+// Include header file.
+#include "node_arena.h"
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+// Include C++ standard libraries.
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "node.h"
+
+// Include headers from other projects.
+
+namespace {
+
+constexpr size_t BITS_IN_WORD = 64;
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// NodeArena::const_iterator methods
+////////////////////////////////////////////////////////////////////////////////
+
+NodeArena::const_iterator::const_iterator(const NodeArena* arena, size_t index)
+  : arena_{arena}, index_{index}
+{
+  skip_released();
+}
+
+Node* NodeArena::const_iterator::operator*() const
+{
+  return arena_->at(static_cast<Index>(index_));
+}
+
+NodeArena::const_iterator& NodeArena::const_iterator::operator++()
+{
+  ++index_;
+  skip_released();
+  return *this;
+}
+
+NodeArena::const_iterator NodeArena::const_iterator::operator++(int)
+{
+  auto copy = *this;
+  ++*this;
+  return copy;
+}
+
+bool NodeArena::const_iterator::operator==(const const_iterator& other) const
+{
+  return arena_ == other.arena_ && index_ == other.index_;
+}
+
+bool NodeArena::const_iterator::operator!=(const const_iterator& other) const
+{
+  return !(*this == other);
+}
+
+void NodeArena::const_iterator::skip_released()
+{
+  while (index_ < arena_->num_slots_ && !arena_->is_live(index_)) {
+    ++index_;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// NodeArena methods
+////////////////////////////////////////////////////////////////////////////////
+
+NodeArena::NodeArena()
+  : chunks_{}, live_{}, free_{}, num_slots_{0}, size_{0}
+{
+  // Nothing to do here.
+}
+
+Node* NodeArena::allocate()
+{
+  size_t index;
+  if (!free_.empty()) {
+    index = free_.back();
+    free_.pop_back();
+  } else {
+    index = num_slots_++;
+    if (index % CHUNK_SIZE == 0) {
+      chunks_.emplace_back(new Node[CHUNK_SIZE]);
+    }
+    if (index % BITS_IN_WORD == 0) {
+      live_.push_back(0);
+    }
+  }
+  auto node = at(static_cast<Index>(index));
+  node->index_ = static_cast<Index>(index);
+  live_[index / BITS_IN_WORD] |= static_cast<uint64_t>(1)
+                                 << (index % BITS_IN_WORD);
+  ++size_;
+  return node;
+}
+
+void NodeArena::release(Node* node)
+{
+  auto index = node->get_index();
+  node->reset();
+  live_[index / BITS_IN_WORD] &= ~(static_cast<uint64_t>(1)
+                                   << (index % BITS_IN_WORD));
+  free_.push_back(index);
+  --size_;
+}
+
+bool NodeArena::contains(const Node* node) const
+{
+  if (node == nullptr) {
+    return false;
+  }
+  auto index = node->get_index();
+  return index < num_slots_ && is_live(index) && at(index) == node;
+}
+
+Node* NodeArena::at(Index index) const
+{
+  return &chunks_[index / CHUNK_SIZE][index % CHUNK_SIZE];
+}
+
+size_t NodeArena::size() const noexcept
+{
+  return size_;
+}
+
+size_t NodeArena::capacity() const noexcept
+{
+  return num_slots_;
+}
+
+NodeArena::const_iterator NodeArena::begin() const
+{
+  return {this, 0};
+}
+
+NodeArena::const_iterator NodeArena::end() const
+{
+  return {this, num_slots_};
+}
+
+void NodeArena::swap(NodeArena& other) noexcept
+{
+  chunks_.swap(other.chunks_);
+  live_.swap(other.live_);
+  free_.swap(other.free_);
+  std::swap(num_slots_, other.num_slots_);
+  std::swap(size_, other.size_);
+}
+
+bool NodeArena::is_live(size_t index) const
+{
+  return (live_[index / BITS_IN_WORD] >> (index % BITS_IN_WORD)) & 1;
+}
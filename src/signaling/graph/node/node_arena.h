@@ -0,0 +1,139 @@
+/**
+ * Chunked storage for the nodes of a graph, addressed by dense 32-bit indices.
+ */
+
+#ifndef CAPS_NODE_ARENA_H
+#define CAPS_NODE_ARENA_H
+
+// Include C standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+// Include C++ standard libraries.
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// Include other headers from this project.
+#include "node.h"
+
+// Include headers from other projects.
+
+/**
+ * Store of nodes allocated in fixed-size chunks.
+ *
+ * Each node is identified by the index of its slot, which it stores and
+ * which never changes. A bit set records which slots hold live nodes, so
+ * checking whether a node belongs to the arena takes constant time. Released
+ * slots are reset and kept on a free list for reuse. They are never returned
+ * to the allocator, so pointers to released nodes remain safe to pass to
+ * contains() for as long as the arena exists.
+ */
+class NodeArena
+{
+ public:
+
+  using Index = Node::Index;
+
+  // The number of nodes in each chunk, which must be a power of 2.
+  static constexpr size_t CHUNK_SIZE = 4096;
+
+  /**
+   * Iterator over the live nodes of an arena in index order.
+   */
+  class const_iterator
+  {
+   public:
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Node*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Node* const*;
+    using reference = Node*;
+
+    const_iterator(const NodeArena* arena, size_t index);
+
+    Node* operator*() const;
+
+    const_iterator& operator++();
+
+    const_iterator operator++(int);
+
+    bool operator==(const const_iterator& other) const;
+
+    bool operator!=(const const_iterator& other) const;
+
+   private:
+
+    void skip_released();
+
+    const NodeArena* arena_;
+    size_t index_;
+  };
+
+  NodeArena();
+
+  // Nodes refer to each other by pointer, so the arena cannot be copied.
+  NodeArena(const NodeArena& orig) = delete;
+
+  NodeArena& operator=(const NodeArena& orig) = delete;
+
+  /**
+   * Create a node, reusing the slot of a released node if there is one.
+   *
+   * @return - a pointer to the new node, which has no edges and is not an
+   *           accept node.
+   */
+  Node* allocate();
+
+  /**
+   * Release a node in the arena, removing its edges (without updating the
+   * nodes at the other ends) and allowing its slot to be reused.
+   *
+   * @param node - the node to release, which must be in the arena.
+   */
+  void release(Node* node);
+
+  /**
+   * Check whether a node is a live node in the arena.
+   *
+   * @param node - the node to check, which may be null, released, or from
+   *               another arena.
+   * @return - true if the node is live in this arena and false otherwise.
+   */
+  bool contains(const Node* node) const;
+
+  /**
+   * @param index - the index of a slot in the arena.
+   * @return - the node in the slot, which may have been released.
+   */
+  Node* at(Index index) const;
+
+  /**
+   * @return - the number of live nodes.
+   */
+  size_t size() const noexcept;
+
+  /**
+   * @return - the number of slots, including those of released nodes.
+   */
+  size_t capacity() const noexcept;
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
+  void swap(NodeArena& other) noexcept;
+
+ private:
+
+  bool is_live(size_t index) const;
+
+  std::vector<std::unique_ptr<Node[]>> chunks_;
+  std::vector<uint64_t> live_;
+  std::vector<Index> free_;
+  size_t num_slots_;
+  size_t size_;
+};
+
+#endif //CAPS_NODE_ARENA_H
@@ -18,7 +18,9 @@ Order reverse_topological_order(const LabeledGraph& graph)
   Order order;
   order.reserve(graph.get_num_nodes());
 
-  std::unordered_set<NodeHandle> ordered;
+  // Nodes are marked by their index in the graph's arena rather than stored
+  // in a hash set.
+  std::vector<bool> ordered(graph.get_nodes().capacity(), false);
   std::stack<std::pair<NodeHandle, bool>> stack;
 
   stack.emplace(graph.get_root(), false);
@@ -26,16 +28,16 @@ Order reverse_topological_order(const LabeledGraph& graph)
   while (!stack.empty()) {
     auto [node, all_children_ordered] = stack.top();
     stack.pop();
-    if (ordered.find(node) != ordered.end()) {
+    if (ordered[node->get_index()]) {
       continue;
     }
     if (all_children_ordered) {
       order.push_back(node);
-      ordered.insert(node);
+      ordered[node->get_index()] = true;
     } else {
       stack.emplace(node, true);
       for (const auto& [label, child]: node->get_out_edges()) {
-        if (ordered.find(child) == ordered.end()) {
+        if (!ordered[child->get_index()]) {
           stack.emplace(child, false);
         }
       }
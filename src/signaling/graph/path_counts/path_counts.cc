@@ -0,0 +1,141 @@
+/**
+ * Counts of the strings accepted from the nodes of a LabeledGraph, used to
+ * number the strings of the graph.
+ */
+
+// Include header file.
+#include "path_counts.h"
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "../ordering.h"
+
+// Include headers from other projects.
+
+PathCounts::PathCounts(const LabeledGraph& graph)
+  : graph_{graph}, counts_(graph.get_nodes().capacity(), 0)
+{
+  // Children come before their parents in reverse topological order, so the
+  // counts of a node's children are known when it is reached.
+  for (const auto* node: reverse_topological_order(graph_)) {
+    auto& count = counts_[node->get_index()];
+    count = node->get_accept() ? 1 : 0;
+    for (const auto& [label, child]: node->get_out_edges()) {
+      count += counts_[child->get_index()];
+    }
+  }
+}
+
+size_t PathCounts::get_root() const
+{
+  return get_node(graph_.get_root());
+}
+
+size_t PathCounts::get_node(const Node* node) const
+{
+  return counts_[node->get_index()];
+}
+
+std::optional<size_t> PathCounts::rank(std::string_view str) const
+{
+  // More than one label out of a node may be a prefix of the rest of the
+  // string after compaction, so keep a stack of partial matches. The strings
+  // that branch off each of them to the left all sort before str.
+  size_t rank = 0;
+  bool found = false;
+  std::vector<std::pair<const Node*, size_t>> stack;
+  stack.emplace_back(graph_.get_root(), 0);
+  while (!stack.empty()) {
+    auto [node, matched] = stack.back();
+    stack.pop_back();
+    auto rest = str.substr(matched);
+    if (rest.empty()) {
+      found = found || node->get_accept();
+      continue;
+    }
+
+    // The prefix matched so far sorts before str if it is accepted.
+    if (node->get_accept()) {
+      ++rank;
+    }
+    for (const auto& [label, child]: node->get_out_edges()) {
+      auto label_str = label.str();
+      if (rest.substr(0, label_str.length()) == label_str) {
+        stack.emplace_back(child, matched + label_str.length());
+      } else if (label_str < rest) {
+        rank += counts_[child->get_index()];
+      } else {
+        // The rest of the labels are even greater.
+        break;
+      }
+    }
+  }
+  return found ? std::make_optional(rank) : std::nullopt;
+}
+
+std::optional<std::string> PathCounts::select(size_t rank) const
+{
+  if (rank >= get_root()) {
+    return std::nullopt;
+  }
+
+  // Skip the strings of whole edges until reaching the edge whose strings
+  // include the one with the rank.
+  std::string str;
+  const auto* node = graph_.get_root();
+  while (!node->get_accept() || rank > 0) {
+    if (node->get_accept()) {
+      --rank;
+    }
+    for (const auto& [label, child]: node->get_out_edges()) {
+      auto count = counts_[child->get_index()];
+      if (rank < count) {
+        str += label.str();
+        node = child;
+        break;
+      }
+      rank -= count;
+    }
+  }
+  return str;
+}
+
+size_t PathCounts::count_prefix(std::string_view prefix) const
+{
+  size_t count = 0;
+  std::vector<std::pair<const Node*, size_t>> stack;
+  stack.emplace_back(graph_.get_root(), 0);
+  while (!stack.empty()) {
+    auto [node, matched] = stack.back();
+    stack.pop_back();
+    auto rest = prefix.substr(matched);
+    if (rest.empty()) {
+      count += counts_[node->get_index()];
+      continue;
+    }
+
+    // Out-edges are sorted by label, so only the labels starting with the
+    // next character of the prefix need to be checked. A prefix that ends
+    // within a label counts every string through the edge.
+    const auto& out_edges = node->get_out_edges();
+    for (auto itr = out_edges.lower_bound(rest.substr(0, 1));
+         itr != out_edges.end() && itr->first.front() == rest.front(); ++itr) {
+      auto label_str = itr->first.str();
+      if (rest.substr(0, label_str.length()) == label_str) {
+        stack.emplace_back(itr->second, matched + label_str.length());
+      } else if (label_str.substr(0, rest.length()) == rest) {
+        count += counts_[itr->second->get_index()];
+      }
+    }
+  }
+  return count;
+}
@@ -0,0 +1,104 @@
+/**
+ * Counts of the strings accepted from the nodes of a LabeledGraph, used to
+ * number the strings of the graph.
+ */
+
+#ifndef CAPS_PATH_COUNTS_H
+#define CAPS_PATH_COUNTS_H
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Include other headers from this project.
+#include "../labeled_graph/graph.h"
+#include "../node/node.h"
+
+// Include headers from other projects.
+
+/**
+ * The number of strings in the right language of every node of an acyclic
+ * graph, i.e., the number of paths from the node to an accepting node.
+ *
+ * The counts are computed in a single pass over the graph in reverse
+ * topological order. They give every accepted string a dense number, its
+ * rank, which is the number of accepted strings that sort before it: rank
+ * adds up the counts of the edges that branch off to the left of a string's
+ * path, and select follows the path of the edges whose counts contain a
+ * rank. This is a minimal perfect hash of the strings onto 0..N-1 that keeps
+ * their order, so values can be attached to the strings in an array.
+ *
+ * Each path is counted as a string of its own, so the out-edges of a node
+ * must spell different strings, and the strings through an edge must sort
+ * between those of the edges around it. Both hold after compaction, even
+ * where several labels out of a node start with the same character. The
+ * counts refer to the nodes of the graph by index, so they are invalidated by
+ * any change to the graph.
+ */
+class PathCounts
+{
+ public:
+
+  /**
+   * Count the strings accepted from the nodes reachable from the root.
+   *
+   * @param graph - the graph, which must outlive the counts.
+   */
+  explicit PathCounts(const LabeledGraph& graph);
+
+  /**
+   * @return - the number of strings accepted by the graph.
+   */
+  size_t get_root() const;
+
+  /**
+   * Get the number of strings in a node's right language.
+   *
+   * @param node - a node reachable from the root of the graph.
+   * @return - the number of strings.
+   */
+  size_t get_node(const Node* node) const;
+
+  /**
+   * Get the position of a string among the accepted strings in
+   * lexicographic order.
+   *
+   * @param str - the string.
+   * @return - the number of accepted strings less than str, or std::nullopt
+   *           if the graph does not accept str.
+   */
+  std::optional<size_t> rank(std::string_view str) const;
+
+  /**
+   * Get an accepted string by its position in lexicographic order, such that
+   * rank(*select(i)) == i.
+   *
+   * @param rank - the position of the string.
+   * @return - the string, or std::nullopt if rank is not less than the
+   *           number of accepted strings.
+   */
+  std::optional<std::string> select(size_t rank) const;
+
+  /**
+   * Count the accepted strings that start with a prefix. Those strings have
+   * consecutive ranks.
+   *
+   * @param prefix - the prefix, which may end within a label.
+   * @return - the number of strings, which is the number of accepted strings
+   *           for the empty prefix.
+   */
+  size_t count_prefix(std::string_view prefix) const;
+
+ private:
+
+  const LabeledGraph& graph_;
+  // The counts of the nodes, indexed by node index.
+  std::vector<size_t> counts_;
+};
+
+#endif //CAPS_PATH_COUNTS_H
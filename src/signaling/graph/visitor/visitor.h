@@ -33,7 +33,7 @@ class Visitor
     // Nothing to do here.
   }
 
-  virtual void visit_edge(const Node*, const Node*, const std::string&)
+  virtual void visit_edge(const Node*, const Node*, const Node::Label&)
   {
     // Nothing to do here.
   }
@@ -44,7 +44,7 @@ class Visitor
   }
 
   virtual bool should_visit_edge(const Node*, const Node*,
-                                 const std::string&) const
+                                 const Node::Label&) const
   {
     return true;
   }
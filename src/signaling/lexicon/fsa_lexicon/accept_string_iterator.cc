@@ -0,0 +1,105 @@
+/**
+ * Lazy enumeration of the strings accepted by a LabeledGraph.
+ */
+
+// Include header file.
+#include "accept_string_iterator.h"
+
+// Include C standard libraries.
+
+// Include C++ standard libraries.
+#include <string>
+
+// Include other headers from this project.
+#include "../../graph/node/node.h"
+
+// Include headers from other projects.
+
+AcceptStringIterator::AcceptStringIterator()
+  : stack_{}, string_{}
+{
+  // Nothing to do here.
+}
+
+AcceptStringIterator::AcceptStringIterator(const Node* root)
+  : stack_{}, string_{}
+{
+  push(root);
+  if (!root->get_accept()) {
+    advance();
+  }
+}
+
+AcceptStringIterator::reference
+AcceptStringIterator::operator*() const noexcept
+{
+  return string_;
+}
+
+AcceptStringIterator::pointer
+AcceptStringIterator::operator->() const noexcept
+{
+  return &string_;
+}
+
+AcceptStringIterator& AcceptStringIterator::operator++()
+{
+  advance();
+  return *this;
+}
+
+bool AcceptStringIterator::operator==(const AcceptStringIterator& other) const
+{
+  // Every iterator past the last string is equal, whatever string it held.
+  if (stack_.empty() || other.stack_.empty()) {
+    return stack_.empty() && other.stack_.empty();
+  }
+  return string_ == other.string_;
+}
+
+bool AcceptStringIterator::operator!=(const AcceptStringIterator& other) const
+{
+  return !operator==(other);
+}
+
+void AcceptStringIterator::advance()
+{
+  while (!stack_.empty()) {
+    auto& frame = stack_.back();
+    if (frame.next == frame.end) {
+      stack_.pop_back();
+      continue;
+    }
+    const auto& [label, child] = *frame.next;
+    ++frame.next;
+    string_.resize(frame.length);
+    string_.append(label.str());
+    push(child);
+    if (child->get_accept()) {
+      return;
+    }
+  }
+  string_.clear();
+}
+
+void AcceptStringIterator::push(const Node* node)
+{
+  const auto& out_edges = node->get_out_edges();
+  stack_.push_back({out_edges.begin(), out_edges.end(), string_.size()});
+}
+
+AcceptStrings::AcceptStrings(const Node* root)
+  : root_{root}
+{
+  // Nothing to do here.
+}
+
+AcceptStringIterator AcceptStrings::begin() const
+{
+  return AcceptStringIterator{root_};
+}
+
+AcceptStringIterator AcceptStrings::end() const
+{
+  return AcceptStringIterator{};
+}
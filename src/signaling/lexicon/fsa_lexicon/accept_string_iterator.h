@@ -0,0 +1,105 @@
+/**
+ * Lazy enumeration of the strings accepted by a LabeledGraph.
+ */
+
+#ifndef CAPS_ACCEPT_STRING_ITERATOR_H
+#define CAPS_ACCEPT_STRING_ITERATOR_H
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../graph/node/node.h"
+
+// Include headers from other projects.
+
+/**
+ * Input iterator over the strings accepted from a node, in lexicographic
+ * order.
+ *
+ * The strings are produced by a depth-first search that visits out-edges in
+ * label order and keeps only its stack and the current string, so memory
+ * grows with the length of the longest string rather than with the number of
+ * strings. The order is lexicographic as long as no label out of a node is a
+ * proper prefix of another, which holds for uncompacted and compacted
+ * lexicons alike. The iterator is invalidated by any change to the graph.
+ */
+class AcceptStringIterator
+{
+ public:
+
+  using iterator_category = std::input_iterator_tag;
+  using value_type = std::string;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const std::string*;
+  using reference = const std::string&;
+
+  /**
+   * Create an iterator past the last string.
+   */
+  AcceptStringIterator();
+
+  /**
+   * Create an iterator at the first string accepted from a node.
+   *
+   * @param root - the node to start the paths from.
+   */
+  explicit AcceptStringIterator(const Node* root);
+
+  reference operator*() const noexcept;
+
+  pointer operator->() const noexcept;
+
+  AcceptStringIterator& operator++();
+
+  bool operator==(const AcceptStringIterator& other) const;
+
+  bool operator!=(const AcceptStringIterator& other) const;
+
+ private:
+
+  // The out-edges of a node on the current path that are left to follow, and
+  // the length of the string up to the node.
+  struct Frame
+  {
+    Node::OutEdgeSet::const_iterator next;
+    Node::OutEdgeSet::const_iterator end;
+    size_t length;
+  };
+
+  /**
+   * Follow edges until reaching the next accept node, or empty the stack if
+   * there is none.
+   */
+  void advance();
+
+  void push(const Node* node);
+
+  std::vector<Frame> stack_;
+  std::string string_;
+};
+
+/**
+ * The strings accepted from a node, for use in range-based for loops.
+ */
+class AcceptStrings
+{
+ public:
+
+  explicit AcceptStrings(const Node* root);
+
+  AcceptStringIterator begin() const;
+
+  AcceptStringIterator end() const;
+
+ private:
+
+  const Node* root_;
+};
+
+#endif //CAPS_ACCEPT_STRING_ITERATOR_H
@@ -8,47 +8,580 @@
 #include "fsa_lexicon.h"
 
 // Include C standard libraries.
+#include <climits>
 #include <cmath>
 
 // Include C++ standard libraries.
 #include <algorithm>
+#include <deque>
+#include <future>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 // Include other headers from this project.
 #include "../../common/contains.h"
+#include "../../common/bounded_queue.h"
 #include "../../common/powerset.h"
+#include "../../common/thread_pool.h"
 #include "../../encoding/bitvector/bitvector.h"
+#include "../../encoding/bitvector_io.h"
+#include "../../encoding/fsa_decoder/fsa_decoder.h"
 #include "../../graph/component/connected_component.h"
 #include "../../graph/component/connected_component_utils.h"
+#include "../../graph/fingerprint/fingerprint.h"
+#include "../../graph/frozen_graph/frozen_graph.h"
+#include "../../graph/ordering.h"
+#include "../../graph/path_counts/path_counts.h"
 #include "../../graph/traversal/graph_search.h"
 #include "../lexicon.h"
-#include "accept_string_visitor.h"
+#include "node_register.h"
+#include "string_partition_visitor.h"
 
 // Include header from other projects.
+#include <boost/functional/hash.hpp>
 
 
+namespace {
+
+size_t common_prefix_length(std::string_view lhs, std::string_view rhs)
+{
+  auto length = std::min(lhs.length(), rhs.length());
+  return static_cast<size_t>(
+    std::mismatch(lhs.begin(), lhs.begin() + length, rhs.begin()).first
+    - lhs.begin());
+}
+
+// Strings with the same first SHARD_LABELS labels are in the same shard.
+constexpr size_t SHARD_LABELS = 2;
+constexpr char LABEL_SEPARATOR = '.';
+
+// A batch of strings is cut at the first shard boundary after it has
+// BATCH_SIZE strings, or at any string after it has MAX_BATCH_SIZE strings.
+constexpr size_t BATCH_SIZE = 1 << 15;
+constexpr size_t MAX_BATCH_SIZE = BATCH_SIZE * 4;
+
+// The number of batches per thread that can be built or waiting to be merged
+// at any time, which bounds the memory used by shards.
+constexpr size_t BATCHES_PER_THREAD = 2;
+
+// dump_parallel splits the strings into about this many partitions per stream.
+constexpr size_t PARTITIONS_PER_STREAM = 8;
+
+// Frozen paths are handed to the minimizing thread in batches of this many,
+// and at most FROZEN_QUEUE_CAPACITY batches can wait to be minimized.
+constexpr size_t FROZEN_BATCH_SIZE = 256;
+constexpr size_t FROZEN_QUEUE_CAPACITY = 16;
+
+/**
+ * Get the length of the shard key of a string, i.e., of its first
+ * SHARD_LABELS labels and the separator that follows them.
+ */
+size_t shard_key_length(std::string_view str)
+{
+  size_t length = 0;
+  for (size_t label = 0; label < SHARD_LABELS; ++label) {
+    auto separator = str.find(LABEL_SEPARATOR, length);
+    if (separator == std::string_view::npos) {
+      return str.length();
+    }
+    length = separator + 1;
+  }
+  return length;
+}
+
+// A position in a graph, viewed as if every edge had a single character: the
+// rest of the label of an edge, which is empty at a node, and its target.
+using LabelPosition = std::pair<const Node*, std::string_view>;
+
+// The positions reached by the same string, which may be several after
+// compaction if more than one label out of a node starts with a character.
+using PositionSet = std::vector<LabelPosition>;
+
+// The positions reached by the same string in both operands of a product.
+using ProductState = std::pair<PositionSet, PositionSet>;
+
+struct ProductStateHash
+{
+  size_t operator()(const ProductState& state) const noexcept
+  {
+    // Equal rests of labels may be stored in different places, so only hash
+    // their lengths.
+    size_t seed = state.first.size();
+    for (const auto* positions: {&state.first, &state.second}) {
+      for (const auto& [target, rest]: *positions) {
+        boost::hash_combine(seed, target);
+        boost::hash_combine(seed, rest.length());
+      }
+    }
+    return seed;
+  }
+};
+
+/**
+ * Get the positions after a character from a set of positions.
+ *
+ * @param positions - the positions.
+ * @param c - the character.
+ * @param next - the set to replace with the positions after c.
+ */
+void step_positions(const PositionSet& positions, char c, PositionSet& next)
+{
+  next.clear();
+  for (const auto& [target, rest]: positions) {
+    if (!rest.empty()) {
+      if (rest.front() == c) {
+        next.emplace_back(target, rest.substr(1));
+      }
+      continue;
+    }
+    // Out-edges are sorted by label, so only the labels starting with c need
+    // to be checked.
+    const auto& out_edges = target->get_out_edges();
+    for (auto itr = out_edges.lower_bound(std::string_view{&c, 1});
+         itr != out_edges.end() && itr->first.front() == c; ++itr) {
+      next.emplace_back(itr->second, itr->first.str().substr(1));
+    }
+  }
+}
+
+bool accepts(const PositionSet& positions)
+{
+  return std::any_of(positions.begin(), positions.end(),
+                     [](const LabelPosition& position) {
+                       return position.second.empty()
+                              && position.first->get_accept();
+                     });
+}
+
+/**
+ * Get the position after the first character of each edge out of a set of
+ * positions.
+ *
+ * @param positions - the positions.
+ * @return - the first character of each edge and the position after it, in
+ *           the order of the characters.
+ */
+std::vector<std::pair<unsigned char, LabelPosition>> get_steps(
+  const PositionSet& positions)
+{
+  std::vector<std::pair<unsigned char, LabelPosition>> steps;
+  for (const auto& [target, rest]: positions) {
+    if (!rest.empty()) {
+      steps.emplace_back(rest.front(), LabelPosition{target, rest.substr(1)});
+      continue;
+    }
+    for (const auto& [label, child]: target->get_out_edges()) {
+      steps.emplace_back(label.front(),
+                         LabelPosition{child, label.str().substr(1)});
+    }
+  }
+  // The out-edges of a single node are already in order.
+  if (positions.size() > 1) {
+    std::sort(steps.begin(), steps.end());
+  }
+  return steps;
+}
+
+/**
+ * Builder of the minimal automaton of a set operation on the languages of two
+ * graphs.
+ *
+ * The states of the product automaton are pairs of position sets, one in
+ * each graph, and a state accepts if the operation is true of whether the
+ * positions in each graph accept. The states are built in postorder with
+ * single-character edges, and each one is replaced by an equivalent
+ * registered node if there is one, as in FSALexicon::copy_shard_node, so the
+ * result is minimal without ever holding the strings.
+ */
+class ProductBuilder
+{
+ public:
+
+  ProductBuilder(LabeledGraph& graph, NodeRegister& node_register,
+                 std::function<bool(bool, bool)> accept)
+    : graph_{graph}, register_{node_register}, accept_{std::move(accept)},
+      nodes_{}
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * Build the product of the languages of two nodes under a node.
+   *
+   * @param node - the node to build the product under, which must not have
+   *               out-edges.
+   * @param lhs - the node in the left-hand graph.
+   * @param rhs - the node in the right-hand graph.
+   */
+  void build(Node* node, const Node* lhs, const Node* rhs)
+  {
+    ProductState state{{{lhs, {}}}, {{rhs, {}}}};
+    std::vector<Frame> stack;
+    stack.push_back(make_frame(std::move(state), node));
+    while (!stack.empty()) {
+      auto& frame = stack.back();
+      if (frame.child_nodes.size() < frame.children.size()) {
+        auto& child = frame.children[frame.child_nodes.size()].second;
+        if (is_empty(child)) {
+          frame.child_nodes.push_back(nullptr);
+        } else if (auto built = nodes_.find(child); built != nodes_.end()) {
+          frame.child_nodes.push_back(built->second);
+        } else {
+          // The child's node is added to the frame once it is built. Adding
+          // its frame moves the others, so take the state out first.
+          auto child_state = std::move(child);
+          stack.push_back(make_frame(std::move(child_state), nullptr));
+        }
+        continue;
+      }
+      auto node = finish(frame);
+      stack.pop_back();
+      if (!stack.empty()) {
+        stack.back().child_nodes.push_back(node);
+      }
+    }
+  }
+
+ private:
+
+  /**
+   * A product state whose node is being built, with the product states
+   * after each character and the nodes built for the first of them.
+   */
+  struct Frame
+  {
+    ProductState state;
+    std::vector<std::pair<char, ProductState>> children;
+    // The node of each child built so far, or nullptr if it accepts nothing.
+    std::vector<Node*> child_nodes;
+    // The node to build the state under, or nullptr to add one.
+    Node* node;
+  };
+
+  Frame make_frame(ProductState state, Node* node) const
+  {
+    // Merge the steps in both graphs, grouping them by character.
+    auto lhs_steps = get_steps(state.first);
+    auto rhs_steps = get_steps(state.second);
+    std::vector<std::pair<char, ProductState>> children;
+    auto lhs_step = lhs_steps.begin();
+    auto rhs_step = rhs_steps.begin();
+    while (lhs_step != lhs_steps.end() || rhs_step != rhs_steps.end()) {
+      auto c = std::min(
+        lhs_step != lhs_steps.end() ? lhs_step->first : UCHAR_MAX,
+        rhs_step != rhs_steps.end() ? rhs_step->first : UCHAR_MAX);
+      ProductState child;
+      for (; lhs_step != lhs_steps.end() && lhs_step->first == c; ++lhs_step) {
+        child.first.push_back(lhs_step->second);
+      }
+      for (; rhs_step != rhs_steps.end() && rhs_step->first == c; ++rhs_step) {
+        child.second.push_back(rhs_step->second);
+      }
+      children.emplace_back(static_cast<char>(c), std::move(child));
+    }
+    return {std::move(state), std::move(children), {}, node};
+  }
+
+  /**
+   * Check whether a product state accepts no strings without expanding it.
+   *
+   * A state whose positions in one graph are empty accepts the strings of
+   * the other graph that the operation keeps, if any.
+   */
+  bool is_empty(const ProductState& state) const
+  {
+    return (state.first.empty() && (state.second.empty()
+                                    || !accept_(false, true)))
+           || (state.second.empty() && !accept_(true, false));
+  }
+
+  /**
+   * Add the node of a product state whose children have all been built, or
+   * use a registered node instead.
+   *
+   * @return - the node, or nullptr if the state accepts nothing.
+   */
+  Node* finish(Frame& frame)
+  {
+    auto node = frame.node != nullptr ? frame.node : graph_.add_node();
+    graph_.set_accept(node, accept_(accepts(frame.state.first),
+                                    accepts(frame.state.second)));
+    for (size_t i = 0; i < frame.children.size(); ++i) {
+      if (frame.child_nodes[i] != nullptr) {
+        graph_.add_edge(node, frame.child_nodes[i],
+                        std::string_view{&frame.children[i].first, 1});
+      }
+    }
+    if (frame.node != nullptr) {
+      return node;
+    }
+
+    if (!node->get_accept() && node->get_out_degree() == 0) {
+      graph_.remove_node(node);
+      node = nullptr;
+    } else if (auto registered_node = register_.find(node);
+               registered_node != nullptr) {
+      // The registered node has the same edges, so removing the node does
+      // not remove any of its children.
+      graph_.remove_node(node);
+      node = registered_node;
+    } else {
+      register_.insert(node);
+    }
+    nodes_.emplace(std::move(frame.state), node);
+    return node;
+  }
+
+  LabeledGraph& graph_;
+  NodeRegister& register_;
+  std::function<bool(bool, bool)> accept_;
+  // The node built for each product state, or nullptr if it accepts nothing.
+  std::unordered_map<ProductState, Node*, ProductStateHash> nodes_;
+};
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 // FSALexicon methods
 ////////////////////////////////////////////////////////////////////////////////
 
 FSALexicon::FSALexicon()
-  : graph_{}, register_{}
+  : graph_{}, register_{}, path_counts_{}, path_counts_mutex_{}
 {
   // Nothing to do here.
 }
 
+FSALexicon::FSALexicon(const FSALexicon& other)
+  : Lexicon{other}, graph_{other.graph_}, register_{}, path_counts_{},
+    path_counts_mutex_{}
+{
+  // The register and path counts refer to the nodes of the other graph, so
+  // they are rebuilt for the copy when they are next needed.
+}
+
+FSALexicon::FSALexicon(FSALexicon&& other) noexcept
+  : FSALexicon{}
+{
+  swap(other);
+}
+
+FSALexicon& FSALexicon::operator=(FSALexicon other) noexcept
+{
+  swap(other);
+  return *this;
+}
+
+void FSALexicon::swap(FSALexicon& other) noexcept
+{
+  // Swapping the graphs keeps their nodes, so the registers stay valid. The
+  // path counts refer to the graph members rather than their nodes, though.
+  std::swap(size_, other.size_);
+  graph_.swap(other.graph_);
+  register_.swap(other.register_);
+  path_counts_.reset();
+  other.path_counts_.reset();
+}
+
 void FSALexicon::add_file(std::istream& instream)
 {
-  Lexicon::add_file(instream);
-  replace_or_register(graph_.get_root());
-  FSALexicon::Register{}.swap(register_);
+  path_counts_.reset();
+
+  // If the lexicon is empty and the strings are sorted, each string can be
+  // added by diverging from the path of the previous string, without checking
+  // whether the string is already in the lexicon. Once a string is out of
+  // order (or if the lexicon already has strings), fall back to add_string.
+  std::string line;
+  if (size_ == 0) {
+    std::vector<Node*> path{graph_.get_root()};
+    std::string previous;
+    bool sorted = true;
+    while (std::getline(instream, line)) {
+      if (size_ > 0 && line <= previous) {
+        if (line == previous) {
+          continue;
+        }
+        sorted = false;
+        break;
+      }
+      add_sorted_string(line, common_prefix_length(previous, line), path);
+      previous.swap(line);
+    }
+    // Register the path of the last sorted string, so that every node but the
+    // root is registered, as add_string expects.
+    if (graph_.get_root()->get_out_degree() > 0) {
+      replace_or_register(graph_.get_root());
+    }
+    if (sorted) {
+      return;
+    }
+    add_string(line);
+  }
+  while (std::getline(instream, line)) {
+    add_string(line);
+  }
+}
+
+void FSALexicon::add_file_parallel(std::istream& instream, size_t num_threads)
+{
+  path_counts_.reset();
+  if (size_ > 0) {
+    add_file(instream);
+    return;
+  }
+
+  // Build the batches on the pool while reading the next ones, and merge the
+  // built shards in order on this thread.
+  ThreadPool pool{num_threads};
+  std::deque<std::future<std::unique_ptr<FSALexicon>>> shards;
+  auto merge_next_shard = [this, &shards]() {
+    auto shard = shards.front().get();
+    shards.pop_front();
+    merge_shard(shard->graph_);
+    size_ += shard->size_;
+  };
+  std::vector<std::string> batch;
+  auto submit_batch = [&pool, &shards, &batch]() {
+    shards.push_back(pool.submit([strings = std::move(batch)]() {
+      auto shard = std::make_unique<FSALexicon>();
+      shard->add_sorted_strings(strings);
+      return shard;
+    }));
+    batch = {};
+  };
+
+  std::string previous, line;
+  bool sorted = true;
+  while (std::getline(instream, line)) {
+    if (!previous.empty() || !batch.empty()) {
+      if (line <= previous) {
+        if (line == previous) {
+          continue;
+        }
+        sorted = false;
+        break;
+      }
+      if (batch.size() >= MAX_BATCH_SIZE
+          || (batch.size() >= BATCH_SIZE
+              && common_prefix_length(previous, line)
+                 < shard_key_length(previous))) {
+        submit_batch();
+        if (shards.size() > BATCHES_PER_THREAD * pool.size()) {
+          merge_next_shard();
+        }
+      }
+    }
+    batch.push_back(line);
+    previous.swap(line);
+  }
+  if (!batch.empty()) {
+    submit_batch();
+  }
+  while (!shards.empty()) {
+    merge_next_shard();
+  }
+  minimize();
+
+  // Add the strings after the first one that is out of order one at a time.
+  if (!sorted) {
+    add_string(line);
+    while (std::getline(instream, line)) {
+      add_string(line);
+    }
+  }
+}
+
+void FSALexicon::add_file_pipelined(std::istream& instream)
+{
+  path_counts_.reset();
+  if (size_ > 0) {
+    add_file(instream);
+    return;
+  }
+
+  // Each frozen path is given by its first node and the edge into it.
+  struct FrozenPath
+  {
+    Node* parent;
+    char label;
+    Node* child;
+  };
+  using FrozenBatch = std::vector<FrozenPath>;
+  std::mutex graph_mutex;
+  BoundedQueue<FrozenBatch> queue{FROZEN_QUEUE_CAPACITY};
+  std::thread minimizer([this, &queue, &graph_mutex]() {
+    while (auto batch = queue.pop()) {
+      for (const auto& [parent, label, child]: *batch) {
+        replace_or_register_frozen(parent, label, child, graph_mutex);
+      }
+    }
+  });
+
+  // The path of the previous string is only read and changed by this thread
+  // until it is frozen, so it is tracked here rather than read from the
+  // graph, whose edges the minimizing thread may be changing.
+  std::vector<Node*> path{graph_.get_root()};
+  FrozenBatch batch;
+  std::string previous, line;
+  bool sorted = true;
+  while (std::getline(instream, line)) {
+    if (size_ > 0 && line <= previous) {
+      if (line == previous) {
+        continue;
+      }
+      sorted = false;
+      break;
+    }
+    auto prefix_length = common_prefix_length(previous, line);
+    if (path.size() > prefix_length + 1) {
+      batch.push_back({path[prefix_length], previous[prefix_length],
+                       path[prefix_length + 1]});
+      if (batch.size() == FROZEN_BATCH_SIZE) {
+        queue.push(std::move(batch));
+        batch = {};
+      }
+    }
+    path.resize(prefix_length + 1);
+    {
+      std::lock_guard<std::mutex> lock{graph_mutex};
+      auto current_node = path.back();
+      for (const auto& c: line.substr(prefix_length)) {
+        current_node = graph_.add_edge(current_node, std::string_view{&c, 1});
+        path.push_back(current_node);
+      }
+      graph_.set_accept(current_node, true);
+    }
+    ++size_;
+    previous.swap(line);
+  }
+  if (!batch.empty()) {
+    queue.push(std::move(batch));
+  }
+  queue.close();
+  minimizer.join();
+
+  // Only the path of the last string is left unregistered, as in add_file.
+  if (graph_.get_root()->get_out_degree() > 0) {
+    replace_or_register(graph_.get_root());
+  }
+  if (!sorted) {
+    add_string(line);
+    while (std::getline(instream, line)) {
+      add_string(line);
+    }
+  }
 }
 
 void FSALexicon::add_string(const std::string& str)
@@ -58,73 +591,484 @@ void FSALexicon::add_string(const std::string& str)
     return;
   }
 
-  auto current_node = graph_.get_root();
-  for (auto c: str) {
-    std::string char_label{c};
-    // If the current node does not have an edge labeled c, replace nodes
-    // starting from the current node and add a new outgoing edge.
-    if (!current_node->has_out_label(char_label)) {
-      if (current_node->get_out_degree() > 0) {
-        replace_or_register(current_node);
+  path_counts_.reset();
+  auto path = unregister_path(str);
+  auto current_node = path.back();
+  for (const auto& c: std::string_view{str}.substr(path.size() - 1)) {
+    current_node = graph_.add_edge(current_node, std::string_view{&c, 1});
+    path.push_back(current_node);
+  }
+  graph_.set_accept(current_node, true);
+  ++size_;
+  register_path(str, path);
+}
+
+void FSALexicon::remove_string(const std::string& str)
+{
+  // If the string is not in the lexicon, do nothing.
+  if (!has_string(str)) {
+    return;
+  }
+
+  path_counts_.reset();
+  auto path = unregister_path(str);
+  graph_.set_accept(path.back(), false);
+  --size_;
+
+  // Prune the nodes at the end of the path that no longer lead to an accept
+  // node. They were cloned if they were shared, so only the path leads to
+  // them and removing them does not need the in-edge index.
+  auto length = path.size() - 1;
+  while (length > 0 && !path[length]->get_accept()
+         && path[length]->get_out_degree() == 0) {
+    graph_.remove_edge(path[length - 1], std::string_view{&str[length - 1], 1});
+    graph_.remove_node(path[length]);
+    --length;
+  }
+  path.resize(length + 1);
+  register_path(str, path);
+}
+
+void FSALexicon::add_sorted_string(std::string_view str, size_t prefix_length,
+                                   std::vector<Node*>& path)
+{
+  // The nodes on the path of the previous string past the common prefix will
+  // not be changed by any later string, so they can be minimized now.
+  path.resize(prefix_length + 1);
+  auto current_node = path.back();
+  if (current_node->get_out_degree() > 0) {
+    replace_or_register(current_node);
+  }
+
+  // The remaining nodes (and the last node, which is either new or the root)
+  // are not in the register, so they can be edited in the graph directly.
+  for (const auto& c: str.substr(prefix_length)) {
+    current_node = graph_.add_edge(current_node, std::string_view{&c, 1});
+    path.push_back(current_node);
+  }
+
+  graph_.set_accept(current_node, true);
+  ++size_;
+}
+
+void FSALexicon::add_sorted_strings(const std::vector<std::string>& strings)
+{
+  std::vector<Node*> path{graph_.get_root()};
+  std::string_view previous;
+  for (const auto& str: strings) {
+    add_sorted_string(str, common_prefix_length(previous, str), path);
+    previous = str;
+  }
+  if (graph_.get_root()->get_out_degree() > 0) {
+    replace_or_register(graph_.get_root());
+  }
+}
+
+void FSALexicon::merge_shard(const LabeledGraph& shard)
+{
+  std::vector<Node*> copies(shard.get_nodes().capacity(), nullptr);
+  auto node = graph_.get_root();
+  const Node* shard_node = shard.get_root();
+  while (shard_node != nullptr) {
+    // The node is about to be changed, so it can no longer be registered.
+    register_.erase(node);
+    if (shard_node->get_accept()) {
+      graph_.set_accept(node, true);
+    }
+
+    // The strings of the shard sort after those of the lexicon, so at most
+    // one of the shard node's labels (its first) is already out of the node.
+    Node* next_node = nullptr;
+    const Node* next_shard_node = nullptr;
+    for (const auto& [label, shard_child]: shard_node->get_out_edges()) {
+      auto child = node->follow_out_edge(label);
+      if (child == nullptr) {
+        graph_.add_edge(node, copy_shard_node(shard_child, copies), label);
+        continue;
       }
-      edit_node(current_node, [this, &char_label](Node* node){
-        graph_.add_edge(node, char_label);
-      });
+      // Clone a child that is shared with other paths, so that changing it
+      // does not add strings to them.
+      if (child->get_in_degree() > 1) {
+        auto clone = clone_node(child);
+        graph_.add_edge(node, clone, label);
+        child = clone;
+      }
+      next_node = child;
+      next_shard_node = shard_child;
     }
+    node = next_node;
+    shard_node = next_shard_node;
+  }
+}
 
-    // Advance the node by following the appropriate edge.
-    current_node = current_node->follow_out_edge(char_label);
+void FSALexicon::replace_or_register_frozen(Node* parent, char label,
+                                            Node* child,
+                                            std::mutex& graph_mutex)
+{
+  // Only this thread changes the nodes of the path, so they can be read
+  // without locking the graph.
+  std::vector<std::pair<Node*, Node*>> edges{{parent, child}};
+  while (child->get_out_degree() > 0) {
+    auto next = child->get_out_edges().crbegin()->second;
+    edges.emplace_back(child, next);
+    child = next;
+  }
+  for (auto edge = edges.rbegin(); edge != edges.rend(); ++edge) {
+    auto [source, node] = *edge;
+    auto registered_node = register_.find(node);
+    if (registered_node == nullptr) {
+      register_.insert(node);
+      continue;
+    }
+    if (registered_node == node) {
+      continue;
+    }
+    // Find the label before redirecting the edge, which removes the node.
+    auto node_label = std::next(edge) == edges.rend()
+                      ? std::string_view{&label, 1}
+                      : source->get_out_edges().crbegin()->first.str();
+    std::lock_guard<std::mutex> lock{graph_mutex};
+    graph_.add_edge(source, registered_node, node_label);
   }
+}
 
-  set_accept(current_node, true);
-  ++size_;
+std::vector<Node*> FSALexicon::unregister_path(std::string_view str)
+{
+  // Every node but the root must be registered. Loading or compacting the
+  // lexicon clears the register, so rebuild it the first time it is needed.
+  if (register_.empty() && graph_.get_root()->get_out_degree() > 0) {
+    minimize();
+  }
+
+  // Follow the longest prefix of the string that is already in the lexicon,
+  // and note the first node on it that more than one edge leads to.
+  std::vector<Node*> path{graph_.get_root()};
+  size_t first_confluence = 0;
+  for (const auto& c: str) {
+    auto child = path.back()->follow_out_edge(std::string_view{&c, 1});
+    if (child == nullptr) {
+      break;
+    }
+    if (first_confluence == 0 && child->get_in_degree() > 1) {
+      first_confluence = path.size();
+    }
+    path.push_back(child);
+  }
+
+  // Every node on the prefix is about to change its right language, so it
+  // must be taken out of the register. From the first confluence node on,
+  // the nodes are shared with strings that do not start with the prefix, so
+  // the path is redirected to clones of them instead.
+  auto num_unshared = first_confluence > 0 ? first_confluence : path.size();
+  for (size_t i = 1; i < num_unshared; ++i) {
+    register_.erase(path[i]);
+  }
+  for (size_t i = num_unshared; i < path.size(); ++i) {
+    auto clone = clone_node(path[i]);
+    graph_.add_edge(path[i - 1], clone, std::string_view{&str[i - 1], 1});
+    path[i] = clone;
+  }
+  return path;
+}
+
+void FSALexicon::register_path(std::string_view str,
+                               const std::vector<Node*>& path)
+{
+  // Go from the bottom up, so that each node's children are registered before
+  // the node is looked up.
+  for (auto i = path.size() - 1; i > 0; --i) {
+    auto registered_node = register_.find(path[i]);
+    if (registered_node == nullptr) {
+      register_.insert(path[i]);
+    } else {
+      graph_.add_edge(path[i - 1], registered_node,
+                      std::string_view{&str[i - 1], 1});
+    }
+  }
+}
+
+Node* FSALexicon::clone_node(const Node* node)
+{
+  auto clone = graph_.add_node();
+  graph_.set_accept(clone, node->get_accept());
+  for (const auto& [label, child]: node->get_out_edges()) {
+    graph_.add_edge(clone, child, label);
+  }
+  return clone;
+}
+
+Node* FSALexicon::copy_shard_node(const Node* node,
+                                  std::vector<Node*>& copies)
+{
+  // Copy the nodes in postorder, so that the children of each node have been
+  // copied (and replaced by registered nodes) before the node itself.
+  std::vector<const Node*> stack{node};
+  while (!stack.empty()) {
+    auto shard_node = stack.back();
+    if (copies[shard_node->get_index()] != nullptr) {
+      stack.pop_back();
+      continue;
+    }
+    bool children_copied = true;
+    for (const auto& [label, child]: shard_node->get_out_edges()) {
+      if (copies[child->get_index()] == nullptr) {
+        stack.push_back(child);
+        children_copied = false;
+      }
+    }
+    if (!children_copied) {
+      continue;
+    }
+    stack.pop_back();
+
+    auto copy = graph_.add_node();
+    graph_.set_accept(copy, shard_node->get_accept());
+    for (const auto& [label, child]: shard_node->get_out_edges()) {
+      graph_.add_edge(copy, copies[child->get_index()], label);
+    }
+    auto registered_node = register_.find(copy);
+    if (registered_node != nullptr) {
+      // The registered node has the same edges, so removing the copy does not
+      // remove any of its children.
+      graph_.remove_node(copy);
+      copy = registered_node;
+    } else {
+      register_.insert(copy);
+    }
+    copies[shard_node->get_index()] = copy;
+  }
+  return copies[node->get_index()];
+}
+
+void FSALexicon::minimize()
+{
+  // Children come before their parents in reverse topological order, so each
+  // node's children have been replaced or registered before the node.
+  std::vector<Node*> replacements(graph_.get_nodes().capacity(), nullptr);
+  for (auto order_node: reverse_topological_order(graph_)) {
+    auto node = const_cast<Node*>(order_node);
+    if (register_.contains(node)) {
+      continue;
+    }
+    std::vector<Node::HalfEdge> replaced_edges;
+    for (const auto& [label, child]: node->get_out_edges()) {
+      if (replacements[child->get_index()] != nullptr) {
+        replaced_edges.emplace_back(label, child);
+      }
+    }
+    // Redirecting the last edge into a replaced child removes the child.
+    for (const auto& [label, child]: replaced_edges) {
+      graph_.add_edge(node, replacements[child->get_index()], label);
+    }
+    if (node == graph_.get_root()) {
+      continue;
+    }
+    auto registered_node = register_.find(node);
+    if (registered_node != nullptr) {
+      replacements[node->get_index()] = registered_node;
+    } else {
+      register_.insert(node);
+    }
+  }
 }
 
 bool FSALexicon::has_string(const std::string& str) const
 {
-  unsigned long current_idx = 0;
-  auto current_node = graph_.get_root();
-  while (current_idx < str.length()) {
-    // Match the longest prefix from the current node.
-    unsigned long substr_len = 1;
-    while (current_node->has_out_label(str.substr(current_idx, substr_len))) {
-      ++substr_len;
-      if (current_idx + substr_len > str.length()) {
-        break;
+  // After compaction, edge labels may span several characters, and more than
+  // one label out of a node may start with the same character, so keep a
+  // stack of partial matches to try.
+  std::vector<std::pair<const Node*, size_t>> stack;
+  stack.emplace_back(graph_.get_root(), 0);
+  while (!stack.empty()) {
+    auto [current_node, current_idx] = stack.back();
+    stack.pop_back();
+    if (current_idx == str.length()) {
+      if (current_node->get_accept()) {
+        return true;
+      }
+      continue;
+    }
+
+    // Out-edges are sorted by label, so only the labels starting with the
+    // next character of the string need to be checked.
+    const auto& out_edges = current_node->get_out_edges();
+    auto first_char = str[current_idx];
+    std::string_view first_label{&str[current_idx], 1};
+    for (auto itr = out_edges.lower_bound(first_label);
+         itr != out_edges.end() && itr->first.front() == first_char; ++itr) {
+      const auto& [label, child] = *itr;
+      if (str.compare(current_idx, label.length(), label) == 0) {
+        stack.emplace_back(child, current_idx + label.length());
       }
     }
-    if (substr_len == 1) {
-      return false;
+  }
+  return false;
+}
+
+std::vector<bool> FSALexicon::has_strings(
+  const std::vector<std::string_view>& strings) const
+{
+  std::vector<size_t> order(strings.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&strings](size_t lhs, size_t rhs) {
+    return strings[lhs] < strings[rhs];
+  });
+
+  // The positions reached by each prefix of the previous string, up to the
+  // longest one that the lexicon has a path for. The sets are cleared rather
+  // than freed, so they are only allocated for the first few strings.
+  std::vector<PositionSet> path{{{graph_.get_root(), {}}}};
+  size_t depth = 0;
+  std::string_view previous;
+  std::vector<bool> found(strings.size(), false);
+  for (auto idx: order) {
+    auto str = strings[idx];
+    depth = std::min(depth, common_prefix_length(previous, str));
+    previous = str;
+    while (depth < str.length()) {
+      if (path.size() == depth + 1) {
+        path.emplace_back();
+      }
+      step_positions(path[depth], str[depth], path[depth + 1]);
+      if (path[depth + 1].empty()) {
+        break;
+      }
+      ++depth;
     }
-    current_node = current_node->follow_out_edge(str.substr(current_idx,
-                                                            substr_len - 1));
-    current_idx += substr_len - 1;
+    found[idx] = depth == str.length() && accepts(path[depth]);
   }
-  return current_node->get_accept();
+  return found;
+}
+
+std::optional<size_t> FSALexicon::rank(std::string_view str) const
+{
+  return get_path_counts()->rank(str);
+}
+
+std::optional<std::string> FSALexicon::select(size_t rank) const
+{
+  return get_path_counts()->select(rank);
+}
+
+size_t FSALexicon::count_prefix(std::string_view prefix) const
+{
+  return get_path_counts()->count_prefix(prefix);
 }
 
 void FSALexicon::load(std::istream& instream)
 {
-  // TODO: edit this
-  std::string line;
-  while (std::getline(instream, line)) {
-    add_string(line);
+  load_encoding(instream);
+}
+
+bool FSALexicon::load_encoding(std::istream& instream)
+{
+  using BVType = BitVector<PackedBits>;
+  BVType buffer;
+  instream >> buffer;
+
+  // The graph is decoded in a single pass, so there is no need to index the
+  // node positions more than once.
+  auto decoder = FSADecoder<BVType>::load(std::move(buffer),
+                                          std::numeric_limits<size_t>::max());
+  if (!decoder.has_value()) {
+    return false;
+  }
+  LabeledGraph graph;
+  decoder->decode_graph(graph);
+  graph_.swap(graph);
+  Register{}.swap(register_);
+  recount_strings();
+  return true;
+}
+
+void FSALexicon::save_checkpoint(std::ostream& outstream) const
+{
+  FrozenGraph{graph_}.write(outstream);
+}
+
+bool FSALexicon::load_checkpoint(std::istream& instream)
+{
+  auto frozen = FrozenGraph::read(instream);
+  if (!frozen.has_value()) {
+    return false;
   }
+  LabeledGraph graph;
+  frozen->thaw(graph);
+  graph_.swap(graph);
+  Register{}.swap(register_);
+  recount_strings();
+  return true;
 }
 
 void FSALexicon::dump(std::ostream& outstream) const
 {
-  for (const auto& str: dump_strings()) {
+  for (const auto& str: get_strings()) {
     outstream << str << "\n";
   }
-//  outstream << "tests" << std::endl;
 }
 
 std::set<std::string> FSALexicon::dump_strings() const
 {
-  auto visitor = std::make_unique<AcceptStringVisitor>();
-  depth_first_search(*visitor, graph_.get_root());
-  return visitor->get_result();
+  // The strings come in order, so each one is inserted at the end.
+  std::set<std::string> strings;
+  for (const auto& str: get_strings()) {
+    strings.emplace_hint(strings.end(), str);
+  }
+  return strings;
+}
+
+void FSALexicon::dump_parallel(const std::vector<std::ostream*>& outstreams,
+                               size_t num_threads) const
+{
+  if (outstreams.empty()) {
+    return;
+  }
+
+  auto counts = get_path_counts();
+  auto num_strings = counts->get_root();
+
+  // Split the strings more finely than into one partition per stream, so
+  // that the partitions can be grouped into ranges of about the same size.
+  auto max_strings = std::max<size_t>(
+    num_strings / (outstreams.size() * PARTITIONS_PER_STREAM), 1);
+  StringPartitionVisitor visitor{*counts, max_strings};
+  depth_first_search(visitor, graph_.get_root());
+  const auto& partitions = visitor.get_result();
+
+  // Each partition goes to the stream whose range holds the number of
+  // strings before it, which keeps the ranges contiguous and in order.
+  std::vector<std::vector<const StringPartition*>> ranges(outstreams.size());
+  size_t num_before = 0;
+  for (const auto& partition: partitions) {
+    ranges[num_before * outstreams.size() / num_strings].push_back(&partition);
+    num_before += partition.prefix_only ? 1 : counts->get_node(partition.node);
+  }
+
+  ThreadPool pool{num_threads};
+  std::vector<std::future<void>> results;
+  for (size_t i = 0; i < outstreams.size(); ++i) {
+    const auto& range = ranges[i];
+    auto& outstream = *outstreams[i];
+    results.push_back(pool.submit([&range, &outstream]() {
+      for (auto partition: range) {
+        if (partition->prefix_only) {
+          outstream << partition->prefix << "\n";
+          continue;
+        }
+        for (const auto& str: AcceptStrings{partition->node}) {
+          outstream << partition->prefix << str << "\n";
+        }
+      }
+    }));
+  }
+  for (auto& result: results) {
+    result.get();
+  }
+}
+
+AcceptStrings FSALexicon::get_strings() const
+{
+  return AcceptStrings{graph_.get_root()};
 }
 
 void FSALexicon::compact(size_t level)
@@ -140,6 +1084,10 @@ void FSALexicon::compact(size_t level)
     return;
   }
 
+  // Connected components are found by following edges in both directions.
+  bool indexed = graph_.has_in_edge_index();
+  graph_.build_in_edge_index();
+
   // Select all nodes that have an in-degree or out-degree of 1 and are not the
   // source or sink node.
   auto select_candidate = [level](const Node* node) {
@@ -151,9 +1099,9 @@ void FSALexicon::compact(size_t level)
 
   // Make connected components out of the selected nodes.
   ConnectedComponent::NodeSet candidates;
-  for (const auto& node: graph_.get_nodes()) {
-    if (select_candidate(node.get())) {
-      candidates.insert(node.get());
+  for (auto node: graph_.get_nodes()) {
+    if (select_candidate(node)) {
+      candidates.insert(node);
     }
   }
   auto candidate_components = make_connected_components(candidates);
@@ -162,14 +1110,13 @@ void FSALexicon::compact(size_t level)
   std::vector<std::pair<ConnectedComponent, TransitivePathsSet>> compaction_set;
 
   // For each component, consider the labels eliminated and introduced.
-  const auto& label_counts = graph_.get_label_counts();
   for (const auto& component: candidate_components) {
     auto compaction_score = 0;
 
     // If a component contains all occurrences of a label in the FSA, it will
     // be eliminated upon compaction.
     for (const auto& [label, count]: component.label_counts()) {
-      if (label_counts.at(label) == count) {
+      if (graph_.get_label_count(label) == count) {
         ++compaction_score;
       }
     }
@@ -177,7 +1124,7 @@ void FSALexicon::compact(size_t level)
     // Subtract the number of new labels introduced by compacting the component.
     auto paths = get_transitive_paths(component);
     for (const auto& [source, dest, label]: paths) {
-      if (label_counts.find(label) == label_counts.end()) {
+      if (graph_.get_label_count(label) == 0) {
         --compaction_score;
       }
     }
@@ -216,17 +1163,30 @@ void FSALexicon::compact(size_t level)
       graph_.remove_node(node);
     }
   }
+
+  if (!indexed) {
+    graph_.drop_in_edge_index();
+  }
+
+  // Count the paths of the compacted graph rather than trusting the count
+  // from before, so that size() always agrees with rank and select.
+  recount_strings();
 }
 
 void FSALexicon::compact_long_edges()
 {
+  // Compaction changes the labels that registered nodes are hashed by.
+  Register{}.swap(register_);
+  bool indexed = graph_.has_in_edge_index();
+  graph_.build_in_edge_index();
+
   ConnectedComponent::NodeSet candidates;
   auto select_candidate = [](const Node* node) {
     return node->get_in_degree() == 1 && node->get_out_degree() == 1;
   };
-  for (const auto& node: graph_.get_nodes()) {
-    if (select_candidate(node.get())) {
-      candidates.insert(node.get());
+  for (auto node: graph_.get_nodes()) {
+    if (select_candidate(node)) {
+      candidates.insert(node);
     }
   }
   for (const auto& component: make_connected_components(candidates)) {
@@ -242,6 +1202,14 @@ void FSALexicon::compact_long_edges()
       }
     }
   }
+
+  if (!indexed) {
+    graph_.drop_in_edge_index();
+  }
+
+  // Count the paths of the compacted graph rather than trusting the count
+  // from before, so that size() always agrees with rank and select.
+  recount_strings();
 }
 
 //int FSALexicon::register_size() const
@@ -287,16 +1255,57 @@ const FSALexicon::Register& FSALexicon::get_register() const
   return register_;
 }
 
-void FSALexicon::set_accept(Node* node, bool accept)
+FSALexicon FSALexicon::set_union(const FSALexicon& lhs,
+                                 const FSALexicon& rhs)
 {
-  if (node->get_accept() == accept) {
-    return;
-  }
-  edit_node(node, [this, accept](Node* node_) {
-    graph_.set_accept(node_, accept);
+  return make_product(lhs, rhs, [](bool in_lhs, bool in_rhs) {
+    return in_lhs || in_rhs;
+  });
+}
+
+FSALexicon FSALexicon::set_intersection(const FSALexicon& lhs,
+                                        const FSALexicon& rhs)
+{
+  return make_product(lhs, rhs, [](bool in_lhs, bool in_rhs) {
+    return in_lhs && in_rhs;
+  });
+}
+
+FSALexicon FSALexicon::set_difference(const FSALexicon& lhs,
+                                      const FSALexicon& rhs)
+{
+  return make_product(lhs, rhs, [](bool in_lhs, bool in_rhs) {
+    return in_lhs && !in_rhs;
   });
 }
 
+FSALexicon FSALexicon::make_product(const FSALexicon& lhs,
+                                    const FSALexicon& rhs,
+                                    std::function<bool(bool, bool)> accept)
+{
+  FSALexicon product;
+  ProductBuilder builder{product.graph_, product.register_, std::move(accept)};
+  builder.build(product.graph_.get_root(), lhs.graph_.get_root(),
+                rhs.graph_.get_root());
+  product.recount_strings();
+  return product;
+}
+
+std::shared_ptr<const PathCounts> FSALexicon::get_path_counts() const
+{
+  std::lock_guard<std::mutex> lock{path_counts_mutex_};
+  if (!path_counts_) {
+    path_counts_ = std::make_shared<const PathCounts>(graph_);
+  }
+  return path_counts_;
+}
+
+void FSALexicon::recount_strings()
+{
+  path_counts_.reset();
+  size_ = static_cast<int>(get_path_counts()->get_root());
+}
+
 void FSALexicon::replace_or_register(Node* node)
 {
   // If the child node with the lexicographically last label itself has child
@@ -311,32 +1320,41 @@ void FSALexicon::replace_or_register(Node* node)
 
   auto registered_node = register_.find(child_node);
   // If an equivalent node is found but it is not the child node, then replace
-  // the child node. Otherwise, add the child node to the register.
-  if (registered_node != register_.end() && child_node != *registered_node) {
-    graph_.remove_node(child_node);
+  // the child node. Otherwise, add the child node to the register. Redirecting
+  // the edge removes the child node once nothing else points to it, so its
+  // parents never need to be looked up.
+  if (registered_node != nullptr && child_node != registered_node) {
     edit_node(node,
               [&, child_label=child_label](Node* source_node) {
-                graph_.add_edge(source_node, *registered_node,
-                  child_label);
+                graph_.add_edge(source_node, registered_node, child_label);
               });
-  } else {
+  } else if (registered_node == nullptr) {
     register_.insert(child_node);
   }
 }
 
 void FSALexicon::edit_node(Node* node, std::function<void(Node*)> function)
 {
-  bool registered = (register_.find(node) != register_.end()
-                     && *(register_.find(node)) == node);
-  if (registered) {
-    register_.erase(node);
-  }
+  // The register stores the hash of the node before it is edited, so it has
+  // to be reinserted afterward.
+  bool registered = register_.erase(node);
   function(node);
   if (registered) {
     register_.insert(node);
   }
 }
 
+bool operator==(const FSALexicon& lhs, const FSALexicon& rhs)
+{
+  return GraphFingerprints{lhs.get_graph()}.same_language(
+    GraphFingerprints{rhs.get_graph()});
+}
+
+bool operator!=(const FSALexicon& lhs, const FSALexicon& rhs)
+{
+  return !operator==(lhs, rhs);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // DebugVisitor methods
 ////////////////////////////////////////////////////////////////////////////////
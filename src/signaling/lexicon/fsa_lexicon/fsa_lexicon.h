@@ -11,17 +11,23 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 // Include other headers from this project.
 #include "../lexicon.h"
 #include "../../graph/node/node.h"
 #include "../../graph/labeled_graph/graph.h"
+#include "../../graph/path_counts/path_counts.h"
 #include "../../graph/visitor/visitor.h"
 #include "../../common/contains.h"
-#include "node_right_language.h"
+#include "accept_string_iterator.h"
+#include "node_register.h"
 
 /**
  * FSA-based implementation of a lexicon.
@@ -31,8 +37,7 @@ class FSALexicon: public Lexicon
  public:
 
   // Type alias declarations
-  using Register = std::unordered_set<Node*, NodeRightLanguageHash,
-                                      NodeRightLanguagePred>;
+  using Register = NodeRegister;
 
   //////////////////////////////////////////////////////////////////////////////
   // Constructors and rule of five
@@ -40,30 +45,277 @@ class FSALexicon: public Lexicon
 
   FSALexicon();
 
+  /**
+   * Copy the strings of another lexicon, but not its register.
+   */
+  FSALexicon(const FSALexicon& other);
+
+  FSALexicon(FSALexicon&& other) noexcept;
+
+  FSALexicon& operator=(FSALexicon other) noexcept;
+
+  ~FSALexicon() override = default;
+
+  void swap(FSALexicon& other) noexcept;
+
   //////////////////////////////////////////////////////////////////////////////
   // Operations
   //////////////////////////////////////////////////////////////////////////////
 
+  /**
+   * Add the strings in a stream, one per line, and minimize the lexicon.
+   *
+   * If the lexicon is empty and the strings are sorted, duplicates are
+   * skipped and each string is added without a membership check. Otherwise,
+   * strings are added one at a time with add_string starting from the first
+   * string that is out of order.
+   *
+   * @param instream - the stream to read the strings from.
+   */
   void add_file(std::istream& instream) override;
 
+  /**
+   * Same as add_file, but build the lexicon from shards on several threads.
+   *
+   * The sorted strings are cut into batches of consecutive strings, where
+   * possible at the boundaries between shards (strings with the same first
+   * SHARD_LABELS dot-separated labels, e.g., the TLD and second-level label
+   * of reversed domain names). Each batch is built into a minimal automaton
+   * of its own on a thread pool, and the automata are merged in order under
+   * the root of the lexicon. Suffix states that are equivalent across shards
+   * are merged through the register as each shard is copied in, and a final
+   * register pass minimizes the paths along which shards were joined.
+   *
+   * If the lexicon is not empty, this is the same as add_file. If a string is
+   * out of order, the strings read so far are merged and the rest are added
+   * one at a time with add_string, as in add_file.
+   *
+   * @param instream - the stream to read the strings from.
+   * @param num_threads - the number of threads that build shards, or 0 to
+   *                      use one per hardware thread.
+   */
+  void add_file_parallel(std::istream& instream, size_t num_threads = 0);
+
+  /**
+   * Same as add_file, but minimize the lexicon on a second thread.
+   *
+   * When a sorted string diverges from the previous one, the previous
+   * string's path past the divergence is frozen: no later string changes it,
+   * and only replace_or_register visits it. This thread reads the strings and
+   * adds their paths, and hands each frozen path through a bounded queue to a
+   * thread that replaces or registers its nodes. The threads only wait for
+   * each other to change the graph itself (e.g., to redirect an edge into a
+   * registered node); register lookups run alongside insertion.
+   *
+   * If the lexicon is not empty, this is the same as add_file. If a string is
+   * out of order, the minimizing thread finishes and the rest of the strings
+   * are added as in add_file.
+   *
+   * @param instream - the stream to read the strings from.
+   */
+  void add_file_pipelined(std::istream& instream);
+
+  /**
+   * Add a string in any order, keeping the lexicon minimal.
+   *
+   * This is Daciuk et al.'s incremental algorithm for unsorted data: every
+   * node but the root stays in the register between calls, the nodes on the
+   * string's path are taken out of it while they are changed, and nodes on
+   * the path that are shared with other strings (confluence nodes) are cloned
+   * first. Only the nodes on the path are replaced or registered again, so
+   * adding a string takes time proportional to its length rather than to the
+   * size of the lexicon.
+   *
+   * The lexicon must not have been compacted.
+   *
+   * @param str - the string to add.
+   */
   void add_string(const std::string& str) override;
 
+  /**
+   * Remove a string, keeping the lexicon minimal.
+   *
+   * The string's path is taken out of the register and unshared as in
+   * add_string, its last node stops accepting, the nodes at the end of the
+   * path that no longer lead to an accept node are removed, and the rest of
+   * the path is replaced or registered again.
+   *
+   * The lexicon must not have been compacted.
+   *
+   * @param str - the string to remove.
+   */
+  void remove_string(const std::string& str) override;
+
   bool has_string(const std::string& str) const override;
 
+  /**
+   * Check whether each of a batch of strings is in the lexicon, sharing the
+   * traversal of common prefixes.
+   *
+   * The strings are looked up in sorted order, keeping the positions reached
+   * by each prefix of the previous string, so each lookup starts from the end
+   * of its longest common prefix with the previous one rather than from the
+   * root. For batches of reversed domain names, most of which share their
+   * TLD and many their second-level label, this skips most of the walk.
+   *
+   * @param strings - the strings to check, in any order.
+   * @return - for each string, whether it is in the lexicon.
+   */
+  std::vector<bool> has_strings(
+    const std::vector<std::string_view>& strings) const override;
+
+  /**
+   * Get the position of a string among the strings of the lexicon in
+   * lexicographic order, which numbers the strings densely from 0 to
+   * size() - 1 (see PathCounts).
+   *
+   * The first query after a change to the lexicon counts the strings
+   * accepted from every node, which takes time linear in the size of the
+   * graph. Later queries take time proportional to the length of the string
+   * times the number of out-edges along its path.
+   *
+   * @param str - the string.
+   * @return - the rank of the string, or std::nullopt if the lexicon does
+   *           not contain it.
+   */
+  std::optional<size_t> rank(std::string_view str) const;
+
+  /**
+   * Get a string of the lexicon by its rank.
+   *
+   * @param rank - the rank of the string.
+   * @return - the string, or std::nullopt if rank is not less than size().
+   */
+  std::optional<std::string> select(size_t rank) const;
+
+  /**
+   * Count the strings of the lexicon that start with a prefix.
+   *
+   * @param prefix - the prefix.
+   * @return - the number of strings, whose ranks are consecutive.
+   */
+  size_t count_prefix(std::string_view prefix) const;
+
+  /**
+   * Replace the contents of the lexicon with an encoded lexicon read from a
+   * stream, as written by any FSAEncoder subclass.
+   *
+   * If the stream does not contain a valid encoding, the lexicon is left
+   * unchanged.
+   *
+   * @param instream - the stream to read the encoding from.
+   */
   void load(std::istream& instream) override;
 
+  /**
+   * Same as load, but report whether the stream contained a valid encoding.
+   *
+   * @param instream - the stream to read the encoding from.
+   * @return - true if the lexicon was loaded and false otherwise.
+   */
+  bool load_encoding(std::istream& instream);
+
+  /**
+   * Write the lexicon's graph to a stream as a binary checkpoint (see
+   * FrozenGraph::write), which is much faster to load than the strings are
+   * to add again.
+   *
+   * @param outstream - the stream to write the checkpoint to.
+   */
+  void save_checkpoint(std::ostream& outstream) const;
+
+  /**
+   * Replace the contents of the lexicon with a checkpoint read from a stream.
+   *
+   * If the stream does not contain a valid checkpoint, the lexicon is left
+   * unchanged.
+   *
+   * @param instream - the stream to read the checkpoint from.
+   * @return - true if the lexicon was loaded and false otherwise.
+   */
+  bool load_checkpoint(std::istream& instream);
+
+  /**
+   * Write the strings one per line in lexicographic order, streaming them
+   * from get_strings rather than collecting them first.
+   *
+   * @param outstream - the stream to write the strings to.
+   */
   void dump(std::ostream& outstream) const override;
 
+  /**
+   * Write the strings to several streams on a thread pool, such that the
+   * streams concatenated in order hold the same as dump would write.
+   *
+   * The strings are split at the root's out-edges, and at deeper prefixes
+   * below nodes that accept more than a fraction of the strings, into
+   * partitions in lexicographic order (see StringPartitionVisitor). The
+   * partitions are grouped into one contiguous range per stream with about
+   * the same number of strings, and each range is written on its own thread.
+   *
+   * @param outstreams - the streams to write the strings to, each of which is
+   *                     only written by one thread.
+   * @param num_threads - the number of threads, or 0 to use one per hardware
+   *                      thread.
+   */
+  void dump_parallel(const std::vector<std::ostream*>& outstreams,
+                     size_t num_threads = 0) const;
+
+  /**
+   * Compact the graph (see compact_long_edges for level 1), and recount the
+   * strings so that size() is exact.
+   *
+   * @param level - the compaction level, or 0 to leave the graph unchanged.
+   */
   void compact(size_t level);
 
   void compact_long_edges();
 
+  /**
+   * Make a lexicon of the strings in either of two lexicons.
+   *
+   * The result is built from the product of the lexicons' automata rather
+   * than their strings, so it takes time proportional to the number of
+   * pairs of states reached by the same prefix in both lexicons. It is
+   * minimal and has single-character labels, even if the lexicons were
+   * compacted.
+   *
+   * @param lhs - the first lexicon.
+   * @param rhs - the second lexicon.
+   * @return - the union of the lexicons.
+   */
+  static FSALexicon set_union(const FSALexicon& lhs, const FSALexicon& rhs);
+
+  /**
+   * Make a lexicon of the strings in both of two lexicons, as in set_union.
+   */
+  static FSALexicon set_intersection(const FSALexicon& lhs,
+                                     const FSALexicon& rhs);
+
+  /**
+   * Make a lexicon of the strings in one lexicon but not in another, as in
+   * set_union.
+   *
+   * @param lhs - the lexicon whose strings are kept.
+   * @param rhs - the lexicon whose strings are removed.
+   * @return - the difference of the lexicons.
+   */
+  static FSALexicon set_difference(const FSALexicon& lhs,
+                                   const FSALexicon& rhs);
+
   //////////////////////////////////////////////////////////////////////////////
   // Accessors
   //////////////////////////////////////////////////////////////////////////////
 
   std::set<std::string> dump_strings() const override;
 
+  /**
+   * Get the strings of the lexicon in lexicographic order, without storing
+   * them (see AcceptStringIterator). The strings are invalidated by any
+   * change to the lexicon.
+   */
+  AcceptStrings get_strings() const;
+
   const LabeledGraph& get_graph() const;
 
   //TODO: for debugging only
@@ -83,7 +335,125 @@ class FSALexicon: public Lexicon
 
  private:
 
-  void set_accept(Node* node, bool accept);
+  /**
+   * Add a string that sorts after every string already in the lexicon.
+   *
+   * @param str - the string to add.
+   * @param prefix_length - the length of the common prefix of the string and
+   *                        the last string added.
+   * @param path - the nodes on the path of the last string added, starting
+   *               from the root, which are replaced by the path of str.
+   */
+  void add_sorted_string(std::string_view str, size_t prefix_length,
+                         std::vector<Node*>& path);
+
+  /**
+   * Add strictly increasing strings to an empty lexicon, and minimize it.
+   *
+   * @param strings - the strings to add.
+   */
+  void add_sorted_strings(const std::vector<std::string>& strings);
+
+  /**
+   * Add the strings of a minimal automaton whose strings all sort after those
+   * of the lexicon.
+   *
+   * Only the nodes along the path of the lexicon's last string can have
+   * labels in common with the shard, and those are unregistered (and cloned
+   * if they are shared) before the shard's edges are added to them. The rest
+   * of the shard is copied with copy_shard_node.
+   *
+   * @param shard - the graph of the automaton.
+   */
+  void merge_shard(const LabeledGraph& shard);
+
+  /**
+   * Replace or register the nodes of a frozen path, from the bottom up.
+   *
+   * The path starts with a child of a node that may still be changed by
+   * another thread, and follows the last child of each node from there. The
+   * earlier children of its nodes must have been replaced or registered
+   * already.
+   *
+   * @param parent - the node whose edge leads to the path.
+   * @param label - the label of the edge.
+   * @param child - the first node of the path.
+   * @param graph_mutex - the mutex that guards changes to the graph.
+   */
+  void replace_or_register_frozen(Node* parent, char label, Node* child,
+                                  std::mutex& graph_mutex);
+
+  /**
+   * Copy a node of a shard and its descendants into the graph, using a
+   * registered node instead of each copy that has an equivalent one.
+   *
+   * @param node - the node of the shard.
+   * @param copies - the copies of the shard's nodes, indexed by node index.
+   * @return - the copy of the node.
+   */
+  Node* copy_shard_node(const Node* node, std::vector<Node*>& copies);
+
+  /**
+   * Prepare the path of a string's longest prefix in the lexicon to be
+   * changed.
+   *
+   * The nodes on the path are taken out of the register, and the nodes from
+   * the first confluence node on are replaced by clones, so that changing the
+   * path does not change the strings that share its nodes.
+   *
+   * @param str - the string.
+   * @return - the nodes on the path, starting from the root.
+   */
+  std::vector<Node*> unregister_path(std::string_view str);
+
+  /**
+   * Replace or register the nodes on a path changed after unregister_path,
+   * from the bottom up.
+   *
+   * @param str - the string that spells the path.
+   * @param path - the nodes on the path, starting from the root.
+   */
+  void register_path(std::string_view str, const std::vector<Node*>& path);
+
+  /**
+   * Add a node with the same accept flag and out-edges as another node.
+   *
+   * @param node - the node to clone.
+   * @return - the clone, which no edge leads to yet.
+   */
+  Node* clone_node(const Node* node);
+
+  /**
+   * Replace or register every unregistered node, from the leaves up.
+   *
+   * A registered node only has registered children, so nodes that are
+   * already registered are left as they are. The root is never registered.
+   */
+  void minimize();
+
+  /**
+   * Make a minimal lexicon from the product of the automata of two lexicons.
+   *
+   * @param lhs - the first lexicon.
+   * @param rhs - the second lexicon.
+   * @param accept - whether a string is in the result, given whether it is
+   *                 in each lexicon. A string in neither lexicon must not be.
+   * @return - the lexicon.
+   */
+  static FSALexicon make_product(const FSALexicon& lhs, const FSALexicon& rhs,
+                                 std::function<bool(bool, bool)> accept);
+
+  /**
+   * Get the path counts of the graph, counting them if the graph changed
+   * since they were last needed.
+   */
+  std::shared_ptr<const PathCounts> get_path_counts() const;
+
+  /**
+   * Count the strings again after a change that does not track the number
+   * of strings it adds or removes.
+   */
+  void recount_strings();
 
   void replace_or_register(Node* node);
 
@@ -91,9 +461,31 @@ class FSALexicon: public Lexicon
 
   LabeledGraph graph_;
   Register register_;
+  // The path counts are shared with the queries using them, so dropping them
+  // on a change does not invalidate a running query. Queries may run on
+  // several threads, but only one of them counts the paths.
+  mutable std::shared_ptr<const PathCounts> path_counts_;
+  mutable std::mutex path_counts_mutex_;
 
 };
 
+/**
+ * Test if two FSA lexicons contain the same strings.
+ *
+ * Unlike the comparison of arbitrary lexicons, this compares the right
+ * language fingerprints of the roots of the lexicons' graphs (see
+ * GraphFingerprints), so it takes time and memory linear in the size of the
+ * graphs rather than the number of strings. Lexicons that differ only in how
+ * they were compacted are equal.
+ *
+ * @param lhs
+ * @param rhs
+ * @return
+ */
+bool operator==(const FSALexicon& lhs, const FSALexicon& rhs);
+
+bool operator!=(const FSALexicon& lhs, const FSALexicon& rhs);
+
 //class DebugVisitor: public CloneableVisitor<DebugVisitor, GraphVisitor>,
 //                    public std::enable_shared_from_this<DebugVisitor>
 //{
@@ -0,0 +1,158 @@
+/**
+ * Register of nodes with distinct right languages, used to minimize an FSA.
+ */
+
+// Include header file.
+#include "node_register.h"
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../graph/node/node.h"
+#include "node_right_language.h"
+
+// Include headers from other projects.
+
+namespace {
+
+// The table starts with this many slots and doubles in size whenever it would
+// become more than half full.
+constexpr size_t INITIAL_SLOTS = 16;
+
+}  // namespace
+
+NodeRegister::NodeRegister()
+  : slots_{}, size_{0}, pred_{}
+{
+  // Nothing to do here.
+}
+
+Node* NodeRegister::find(const Node* node) const
+{
+  if (slots_.empty()) {
+    return nullptr;
+  }
+  auto hash = node->get_out_hash();
+  auto mask = slots_.size() - 1;
+  for (auto i = home_slot(hash); slots_[i].node != nullptr;
+       i = (i + 1) & mask) {
+    if (slots_[i].hash == hash && pred_(slots_[i].node, node)) {
+      return slots_[i].node;
+    }
+  }
+  return nullptr;
+}
+
+bool NodeRegister::insert(Node* node)
+{
+  if (find(node) != nullptr) {
+    return false;
+  }
+  if (2 * (size_ + 1) > slots_.size()) {
+    grow();
+  }
+  auto hash = node->get_out_hash();
+  auto mask = slots_.size() - 1;
+  auto i = home_slot(hash);
+  while (slots_[i].node != nullptr) {
+    i = (i + 1) & mask;
+  }
+  slots_[i] = {hash, node};
+  ++size_;
+  return true;
+}
+
+bool NodeRegister::erase(const Node* node)
+{
+  auto i = find_slot(node);
+  if (i == slots_.size()) {
+    return false;
+  }
+
+  // Shift later entries of the probe sequence back into the hole, so that no
+  // tombstones are needed. An entry can fill the hole if its home slot is not
+  // cyclically between the hole and the entry.
+  auto mask = slots_.size() - 1;
+  auto hole = i;
+  for (auto j = (i + 1) & mask; slots_[j].node != nullptr; j = (j + 1) & mask) {
+    auto home = home_slot(slots_[j].hash);
+    if (((j - home) & mask) >= ((j - hole) & mask)) {
+      slots_[hole] = slots_[j];
+      hole = j;
+    }
+  }
+  slots_[hole] = {0, nullptr};
+  --size_;
+  return true;
+}
+
+bool NodeRegister::contains(const Node* node) const
+{
+  return find_slot(node) != slots_.size();
+}
+
+size_t NodeRegister::size() const noexcept
+{
+  return size_;
+}
+
+bool NodeRegister::empty() const noexcept
+{
+  return size_ == 0;
+}
+
+void NodeRegister::clear()
+{
+  std::vector<Slot>{}.swap(slots_);
+  size_ = 0;
+}
+
+void NodeRegister::swap(NodeRegister& other) noexcept
+{
+  slots_.swap(other.slots_);
+  std::swap(size_, other.size_);
+}
+
+size_t NodeRegister::home_slot(size_t hash) const noexcept
+{
+  return hash & (slots_.size() - 1);
+}
+
+size_t NodeRegister::find_slot(const Node* node) const
+{
+  if (slots_.empty()) {
+    return slots_.size();
+  }
+  auto hash = node->get_out_hash();
+  auto mask = slots_.size() - 1;
+  for (auto i = home_slot(hash); slots_[i].node != nullptr;
+       i = (i + 1) & mask) {
+    if (slots_[i].node == node) {
+      return i;
+    }
+  }
+  return slots_.size();
+}
+
+void NodeRegister::grow()
+{
+  std::vector<Slot> old_slots(slots_.empty() ? INITIAL_SLOTS
+                                             : 2 * slots_.size(),
+                              Slot{0, nullptr});
+  old_slots.swap(slots_);
+  auto mask = slots_.size() - 1;
+  for (const auto& slot: old_slots) {
+    if (slot.node != nullptr) {
+      auto i = home_slot(slot.hash);
+      while (slots_[i].node != nullptr) {
+        i = (i + 1) & mask;
+      }
+      slots_[i] = slot;
+    }
+  }
+}
@@ -0,0 +1,97 @@
+/**
+ * Register of nodes with distinct right languages, used to minimize an FSA.
+ */
+
+#ifndef CAPS_NODE_REGISTER_H
+#define CAPS_NODE_REGISTER_H
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <vector>
+
+// Include other headers from this project.
+#include "../../graph/node/node.h"
+#include "node_right_language.h"
+
+// Include headers from other projects.
+
+/**
+ * Set of nodes, no two of which have the same right language, stored in a
+ * flat open-addressing table with linear probing.
+ *
+ * Each slot stores the hash of its node as computed when the node was
+ * inserted, so probing only compares the edges of nodes whose hashes match.
+ * A node must be erased before it is changed and reinserted afterwards.
+ */
+class NodeRegister
+{
+ public:
+
+  NodeRegister();
+
+  /**
+   * Find a registered node with the same right language as a node.
+   *
+   * @param node - the node to look for.
+   * @return - the registered node (which may be node itself), or nullptr if
+   *           no registered node has the same right language.
+   */
+  Node* find(const Node* node) const;
+
+  /**
+   * Register a node, unless a node with the same right language is already
+   * registered.
+   *
+   * @param node - the node to register.
+   * @return - true if the node was registered and false otherwise.
+   */
+  bool insert(Node* node);
+
+  /**
+   * Remove a node from the register. Another node with the same right
+   * language is not removed.
+   *
+   * @param node - the node to remove.
+   * @return - true if the node was registered and false otherwise.
+   */
+  bool erase(const Node* node);
+
+  /**
+   * Check whether a node itself (rather than an equivalent node) is
+   * registered.
+   *
+   * @param node - the node to look for.
+   * @return - true if the node is registered and false otherwise.
+   */
+  bool contains(const Node* node) const;
+
+  size_t size() const noexcept;
+
+  bool empty() const noexcept;
+
+  void clear();
+
+  void swap(NodeRegister& other) noexcept;
+
+ private:
+
+  struct Slot
+  {
+    size_t hash;
+    Node* node;
+  };
+
+  size_t home_slot(size_t hash) const noexcept;
+
+  size_t find_slot(const Node* node) const;
+
+  void grow();
+
+  std::vector<Slot> slots_;
+  size_t size_;
+  NodeRightLanguagePred pred_;
+};
+
+#endif //CAPS_NODE_REGISTER_H
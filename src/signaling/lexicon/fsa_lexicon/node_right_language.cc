@@ -16,17 +16,12 @@
 #include "../../graph/node/node.h"
 
 // Include headers from other projects.
-#include <boost/functional/hash.hpp>
 
 std::size_t NodeRightLanguageHash::operator()(const Node* node) const
 {
-  size_t seed = 0;
-  boost::hash_combine(seed, node->get_accept());
-  for (const auto& [label, child]: node->get_out_edges()) {
-    boost::hash_combine(seed, label);
-    boost::hash_combine(seed, child);
-  }
-  return seed;
+  // Nodes keep a hash of their accept flag and outgoing edges up to date, so
+  // there is no need to iterate over the edges here.
+  return node->get_out_hash();
 }
 
 bool NodeRightLanguagePred::operator()(const Node* lhs, const Node* rhs) const
@@ -0,0 +1,69 @@
+/**
+ * Visitor that splits the strings accepted by a graph into ranges.
+ */
+
+// Include header file.
+#include "string_partition_visitor.h"
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <string>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../graph/node/node.h"
+
+// Include headers from other projects.
+
+StringPartitionVisitor::StringPartitionVisitor(const PathCounts& counts,
+                                               size_t max_strings)
+  : counts_{counts}, max_strings_{max_strings}, prefixes_{}, prefix_{},
+    split_{false}, partitions_{}
+{
+  // Nothing to do here.
+}
+
+void StringPartitionVisitor::setup()
+{
+  // The search starts by visiting the start node, with an empty prefix.
+  prefixes_.assign(1, "");
+  prefix_.clear();
+  split_ = false;
+  partitions_.clear();
+}
+
+void StringPartitionVisitor::visit_node(const Node* node)
+{
+  prefix_ = std::move(prefixes_.back());
+  prefixes_.pop_back();
+  auto count = counts_.get_node(node);
+  split_ = count > max_strings_ && node->get_out_degree() > 0;
+  if (split_) {
+    // The prefix itself sorts before every string that extends it.
+    if (node->get_accept()) {
+      partitions_.push_back({prefix_, node, true});
+    }
+  } else if (count > 0) {
+    partitions_.push_back({prefix_, node, false});
+  }
+}
+
+void StringPartitionVisitor::visit_edge(const Node*, const Node*,
+                                        const Node::Label& label)
+{
+  prefixes_.push_back(prefix_ + std::string{label.str()});
+}
+
+bool StringPartitionVisitor::should_visit_edge(const Node*, const Node*,
+                                               const Node::Label&) const
+{
+  return split_;
+}
+
+const std::vector<StringPartition>& StringPartitionVisitor::get_result() const
+{
+  return partitions_;
+}
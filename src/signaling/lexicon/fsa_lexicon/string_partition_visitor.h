@@ -0,0 +1,83 @@
+/**
+ * Visitor that splits the strings accepted by a graph into ranges.
+ */
+
+#ifndef CAPS_STRING_PARTITION_VISITOR_H
+#define CAPS_STRING_PARTITION_VISITOR_H
+
+// Include C standard libraries.
+#include <cstddef>
+
+// Include C++ standard libraries.
+#include <string>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../graph/node/node.h"
+#include "../../graph/path_counts/path_counts.h"
+#include "../../graph/visitor/visitor.h"
+
+// Include headers from other projects.
+
+/**
+ * A range of consecutive strings accepted by a graph: either every string
+ * accepted from a node, with a prefix added, or only the prefix itself.
+ */
+struct StringPartition
+{
+  std::string prefix;
+  const Node* node;
+  bool prefix_only;
+};
+
+/**
+ * Visitor for depth_first_search that splits the strings accepted from the
+ * start node at its out-edges, and splits again below each node that accepts
+ * more than a given number of strings.
+ *
+ * The search keeps a stack of nodes still to visit, and the visitor mirrors
+ * it with a stack of the prefixes that lead to them, so a node that is
+ * reached by several prefixes is visited once for each of them. Out-edges are
+ * visited in reverse label order so that the search pops them in label order,
+ * and the partitions are found in lexicographic order of their strings.
+ */
+class StringPartitionVisitor: public ConstReverseEdgeVisitor<OutEdgeTraits>
+{
+ public:
+
+  /**
+   * @param counts - the number of strings accepted from each node.
+   * @param max_strings - the number of strings above which a node's strings
+   *                      are split further.
+   */
+  StringPartitionVisitor(const PathCounts& counts, size_t max_strings);
+
+  void setup() override;
+
+  void visit_node(const Node* node) override;
+
+  void visit_edge(const Node* source, const Node* dest,
+                  const Node::Label& label) override;
+
+  bool should_visit_edge(const Node* source, const Node* dest,
+                         const Node::Label& label) const override;
+
+  /**
+   * @return - the partitions, in lexicographic order of their strings.
+   */
+  const std::vector<StringPartition>& get_result() const;
+
+ private:
+
+  const PathCounts& counts_;
+  size_t max_strings_;
+  // The prefixes of the nodes on the search's stack, and of the node being
+  // visited.
+  std::vector<std::string> prefixes_;
+  std::string prefix_;
+  // Whether the node being visited is split at its out-edges.
+  bool split_;
+  std::vector<StringPartition> partitions_;
+};
+
+#endif //CAPS_STRING_PARTITION_VISITOR_H
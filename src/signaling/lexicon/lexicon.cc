@@ -13,6 +13,8 @@
 #include <iostream>
 #include <set>
 #include <string>
+#include <string_view>
+#include <vector>
 
 // Include other headers from this project.
 
@@ -42,6 +44,25 @@ void Lexicon::add_file(std::istream& instream)
   }
 }
 
+void Lexicon::remove_file(std::istream& instream)
+{
+  std::string line;
+  while (std::getline(instream, line)) {
+    remove_string(line);
+  }
+}
+
+std::vector<bool> Lexicon::has_strings(
+  const std::vector<std::string_view>& strings) const
+{
+  std::vector<bool> found;
+  found.reserve(strings.size());
+  for (const auto& str: strings) {
+    found.push_back(has_string(std::string{str}));
+  }
+  return found;
+}
+
 bool operator==(const Lexicon& lhs, const Lexicon& rhs)
 {
   if (lhs.size() != rhs.size()) {
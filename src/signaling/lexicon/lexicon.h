@@ -11,7 +11,9 @@
 #include <iostream>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_set>
+#include <vector>
 
 // Include other headers from this project.
 
@@ -29,8 +31,31 @@ class Lexicon
 
   virtual void add_string(const std::string& str) = 0;
 
+  /**
+   * Remove the strings in a stream, one per line.
+   *
+   * @param instream - the stream to read the strings from.
+   */
+  virtual void remove_file(std::istream& instream);
+
+  /**
+   * Remove a string, if it is in the lexicon.
+   *
+   * @param str - the string to remove.
+   */
+  virtual void remove_string(const std::string& str) = 0;
+
   virtual bool has_string(const std::string& str) const = 0;
 
+  /**
+   * Check whether each of a batch of strings is in the lexicon.
+   *
+   * @param strings - the strings to check, in any order.
+   * @return - for each string, whether it is in the lexicon.
+   */
+  virtual std::vector<bool> has_strings(
+    const std::vector<std::string_view>& strings) const;
+
   virtual int size() const;
 
   virtual void load(std::istream& instream) = 0;
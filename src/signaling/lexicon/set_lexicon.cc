@@ -26,6 +26,11 @@ void SetLexicon::add_string(const std::string& str)
   set_.insert(str);
 }
 
+void SetLexicon::remove_string(const std::string& str)
+{
+  set_.erase(str);
+}
+
 bool SetLexicon::has_string(const std::string& str) const
 {
   return set_.find(str) != set_.end();
@@ -24,6 +24,8 @@ class SetLexicon: public Lexicon
 
   void add_string(const std::string& str) override;
 
+  void remove_string(const std::string& str) override;
+
   bool has_string(const std::string& str) const override;
 
   int size() const override;
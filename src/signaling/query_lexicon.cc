@@ -0,0 +1,303 @@
+/**
+ * Benchmark membership queries on an FSALexicon or on an encoded lexicon.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lexicon/fsa_lexicon/fsa_lexicon.h"
+#include "common/io_option.h"
+#include "common/measure_time.h"
+#include "common/memory_usage.h"
+#include "encoding/bitvector_io.h"
+#include "encoding/fsa_decoder/fsa_decoder.h"
+#include "graph/frozen_graph/frozen_graph.h"
+
+#include <cxxopts.hpp>
+
+using BVType = BitVector<PackedBits>;
+
+struct option_string
+{
+  option_string(std::string short_option, std::string long_option)
+    : short_option{std::move(short_option)}, long_option{std::move(long_option)}
+  {
+    // Nothing to do here.
+  }
+
+  std::string full_option() const
+  {
+    return short_option + "," + long_option;
+  }
+
+  std::string short_option;
+  std::string long_option;
+};
+
+enum class Option {
+  batch,
+  encoded,
+  frozen,
+  help,
+  infile,
+  path_compaction,
+  queries
+};
+
+struct tool_options
+{
+  tool_options(const cxxopts::ParseResult& result,
+               const std::unordered_map<Option, option_string>& option_map)
+    : batch_size{result[option_map.at(
+        Option::batch).long_option].as<size_t>()},
+      in_file{result[option_map.at(
+        Option::infile).long_option].as<std::string>()},
+      query_file{result[option_map.at(
+        Option::queries).long_option].as<std::string>()},
+      encoded{result.count(option_map.at(Option::encoded).long_option) > 0},
+      frozen{result.count(option_map.at(Option::frozen).long_option) > 0},
+      help{result.count(option_map.at(Option::help).long_option) > 0},
+      path_compact{result.count(option_map.at(
+        Option::path_compaction).long_option) > 0}
+  {
+    // Nothing to do here.
+  }
+
+  size_t batch_size;
+  std::string in_file;
+  std::string query_file;
+  bool encoded;
+  bool frozen;
+  bool help;
+  bool path_compact;
+};
+
+const std::unordered_map<Option, option_string> OPTION_MAP{
+  {Option::batch, {"b", "batch"}},
+  {Option::encoded, {"e", "encoded"}},
+  {Option::frozen, {"f", "frozen"}},
+  {Option::help, {"h", "help"}},
+  {Option::infile, {"i", "infile"}},
+  {Option::path_compaction, {"p", "path-compaction"}},
+  {Option::queries, {"q", "queries"}},
+};
+
+cxxopts::Options make_options(char* program_name)
+{
+  cxxopts::Options options(program_name, "FSA-based lexicon query benchmark");
+  auto get_full_option = [](Option o){
+    return OPTION_MAP.at(o).full_option();
+  };
+  options.add_options()
+           (get_full_option(Option::batch),
+            "Look up the queries in batches of this many strings with "
+            "has_strings (0 to look them up one at a time, ignored with -f)",
+            cxxopts::value<size_t>()->default_value("0"))
+           (get_full_option(Option::infile),
+            "Input file (a list of strings, or an encoded lexicon with -e)",
+            cxxopts::value<std::string>()->default_value(""))
+           (get_full_option(Option::encoded),
+            "Query the encoded lexicon written by build_lexicon")
+           (get_full_option(Option::frozen),
+            "Query a frozen copy of the lexicon (ignored with -e)")
+           (get_full_option(Option::help), "Display this help message")
+           (get_full_option(Option::path_compaction),
+            "Use path compaction (ignored with -e)")
+           (get_full_option(Option::queries), "File of strings to look up",
+            cxxopts::value<std::string>()->default_value(""));
+  return options;
+}
+
+tool_options parse_arguments(int argc, char* argv[])
+{
+  try {
+    auto options = make_options(argv[0]);
+    tool_options parsed{options.parse(argc, argv), OPTION_MAP};
+    if (parsed.help) {
+      std::cout << options.help({""}) << std::endl;
+    }
+    return parsed;
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "Error parsing options: " << e.what() << std::endl;
+    exit(1);
+  }
+}
+
+std::vector<std::string> read_queries(std::istream& in_stream)
+{
+  std::vector<std::string> queries;
+  std::string line;
+  while (std::getline(in_stream, line)) {
+    queries.push_back(line);
+  }
+  return queries;
+}
+
+FSALexicon make_lexicon(std::istream& in_stream)
+{
+  FSALexicon lexicon;
+  lexicon.add_file(in_stream);
+  return lexicon;
+}
+
+BVType read_encoding(std::istream& in_stream)
+{
+  BVType buffer;
+  in_stream >> buffer;
+  return buffer;
+}
+
+/**
+ * Look up each query and report the number of strings found and the average
+ * time per lookup.
+ */
+template <typename LexiconType>
+void run_queries(const LexiconType& lexicon,
+                 const std::vector<std::string>& queries)
+{
+  FunctionTimer<size_t> query_timer([&lexicon, &queries]() {
+    size_t found = 0;
+    for (const auto& query: queries) {
+      if (lexicon.has_string(query)) {
+        ++found;
+      }
+    }
+    return found;
+  });
+  std::cout << "Looking up " << queries.size() << " strings..." << std::flush;
+  auto found = query_timer.run();
+  std::cout << "done! (took " << query_timer.time() << " seconds)"
+            << std::endl;
+  std::cout << found << " of " << queries.size() << " strings found";
+  if (!queries.empty()) {
+    std::cout << ", " << query_timer.time() * 1e9 / queries.size()
+              << " ns per lookup";
+  }
+  std::cout << std::endl;
+}
+
+/**
+ * Same as run_queries, but look up the queries in batches.
+ */
+template <typename LexiconType>
+void run_batched_queries(const LexiconType& lexicon,
+                         const std::vector<std::string>& queries,
+                         size_t batch_size)
+{
+  FunctionTimer<size_t> query_timer([&lexicon, &queries, batch_size]() {
+    size_t found = 0;
+    std::vector<std::string_view> batch;
+    for (size_t first = 0; first < queries.size(); first += batch_size) {
+      auto last = std::min(first + batch_size, queries.size());
+      batch.assign(queries.begin() + first, queries.begin() + last);
+      for (bool has_string: lexicon.has_strings(batch)) {
+        if (has_string) {
+          ++found;
+        }
+      }
+    }
+    return found;
+  });
+  std::cout << "Looking up " << queries.size() << " strings in batches of "
+            << batch_size << "..." << std::flush;
+  auto found = query_timer.run();
+  std::cout << "done! (took " << query_timer.time() << " seconds)"
+            << std::endl;
+  std::cout << found << " of " << queries.size() << " strings found";
+  if (!queries.empty()) {
+    std::cout << ", " << query_timer.time() * 1e9 / queries.size()
+              << " ns per lookup";
+  }
+  std::cout << std::endl;
+}
+
+void print_memory(size_t baseline)
+{
+  auto resident = resident_memory();
+  std::cout << "Resident memory: " << resident << " bytes ("
+            << (resident > baseline ? resident - baseline : 0)
+            << " bytes after reading the queries)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  auto parsed = parse_arguments(argc, argv);
+  if (parsed.help) {
+    return 0;
+  }
+
+  // Read the queries first so that they are included in the baseline.
+  if (parsed.query_file.empty() && parsed.in_file.empty()) {
+    std::cerr << "ERROR: the input and queries cannot both be read from "
+              << "standard input." << std::endl;
+    return 1;
+  }
+  auto queries = input_option(read_queries, parsed.query_file);
+  auto baseline = resident_memory();
+
+  if (parsed.encoded) {
+    FunctionTimer<std::optional<FSADecoder<BVType>>, std::string> in_timer(
+      [](std::string infile) {
+        return FSADecoder<BVType>::load(input_option(read_encoding, infile));
+      });
+    std::cout << "Loading encoded lexicon from "
+              << (parsed.in_file.empty() ? "standard input" : parsed.in_file)
+              << "..." << std::flush;
+    auto decoder = in_timer.run(parsed.in_file);
+    if (!decoder.has_value()) {
+      std::cout << "failed!" << std::endl;
+      std::cerr << "ERROR: invalid encoded lexicon." << std::endl;
+      return 1;
+    }
+    std::cout << "done! (took " << in_timer.time() << " seconds)" << std::endl;
+    std::cout << "Encoded lexicon has " << decoder->get_num_nodes()
+              << " nodes and uses " << decoder->memory_size()
+              << " bytes excluding codebooks" << std::endl;
+    print_memory(baseline);
+    if (parsed.batch_size > 0) {
+      run_batched_queries(*decoder, queries, parsed.batch_size);
+    } else {
+      run_queries(*decoder, queries);
+    }
+  } else {
+    FunctionTimer<FSALexicon, std::string> in_timer([](std::string infile) {
+      return input_option(make_lexicon, infile);
+    });
+    std::cout << "Making lexicon from "
+              << (parsed.in_file.empty() ? "standard input" : parsed.in_file)
+              << "..." << std::flush;
+    auto lexicon = in_timer.run(parsed.in_file);
+    std::cout << "done! (took " << in_timer.time() << " seconds)" << std::endl;
+    if (parsed.path_compact) {
+      lexicon.compact(3);
+    }
+    std::cout << "Lexicon has " << lexicon.get_graph().get_num_nodes()
+              << " nodes and " << lexicon.get_graph().get_num_edges()
+              << " edges" << std::endl;
+    if (parsed.frozen) {
+      FunctionTimer<FrozenGraph> freeze_timer([&lexicon]() {
+        return FrozenGraph{lexicon.get_graph()};
+      });
+      std::cout << "Freezing lexicon..." << std::flush;
+      auto frozen = freeze_timer.run();
+      std::cout << "done! (took " << freeze_timer.time() << " seconds)"
+                << std::endl;
+      print_memory(baseline);
+      run_queries(frozen, queries);
+    } else if (parsed.batch_size > 0) {
+      print_memory(baseline);
+      run_batched_queries(lexicon, queries, parsed.batch_size);
+    } else {
+      print_memory(baseline);
+      run_queries(lexicon, queries);
+    }
+  }
+  return 0;
+}
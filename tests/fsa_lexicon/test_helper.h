@@ -18,4 +18,10 @@ inline std::stringstream set_stream(std::set<std::string> strings)
   return stream;
 }
 
+// Names that share prefixes and suffixes, some of which are prefixes of
+// others, for tests that walk the strings of a lexicon.
+inline const std::set<std::string> SAMPLE_NAMES = {
+  "com.example", "com.example.mail", "com.example.www", "com.sample",
+  "net.example", "org.example", "org.example.www", "org.sample.www"};
+
 #endif //CAPS_TEST_HELPER_H
@@ -0,0 +1,123 @@
+/**
+ * Unit tests for SmallVector and FlatSet.
+ */
+
+// Include C++ standard libraries.
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../../src/signaling/common/flat_set.h"
+#include "../../../src/signaling/common/small_vector.h"
+
+// Include headers from other projects.
+#include "gtest/gtest.h"
+
+TEST(SmallVector, GrowPastInlineCapacity)
+{
+  SmallVector<std::string, 2> vector;
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(2, vector.capacity());
+  for (int i = 0; i < 10; ++i) {
+    vector.insert(vector.end(), std::string(30, static_cast<char>('a' + i)));
+  }
+  EXPECT_EQ(10, vector.size());
+  EXPECT_LE(10, vector.capacity());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(std::string(30, static_cast<char>('a' + i)), vector[i]);
+  }
+}
+
+TEST(SmallVector, InsertEraseMiddle)
+{
+  SmallVector<std::string, 2> vector;
+  vector.insert(vector.end(), "a");
+  vector.insert(vector.end(), "c");
+  vector.insert(vector.begin() + 1, "b");
+  vector.insert(vector.begin(), "0");
+  EXPECT_EQ((std::vector<std::string>{"0", "a", "b", "c"}),
+            std::vector<std::string>(vector.begin(), vector.end()));
+  vector.erase(vector.begin() + 1);
+  vector.erase(vector.end() - 1);
+  EXPECT_EQ((std::vector<std::string>{"0", "b"}),
+            std::vector<std::string>(vector.begin(), vector.end()));
+  EXPECT_EQ((std::vector<std::string>{"b", "0"}),
+            std::vector<std::string>(vector.rbegin(), vector.rend()));
+}
+
+TEST(SmallVector, CopyAndMove)
+{
+  for (size_t count: {1, 5}) {
+    SmallVector<std::string, 2> vector;
+    for (size_t i = 0; i < count; ++i) {
+      vector.insert(vector.end(), std::to_string(i));
+    }
+    SmallVector<std::string, 2> copy{vector};
+    SmallVector<std::string, 2> moved{std::move(copy)};
+    EXPECT_TRUE(copy.empty());
+    ASSERT_EQ(count, moved.size());
+    SmallVector<std::string, 2> assigned;
+    assigned.insert(assigned.end(), "x");
+    assigned = moved;
+    ASSERT_EQ(count, assigned.size());
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(vector[i], moved[i]);
+      EXPECT_EQ(vector[i], assigned[i]);
+    }
+  }
+}
+
+TEST(FlatSet, MatchesMap)
+{
+  // Apply the same random insertions and deletions to a FlatSet keyed on the
+  // first element of a pair and to a std::map.
+  FlatSet<std::pair<std::string, int>, FirstKey, 2> set;
+  std::map<std::string, int> map;
+  std::mt19937 generator{42};
+  for (int i = 0; i < 2000; ++i) {
+    auto key = std::string(1, static_cast<char>('a' + generator() % 20));
+    if (generator() % 3 == 0) {
+      EXPECT_EQ(map.erase(key), set.erase(key));
+    } else {
+      auto inserted = set.emplace(key, i);
+      EXPECT_EQ(map.emplace(key, i).second, inserted.second);
+      EXPECT_EQ(key, inserted.first->first);
+    }
+    ASSERT_EQ(map.size(), set.size());
+    EXPECT_TRUE(std::equal(map.begin(), map.end(), set.begin(),
+                           [](const auto& lhs, const auto& rhs) {
+                             return lhs.first == rhs.first
+                                    && lhs.second == rhs.second;
+                           }));
+  }
+  for (const auto& [key, value]: map) {
+    EXPECT_EQ(value, set.at(key).second);
+    EXPECT_EQ(value, set.find(key)->second);
+  }
+  EXPECT_EQ(set.end(), set.find("z"));
+  EXPECT_THROW(set.at("z"), std::out_of_range);
+}
+
+TEST(FlatSet, IdentityKeyOrder)
+{
+  FlatSet<std::pair<std::string, int>, IdentityKey, 1> set;
+  std::set<std::pair<std::string, int>> expected{{"a", 2}, {"a", 1}, {"b", 0}};
+  for (const auto& value: {std::make_pair(std::string("b"), 0),
+                           std::make_pair(std::string("a"), 2),
+                           std::make_pair(std::string("a"), 1),
+                           std::make_pair(std::string("a"), 2)}) {
+    set.emplace(value);
+  }
+  ASSERT_EQ(expected.size(), set.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), set.begin()));
+  EXPECT_TRUE(std::equal(expected.rbegin(), expected.rend(), set.rbegin()));
+  EXPECT_EQ(set.begin() + 1, set.lower_bound(std::make_pair(std::string("a"), 2)));
+  EXPECT_EQ(1, set.erase(std::make_pair(std::string("a"), 1)));
+  EXPECT_EQ(0, set.erase(std::make_pair(std::string("a"), 1)));
+  EXPECT_EQ(2, set.size());
+}
@@ -27,7 +27,8 @@ class BitVectorComparisonTest: public BitVectorTest<ImplType>
 using testing::Types;
 
 // Test with a vector<bool>-based implementation
-using Implementations = Types<std::vector<bool>, boost::dynamic_bitset<>>;
+using Implementations = Types<std::vector<bool>, boost::dynamic_bitset<>,
+                              PackedBits>;
 
 TYPED_TEST_SUITE(BitVectorTest, Implementations);
 
@@ -67,9 +68,61 @@ TYPED_TEST(BitVectorTest, WriteEmptyBitVectorToNonempty)
   EXPECT_EQ(copy, this->bv_);
 }
 
-// TODO: write nonempty to empty and nonempty to nonempty
+TYPED_TEST(BitVectorTest, PushBackBits)
+{
+  // Write runs of bits of every width so that they straddle word boundaries.
+  BitVector<TypeParam> expected;
+  for (size_t width = 0; width <= 64; ++width) {
+    uint64_t bits = 0x9e3779b97f4a7c15ULL * (width + 1);
+    this->bv_.push_back_bits(bits, width);
+    for (size_t i = width; i > 0; --i) {
+      expected.push_back(((bits >> (i - 1)) & 1) != 0);
+    }
+  }
+  EXPECT_EQ(expected, this->bv_);
+
+  size_t position = 0;
+  for (size_t width = 0; width <= 64; ++width) {
+    uint64_t bits = 0x9e3779b97f4a7c15ULL * (width + 1);
+    uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+    EXPECT_EQ(bits & mask, this->bv_.get_bits(position, width));
+    position += width;
+  }
+}
+
+TYPED_TEST(BitVectorTest, WriteNonemptyToNonempty)
+{
+  for (size_t prefix_size = 0; prefix_size < 70; prefix_size += 7) {
+    BitVector<TypeParam> prefix;
+    BitVector<TypeParam> suffix;
+    BitVector<TypeParam> expected;
+    for (size_t i = 0; i < prefix_size; ++i) {
+      prefix.push_back(i % 3 == 0);
+      expected.push_back(i % 3 == 0);
+    }
+    for (size_t i = 0; i < 130; ++i) {
+      suffix.push_back(i % 5 < 2);
+      expected.push_back(i % 5 < 2);
+    }
+    prefix.push_back(suffix);
+    EXPECT_EQ(expected, prefix);
+  }
+}
 
-// TODO: test pop_back
+TYPED_TEST(BitVectorTest, PopBack)
+{
+  BitVector<TypeParam> expected;
+  for (size_t i = 0; i < 65; ++i) {
+    this->bv_.push_back(true);
+    if (i < 64) {
+      expected.push_back(true);
+    }
+  }
+  this->bv_.pop_back();
+  EXPECT_EQ(expected, this->bv_);
+  this->bv_.push_back(false);
+  EXPECT_FALSE(this->bv_[64]);
+}
 
 // TODO: test flip
 
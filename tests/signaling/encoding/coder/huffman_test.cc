@@ -7,22 +7,30 @@
 // Include C standard libraries.
 
 // Include C++ standard libraries.
-#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 // Include other headers from this project.
 #include "../../../../src/signaling/common/contains.h"
-#include "../../../src/signaling/encoding/huffman/huffman.h"
 #include "../../../../src/signaling/encoding/bitvector/bitvector.h"
+#include "../../../../src/signaling/encoding/coder/char_coder.h"
+#include "../../../../src/signaling/encoding/coder/huffman_coder.h"
 
 // Include header from other projects.
 #include "gtest/gtest.h"
 
+using BVType = BitVector<>;
+
 class HuffmanCoderString: public testing::TestWithParam<std::string>
 {
  public:
-  virtual void SetUp()
+  void SetUp() override
   {
     string_ = GetParam();
     for (auto c: string_) {
@@ -31,35 +39,79 @@ class HuffmanCoderString: public testing::TestWithParam<std::string>
       }
       ++counts_[c];
     }
-    coder_ = new HuffmanCoder<char, BitVector<std::vector<bool>>>(counts_);
+    coder_ = std::make_unique<HuffmanCoder<char, BVType>>(counts_);
   }
 
-  virtual void TearDown()
+ protected:
+
+  /**
+   * Encode the string one character at a time.
+   */
+  BVType encode_string(const HuffmanCoder<char, BVType>& coder) const
   {
-    delete coder_;
+    BVType buffer;
+    for (auto c: string_) {
+      coder.encode(c, &buffer);
+    }
+    return buffer;
+  }
+
+  /**
+   * Decode the whole buffer with a coder, one character at a time.
+   */
+  std::string decode_string(const HuffmanCoder<char, BVType>& coder,
+                            const BVType& buffer) const
+  {
+    std::string decoded;
+    size_t position = 0;
+    while (position < buffer.size()) {
+      auto decode_option = coder.decode(buffer, position);
+      if (!decode_option.has_value()) {
+        break;
+      }
+      decoded.push_back(decode_option->first);
+      position += decode_option->second;
+    }
+    return decoded;
   }
 
- protected:
   std::string string_;
   std::unordered_map<char, int> counts_;
-  HuffmanCoder<char, BitVector<std::vector<bool>>>* coder_;
+  std::unique_ptr<HuffmanCoder<char, BVType>> coder_;
 };
 
 TEST_P(HuffmanCoderString, EncodeDecodeInverse)
 {
-  for (auto itr: counts_) {
-    EXPECT_EQ(std::string(1, itr.first), coder_->decode(coder_->encode(std::string(1, itr.first))));
+  for (const auto& [c, count]: counts_) {
+    std::unique_ptr<BVType> encoding{coder_->encode(c)};
+    ASSERT_NE(nullptr, encoding);
+    auto decoded = coder_->decode(*encoding);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(c, decoded->first);
+    EXPECT_EQ(encoding->size(), decoded->second);
   }
-  EXPECT_EQ(string_, coder_->decode(coder_->encode(string_)));
+  EXPECT_EQ(string_, decode_string(*coder_, encode_string(*coder_)));
+}
+
+TEST_P(HuffmanCoderString, LoadCodebook)
+{
+  auto symbol_coder = std::make_shared<CharCoder<BVType>>();
+  auto codebook = coder_->get_codebook(symbol_coder);
+  auto loaded = HuffmanCoder<char, BVType>::load_codebook(codebook, 0,
+                                                          symbol_coder);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(codebook.size(), loaded->second);
+  EXPECT_EQ(string_, decode_string(loaded->first, encode_string(*coder_)));
 }
 
 const std::string kAbracadabra = "abracadabra";
 const std::string kAbcdef = "aaaaabbbbbbbbbccccccccccccdddddddddddddeeeeeeeeeeeeeeeefffffffffffffffffffffffffffffffffffffffffffff";
 const std::string kHellogoodbye = "hello, hello, i don't know why you say goodbye, i say hello.";
-//const std::string kHellogoodbye = "hello";
+const std::string kSingleSymbol = "zzzz";
 
-INSTANTIATE_TEST_CASE_P(TestHuffmanString, HuffmanCoderString,
-                        testing::Values(kAbracadabra, kAbcdef, kHellogoodbye));
+INSTANTIATE_TEST_SUITE_P(TestHuffmanString, HuffmanCoderString,
+                         testing::Values(kAbracadabra, kAbcdef, kHellogoodbye,
+                                         kSingleSymbol));
 
 TEST(HuffmanCoder, Abracadabra)
 {
@@ -69,24 +121,172 @@ TEST(HuffmanCoder, Abracadabra)
   counts['r'] = 2;
   counts['c'] = 1;
   counts['d'] = 1;
-  using ImplType = std::vector<bool>;
-  HuffmanCoder<char, BitVector<ImplType>> coder(counts);
-  EXPECT_EQ(coder.encode("a"), BitVector<ImplType>(ImplType{0}));
-  EXPECT_EQ(coder.encode("b"), BitVector<ImplType>(ImplType({1, 0, 0})));
-  EXPECT_EQ(coder.encode("c"), BitVector<ImplType>(ImplType({1, 0, 1})));
-  EXPECT_EQ(coder.encode("d"), BitVector<ImplType>(ImplType({1, 1, 0})));
-  EXPECT_EQ(coder.encode("r"), BitVector<ImplType>(ImplType({1, 1, 1})));
-  EXPECT_EQ(coder.decode(BitVector<ImplType>(ImplType{0})), "a");
-  EXPECT_EQ(coder.decode(BitVector<ImplType>(ImplType{1, 0, 0})), "b");
-  EXPECT_EQ(coder.decode(BitVector<ImplType>(ImplType{1, 0, 1})), "c");
-  EXPECT_EQ(coder.decode(BitVector<ImplType>(ImplType{1, 1, 0})), "d");
-  EXPECT_EQ(coder.decode(BitVector<ImplType>(ImplType{1, 1, 1})), "r");
-//  EXPECT_EQ(coder.encode("b"), std::vector<bool>({1, 0, 0}));
-//  EXPECT_EQ(coder.encode("c"), std::vector<bool>({1, 0, 1}));
-//  EXPECT_EQ(coder.encode("d"), std::vector<bool>({1, 1, 0}));
-//  EXPECT_EQ(coder.encode("r"), std::vector<bool>({1, 1, 1}));
-  EXPECT_EQ("abracadabra", coder.decode(coder.encode("abracadabra")));
-  EXPECT_EQ(coder.decode(BitVector<ImplType>(ImplType{0, 1, 0, 0, 1, 1, 1})),
-    "abr");
+  HuffmanCoder<char, BVType> coder(counts);
+
+  // Canonical codewords are assigned by length, then by symbol.
+  std::unique_ptr<BVType> encoding{coder.encode('a')};
+  EXPECT_EQ(1, encoding->size());
+  for (auto c: {'b', 'c', 'd', 'r'}) {
+    encoding.reset(coder.encode(c));
+    EXPECT_EQ(3, encoding->size());
+  }
+  EXPECT_EQ(nullptr, coder.encode('z'));
+}
+
+TEST(HuffmanCoder, LongCodewords)
+{
+  // Fibonacci counts give codewords of every length up to the number of
+  // symbols, so most codewords are too long for the decoding table.
+  std::unordered_map<char, int> counts;
+  int previous = 1, current = 1;
+  for (char c = 'a'; c < 'a' + 20; ++c) {
+    counts[c] = current;
+    auto next = previous + current;
+    previous = current;
+    current = next;
+  }
+  HuffmanCoder<char, BVType> coder(counts);
+  std::unique_ptr<BVType> encoding{coder.encode('a')};
+  EXPECT_EQ(19, encoding->size());
+
+  std::string str;
+  BVType buffer;
+  for (char c = 'a'; c < 'a' + 20; ++c) {
+    str.push_back(c);
+    coder.encode(c, &buffer);
+  }
+  auto symbol_coder = std::make_shared<CharCoder<BVType>>();
+  auto loaded = HuffmanCoder<char, BVType>::load_codebook(
+    coder.get_codebook(symbol_coder), 0, symbol_coder);
+  ASSERT_TRUE(loaded.has_value());
+  for (const auto* decoding_coder: {&coder, &loaded->first}) {
+    std::string decoded;
+    size_t position = 0;
+    while (position < buffer.size()) {
+      auto decode_option = decoding_coder->decode(buffer, position);
+      ASSERT_TRUE(decode_option.has_value());
+      decoded.push_back(decode_option->first);
+      position += decode_option->second;
+    }
+    EXPECT_EQ(str, decoded);
+  }
+}
+
+TEST(HuffmanCoder, InvalidCodewords)
+{
+  // With a single symbol, only the codeword 0 is valid.
+  std::unordered_map<char, int> single{{'z', 4}};
+  HuffmanCoder<char, BVType> single_coder(single);
+  EXPECT_FALSE(single_coder.decode(BVType(std::vector<bool>{1})).has_value());
+  EXPECT_TRUE(single_coder.decode(BVType(std::vector<bool>{0})).has_value());
+
+  // A truncated codeword cannot be decoded.
+  std::unordered_map<char, int> counts{{'a', 5}, {'b', 2}, {'r', 2},
+                                       {'c', 1}, {'d', 1}};
+  HuffmanCoder<char, BVType> coder(counts);
+  std::unique_ptr<BVType> encoding{coder.encode('d')};
+  encoding->pop_back();
+  EXPECT_FALSE(coder.decode(*encoding).has_value());
 }
 
+TEST(HuffmanCoder, LengthLimited)
+{
+  std::unordered_map<char, int> counts;
+  int previous = 1, current = 1;
+  for (char c = 'a'; c < 'a' + 20; ++c) {
+    counts[c] = current;
+    auto next = previous + current;
+    previous = current;
+    current = next;
+  }
+  HuffmanCoder<char, BVType> unlimited(counts);
+  size_t unlimited_cost = 0;
+  for (const auto& [c, count]: counts) {
+    unlimited_cost += count * unlimited.value_size(c);
+  }
+
+  for (size_t limit: {5, 8, 12}) {
+    HuffmanCoder<char, BVType> coder(counts, limit);
+    double kraft_sum = 0;
+    size_t cost = 0;
+    BVType buffer;
+    for (const auto& [c, count]: counts) {
+      auto length = coder.value_size(c);
+      EXPECT_LE(length, limit);
+      kraft_sum += 1.0 / (1 << length);
+      cost += count * length;
+      coder.encode(c, &buffer);
+    }
+    EXPECT_DOUBLE_EQ(1.0, kraft_sum);
+    EXPECT_GT(cost, unlimited_cost);
+
+    size_t position = 0;
+    for (const auto& [c, count]: counts) {
+      auto decoded = coder.decode(buffer, position);
+      ASSERT_TRUE(decoded.has_value());
+      EXPECT_EQ(c, decoded->first);
+      position += decoded->second;
+    }
+  }
+
+  // A limit that is too small for the number of symbols is raised to the
+  // smallest one that fits them all.
+  HuffmanCoder<char, BVType> raised(counts, 2);
+  size_t longest = 0;
+  for (const auto& [c, count]: counts) {
+    longest = std::max(longest, raised.value_size(c));
+  }
+  EXPECT_EQ(5, longest);
+}
+
+TEST(HuffmanCoder, OptimalCodeLengths)
+{
+  // Compare the cost of the code with the cost of a Huffman tree built by
+  // repeatedly merging the two lightest weights.
+  unsigned int state = 1;
+  for (int trial = 0; trial < 50; ++trial) {
+    std::unordered_map<int, int> counts;
+    auto num_symbols = 2 + trial * 3;
+    for (int i = 0; i < num_symbols; ++i) {
+      state = state * 1103515245 + 12345;
+      counts[i] = 1 + (state >> 16) % (trial % 2 == 0 ? 5 : 10000);
+    }
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<>> heap;
+    for (const auto& [symbol, count]: counts) {
+      heap.push(count);
+    }
+    size_t expected_cost = 0;
+    while (heap.size() > 1) {
+      auto first = heap.top();
+      heap.pop();
+      auto second = heap.top();
+      heap.pop();
+      expected_cost += first + second;
+      heap.push(first + second);
+    }
+
+    HuffmanCoder<int, BVType> coder(counts);
+    size_t cost = 0;
+    for (const auto& [symbol, count]: counts) {
+      cost += count * coder.value_size(symbol);
+    }
+    EXPECT_EQ(expected_cost, cost);
+  }
+}
+
+TEST(HuffmanCoder, DeterministicCodebook)
+{
+  // The code depends only on the counts, not on the iteration order of the
+  // map they are given in.
+  std::unordered_map<char, int> unordered_counts;
+  std::map<char, int> ordered_counts;
+  for (char c = 'a'; c <= 'z'; ++c) {
+    unordered_counts[c] = 1 + (c % 4);
+    ordered_counts[c] = 1 + (c % 4);
+  }
+  auto symbol_coder = std::make_shared<CharCoder<BVType>>();
+  HuffmanCoder<char, BVType> unordered_coder(unordered_counts);
+  HuffmanCoder<char, BVType> ordered_coder(ordered_counts);
+  EXPECT_EQ(unordered_coder.get_codebook(symbol_coder),
+            ordered_coder.get_codebook(symbol_coder));
+}
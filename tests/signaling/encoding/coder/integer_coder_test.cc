@@ -0,0 +1,100 @@
+/**
+ * Unit tests for the integer and small-int coders.
+ */
+
+// Include C++ standard libraries.
+#include <memory>
+#include <string>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../../../src/signaling/encoding/bitvector/bitvector.h"
+#include "../../../../src/signaling/encoding/coder/binary_coder.h"
+#include "../../../../src/signaling/encoding/coder/delta_coder.h"
+#include "../../../../src/signaling/encoding/coder/gamma_coder.h"
+#include "../../../../src/signaling/encoding/coder/small_int_coder.h"
+
+// Include header from other projects.
+#include "gtest/gtest.h"
+
+using BVType = BitVector<>;
+
+template <typename CoderType>
+class SelfDelimitingCoderTest: public testing::Test
+{
+ protected:
+  CoderType coder_;
+};
+
+using SelfDelimitingCoders = testing::Types<GammaCoder<size_t, BVType>,
+                                            DeltaCoder<size_t, BVType>>;
+
+TYPED_TEST_SUITE(SelfDelimitingCoderTest, SelfDelimitingCoders);
+
+TYPED_TEST(SelfDelimitingCoderTest, EncodeDecodeInverse)
+{
+  for (size_t value: {0, 1, 2, 3, 7, 8, 100, 1023, 1024, 123456789}) {
+    std::unique_ptr<BVType> encoding{this->coder_.encode(value)};
+    ASSERT_NE(nullptr, encoding);
+    EXPECT_EQ(this->coder_.value_size(value), encoding->size());
+    auto decoded = this->coder_.decode(*encoding);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(value, decoded->first);
+    EXPECT_EQ(encoding->size(), decoded->second);
+  }
+}
+
+TYPED_TEST(SelfDelimitingCoderTest, DecodeConcatenated)
+{
+  std::vector<size_t> values{5, 0, 0, 42, 1, 65535};
+  BVType buffer;
+  for (auto value: values) {
+    this->coder_.encode(value, &buffer);
+  }
+  size_t position = 0;
+  for (auto value: values) {
+    auto decoded = this->coder_.decode(buffer, position);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(value, decoded->first);
+    position += decoded->second;
+  }
+  EXPECT_EQ(buffer.size(), position);
+}
+
+TYPED_TEST(SelfDelimitingCoderTest, DecodeTruncated)
+{
+  std::unique_ptr<BVType> encoding{this->coder_.encode(1000)};
+  encoding->pop_back();
+  EXPECT_FALSE(this->coder_.decode(*encoding).has_value());
+}
+
+TEST(BinaryCoder, FixedWidth)
+{
+  BinaryCoder<int, BVType> coder{4};
+  std::unique_ptr<BVType> encoding{coder.encode(5)};
+  ASSERT_NE(nullptr, encoding);
+  EXPECT_EQ(BVType(std::vector<bool>{0, 1, 0, 1}), *encoding);
+  auto decoded = coder.decode(*encoding);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(5, decoded->first);
+  EXPECT_EQ(4, decoded->second);
+  EXPECT_EQ(nullptr, coder.encode(16));
+}
+
+TEST(SmallIntCoder, EncodeDecodeInverse)
+{
+  SmallIntCoder<std::string, BVType> coder;
+  BVType buffer;
+  for (const std::string str: {"com", "www", "*.example-1", "a_b@c"}) {
+    ASSERT_TRUE(coder.valid_value(str));
+    coder.encode(str, &buffer);
+  }
+  size_t position = 0;
+  for (const std::string str: {"com", "www", "*.example-1", "a_b@c"}) {
+    auto decoded = coder.decode(buffer, position);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(str, decoded->first);
+    position += decoded->second;
+  }
+  EXPECT_FALSE(coder.valid_value("UPPER"));
+}
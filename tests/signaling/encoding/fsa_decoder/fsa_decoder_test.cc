@@ -0,0 +1,239 @@
+/**
+ * Unit tests for querying encoded FSAs with FSADecoder.
+ */
+
+// Include C++ standard libraries.
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../../../src/signaling/encoding/bitvector/bitvector.h"
+#include "../../../../src/signaling/encoding/bitvector_io.h"
+#include "../../../../src/signaling/encoding/fsa_decoder/fsa_decoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_char_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_char_huffman_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_huffman_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_mixed_huffman_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_partial_huffman_encoder.h"
+#include "../../../../src/signaling/lexicon/fsa_lexicon/fsa_lexicon.h"
+
+// Include header from other projects.
+#include "gtest/gtest.h"
+
+using BVType = BitVector<>;
+
+const std::set<std::string> kDomains = {
+  "ca.google.www", "ch.google.mail", "ch.google.www", "com.example",
+  "com.example.mail", "com.example.www", "com.google", "com.google.mail",
+  "com.google.www", "de.google.www", "org.example", "org.example.www",
+  "org.wikipedia.de", "org.wikipedia.en", "org.wikipedia.fr"
+};
+
+const std::set<std::string> kMissing = {
+  "", "c", "ca", "ca.google", "com.example.ww", "com.example.wwww",
+  "com.googl", "net.example", "org.wikipedia", "zzz"
+};
+
+template <typename EncoderType>
+class FSADecoderTest: public testing::Test
+{
+ protected:
+
+  /**
+   * Build, compact and encode a lexicon of the test strings, then load the
+   * encoding into a decoder.
+   */
+  std::optional<FSADecoder<BVType>> make_decoder(size_t compaction_level,
+                                                 size_t index_interval)
+  {
+    std::stringstream stream;
+    for (const auto& str: kDomains) {
+      stream << str << std::endl;
+    }
+    lexicon_ = std::make_unique<FSALexicon>();
+    lexicon_->add_file(stream);
+    lexicon_->compact(compaction_level);
+    EncoderType encoder{*lexicon_};
+    return FSADecoder<BVType>::load(encoder.encode(), index_interval);
+  }
+
+  std::unique_ptr<FSALexicon> lexicon_;
+};
+
+using Encoders = testing::Types<FSAEncoder<BVType>, FSAHuffmanEncoder<BVType>,
+                                FSAMixedHuffmanEncoder<BVType>,
+                                FSAPartialHuffmanEncoder<BVType>,
+                                FSACharHuffmanEncoder<BVType>,
+                                FSACharEncoder<BVType>>;
+
+TYPED_TEST_SUITE(FSADecoderTest, Encoders);
+
+TYPED_TEST(FSADecoderTest, HasString)
+{
+  for (size_t level: {0, 1, 3}) {
+    for (size_t interval: {1, 4, 16}) {
+      auto decoder = this->make_decoder(level, interval);
+      ASSERT_TRUE(decoder.has_value());
+      EXPECT_EQ(this->lexicon_->get_graph().get_num_nodes(),
+                decoder->get_num_nodes());
+      for (const auto& str: kDomains) {
+        EXPECT_TRUE(decoder->has_string(str)) << str;
+        EXPECT_TRUE(this->lexicon_->has_string(str)) << str;
+      }
+      for (const auto& str: kMissing) {
+        EXPECT_FALSE(decoder->has_string(str)) << str;
+        EXPECT_FALSE(this->lexicon_->has_string(str)) << str;
+      }
+    }
+  }
+}
+
+TYPED_TEST(FSADecoderTest, OutEdgesMatchLexicon)
+{
+  auto decoder = this->make_decoder(1, 4);
+  ASSERT_TRUE(decoder.has_value());
+
+  // The root is the first node in the encoding.
+  const auto* root = this->lexicon_->get_graph().get_root();
+  auto edges = decoder->get_out_edges(0);
+  ASSERT_EQ(root->get_out_edges().size(), edges.size());
+  auto itr = edges.begin();
+  for (const auto& [label, child]: root->get_out_edges()) {
+    EXPECT_EQ(label, itr->first);
+    EXPECT_EQ(child->get_accept(), decoder->get_accept(itr->second));
+    ++itr;
+  }
+}
+
+TYPED_TEST(FSADecoderTest, StreamRoundTrip)
+{
+  std::stringstream lexicon_stream;
+  for (const auto& str: kDomains) {
+    lexicon_stream << str << std::endl;
+  }
+  FSALexicon lexicon;
+  lexicon.add_file(lexicon_stream);
+  lexicon.compact(1);
+  TypeParam encoder{lexicon};
+
+  // Writing pads the encoding to a whole number of bytes, which the decoder
+  // must ignore.
+  std::stringstream stream;
+  stream << encoder.encode();
+  BVType buffer;
+  stream >> buffer;
+  EXPECT_EQ(0, buffer.size() % 8);
+  auto decoder = FSADecoder<BVType>::load(buffer);
+  ASSERT_TRUE(decoder.has_value());
+  for (const auto& str: kDomains) {
+    EXPECT_TRUE(decoder->has_string(str)) << str;
+  }
+}
+
+TYPED_TEST(FSADecoderTest, DecodeGraph)
+{
+  for (size_t level: {0, 1, 3}) {
+    auto decoder = this->make_decoder(level, 4);
+    ASSERT_TRUE(decoder.has_value());
+    LabeledGraph graph;
+    decoder->decode_graph(graph);
+    EXPECT_EQ(this->lexicon_->get_graph(), graph);
+    EXPECT_EQ(this->lexicon_->get_graph().get_label_counts(),
+              graph.get_label_counts());
+  }
+}
+
+TYPED_TEST(FSADecoderTest, LoadLexicon)
+{
+  std::stringstream lexicon_stream;
+  for (const auto& str: kDomains) {
+    lexicon_stream << str << std::endl;
+  }
+  FSALexicon lexicon;
+  lexicon.add_file(lexicon_stream);
+  lexicon.compact(1);
+  TypeParam encoder{lexicon};
+  std::stringstream stream;
+  stream << encoder.encode();
+
+  FSALexicon loaded;
+  ASSERT_TRUE(loaded.load_encoding(stream));
+  EXPECT_EQ(lexicon.get_graph(), loaded.get_graph());
+  EXPECT_EQ(static_cast<int>(kDomains.size()), loaded.size());
+  for (const auto& str: kDomains) {
+    EXPECT_TRUE(loaded.has_string(str)) << str;
+  }
+  for (const auto& str: kMissing) {
+    EXPECT_FALSE(loaded.has_string(str)) << str;
+  }
+}
+
+TYPED_TEST(FSADecoderTest, HasStrings)
+{
+  std::vector<std::string_view> queries(kMissing.rbegin(), kMissing.rend());
+  queries.insert(queries.end(), kDomains.rbegin(), kDomains.rend());
+  queries.insert(queries.end(), kDomains.begin(), kDomains.end());
+  for (size_t level: {0, 1, 3}) {
+    auto decoder = this->make_decoder(level, 4);
+    ASSERT_TRUE(decoder.has_value());
+    auto found = decoder->has_strings(queries);
+    ASSERT_EQ(queries.size(), found.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+      EXPECT_EQ(kDomains.count(std::string{queries[i]}) > 0, found[i])
+        << level << ": " << queries[i];
+    }
+  }
+}
+
+TYPED_TEST(FSADecoderTest, RankAndSelect)
+{
+  for (size_t level: {0, 1, 3}) {
+    auto decoder = this->make_decoder(level, 4);
+    ASSERT_TRUE(decoder.has_value());
+    EXPECT_FALSE(decoder->has_path_counts());
+    decoder = FSADecoder<BVType>::load(TypeParam{*this->lexicon_}.encode(), 4,
+                                       true);
+    ASSERT_TRUE(decoder.has_value());
+    ASSERT_TRUE(decoder->has_path_counts());
+    size_t rank = 0;
+    for (const auto& str: kDomains) {
+      EXPECT_EQ(rank, decoder->rank(str)) << str;
+      EXPECT_EQ(str, decoder->select(rank));
+      ++rank;
+    }
+    EXPECT_FALSE(decoder->select(rank).has_value());
+    for (const auto& str: kMissing) {
+      EXPECT_FALSE(decoder->rank(str).has_value()) << str;
+    }
+    for (const auto& prefix: {"", "c", "ch.google.", "com.ex", "org.wiki",
+                              "org.wikipedia.e", "x"}) {
+      EXPECT_EQ(this->lexicon_->count_prefix(prefix),
+                decoder->count_prefix(prefix)) << prefix;
+    }
+  }
+}
+
+TEST(FSADecoder, InvalidEncoding)
+{
+  EXPECT_FALSE(FSADecoder<BVType>::load(BVType{}).has_value());
+
+  std::stringstream stream;
+  for (const auto& str: kDomains) {
+    stream << str << std::endl;
+  }
+  FSALexicon lexicon;
+  lexicon.add_file(stream);
+  auto encoding = FSAHuffmanEncoder<BVType>{lexicon}.encode();
+  encoding.resize(encoding.size() / 2);
+  EXPECT_FALSE(FSADecoder<BVType>::load(encoding).has_value());
+
+  // Loading an invalid encoding leaves the lexicon unchanged.
+  std::stringstream invalid_stream{"not an encoded lexicon"};
+  EXPECT_FALSE(lexicon.load_encoding(invalid_stream));
+  EXPECT_TRUE(lexicon.has_string(*kDomains.begin()));
+}
@@ -0,0 +1,169 @@
+/**
+ * Unit tests for the FSA encoders, checking that encoding does not allocate
+ * per edge.
+ */
+
+// Include C standard libraries.
+#include <cstdlib>
+
+// Include C++ standard libraries.
+#include <atomic>
+#include <memory>
+#include <new>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+// Include other headers from this project.
+#include "../../../../src/signaling/encoding/bitvector/bit_cursor.h"
+#include "../../../../src/signaling/encoding/bitvector/bitvector.h"
+#include "../../../../src/signaling/encoding/coder/delta_coder.h"
+#include "../../../../src/signaling/encoding/coder/huffman_coder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_char_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_char_huffman_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_huffman_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_mixed_huffman_encoder.h"
+#include "../../../../src/signaling/encoding/fsa_encoder/fsa_partial_huffman_encoder.h"
+#include "../../../../src/signaling/lexicon/fsa_lexicon/fsa_lexicon.h"
+
+// Include header from other projects.
+#include "gtest/gtest.h"
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+
+}  // namespace
+
+// Count every allocation in the test binary.
+void* operator new(size_t size)
+{
+  ++allocation_count;
+  if (auto pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+// Keep the replacement out of line so that the compiler does not pair the
+// free with an inlined operator new and warn about mismatched deallocation.
+[[gnu::noinline]] void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+  operator delete(pointer);
+}
+
+using BVType = BitVector<PackedBits>;
+
+template <typename EncoderType>
+class FSAEncoderTest: public testing::Test
+{
+ protected:
+
+  void SetUp() override
+  {
+    // Generate enough pseudorandom strings that per-edge allocations would
+    // dominate, and add them in sorted order.
+    std::set<std::string> strings;
+    unsigned int state = 12345;
+    while (strings.size() < 2000) {
+      std::string str;
+      auto length = 4 + state % 8;
+      for (size_t i = 0; i < length; ++i) {
+        state = state * 1103515245 + 12345;
+        str.push_back(static_cast<char>('a' + (state >> 16) % 26));
+      }
+      strings.insert(str);
+    }
+    std::stringstream stream;
+    for (const auto& str: strings) {
+      stream << str << std::endl;
+    }
+    lexicon_.add_file(stream);
+  }
+
+  FSALexicon lexicon_;
+};
+
+using Encoders = testing::Types<FSAEncoder<BVType>, FSAHuffmanEncoder<BVType>,
+                                FSAMixedHuffmanEncoder<BVType>,
+                                FSAPartialHuffmanEncoder<BVType>,
+                                FSACharHuffmanEncoder<BVType>,
+                                FSACharEncoder<BVType>>;
+
+TYPED_TEST_SUITE(FSAEncoderTest, Encoders);
+
+TYPED_TEST(FSAEncoderTest, EncodeDoesNotAllocatePerEdge)
+{
+  TypeParam encoder{this->lexicon_};
+
+  // The first call orders the nodes, which is allowed to allocate per node.
+  auto first = encoder.encode();
+
+  auto before = allocation_count.load();
+  auto second = encoder.encode();
+  auto allocations = allocation_count.load() - before;
+
+  EXPECT_EQ(first, second);
+  auto num_edges = this->lexicon_.get_graph().get_num_edges();
+  ASSERT_GT(num_edges, 2000);
+  EXPECT_LT(allocations, num_edges / 20)
+    << allocations << " allocations for " << num_edges << " edges";
+}
+
+TEST(CoderWriter, DeltaCoderDoesNotAllocate)
+{
+  DeltaCoder<size_t, BVType> coder;
+  BVType buffer;
+  buffer.reserve(1 << 20);
+  BitVectorWriter<BVType> writer{buffer};
+
+  auto before = allocation_count.load();
+  for (size_t i = 0; i < 10000; ++i) {
+    ASSERT_TRUE(coder.encode(i * 7919, writer));
+  }
+  EXPECT_EQ(before, allocation_count.load());
+
+  size_t position = 0;
+  for (size_t i = 0; i < 10000; ++i) {
+    auto decoded = coder.decode(buffer, position);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(i * 7919, decoded->first);
+    position += decoded->second;
+  }
+}
+
+TEST(CoderWriter, HuffmanCoderDoesNotAllocate)
+{
+  std::unordered_map<int, int> counts{{1, 50}, {2, 20}, {3, 20}, {4, 5},
+                                      {5, 5}};
+  HuffmanCoder<int, BVType> coder{counts};
+  BVType buffer;
+  buffer.reserve(1 << 16);
+  BitVectorWriter<BVType> writer{buffer};
+
+  auto before = allocation_count.load();
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_TRUE(coder.encode(i % 5 + 1, writer));
+  }
+  EXPECT_FALSE(coder.encode(6, writer));
+  EXPECT_EQ(before, allocation_count.load());
+
+  BitVectorReader<BVType> reader{buffer};
+  before = allocation_count.load();
+  size_t position = 0;
+  for (int i = 0; i < 10000; ++i) {
+    auto decoded = coder.decode(reader, position);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(i % 5 + 1, decoded->first);
+    position += decoded->second;
+  }
+  EXPECT_EQ(before, allocation_count.load());
+  EXPECT_EQ(buffer.size(), position);
+}
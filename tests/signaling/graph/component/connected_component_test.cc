@@ -4,11 +4,15 @@
 
 #include <memory>
 #include <set>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 #include "../../../../src/signaling/graph/node/node.h"
 #include "../../../../src/signaling/graph/labeled_graph/graph.h"
 #include "../../../../src/signaling/graph/component/connected_component.h"
+#include "../../../../src/signaling/graph/component/connected_component_utils.h"
 
 #include "gtest/gtest.h"
 
@@ -174,10 +178,13 @@ TEST(ConnectedComponent, OneNodeComponent)
   delete node;
 }
 
-void add_edge(Node* source, Node* destination, const std::string& label)
+LabelPool labels;
+
+void add_edge(Node* source, Node* destination, std::string_view label)
 {
-  source->add_out_edge(label, destination);
-  destination->add_in_edge(label, source);
+  auto interned = labels.intern(label);
+  source->add_out_edge(interned, destination);
+  destination->add_in_edge(interned, source);
 }
 
 TEST(ConnectedComponent, MiddleNodeComponent)
@@ -185,7 +192,7 @@ TEST(ConnectedComponent, MiddleNodeComponent)
   auto parent = new Node;
   auto middle = new Node;
   auto child = new Node;
-  const std::string label{"a"};
+  const auto label = labels.intern("a");
   add_edge(parent, middle, label);
   add_edge(middle, child, label);
   ConnectedComponent::NodeSet nodes;
@@ -241,3 +248,37 @@ TEST(ConnectedComponent, ComplexComponent)
     delete node_list[i];
   }
 }
+
+TEST(ConnectedComponent, TransitivePathsThroughAcceptNode)
+{
+  // The accept node splits the chain of component nodes, so it is downstream
+  // of the component as well as upstream of it. Paths from the parent stop at
+  // the accept node, rather than also continuing past it to the child.
+  auto parent = new Node;
+  auto first = new Node;
+  auto accept = new Node;
+  auto second = new Node;
+  auto child = new Node;
+  accept->set_accept(true);
+  add_edge(parent, first, "a");
+  add_edge(first, accept, "b");
+  add_edge(accept, second, "c");
+  add_edge(first, second, "e");
+  add_edge(second, child, "d");
+  ConnectedComponent::NodeSet nodes;
+  nodes.insert(first);
+  nodes.insert(second);
+  ConnectedComponent component{nodes};
+  EXPECT_EQ(2, component.upstream_size());
+  EXPECT_EQ(2, component.downstream_size());
+
+  auto paths = get_transitive_paths(component);
+  const std::set<TransitivePathVisitor::Path> expected{
+    {parent, accept, "ab"}, {parent, child, "aed"}, {accept, child, "cd"}};
+  EXPECT_EQ(expected.size(), paths.size());
+  EXPECT_EQ(expected,
+            std::set<TransitivePathVisitor::Path>(paths.begin(), paths.end()));
+  for (auto node: {parent, first, accept, second, child}) {
+    delete node;
+  }
+}
@@ -0,0 +1,154 @@
+/**
+ * Unit tests for the right language fingerprints of a LabeledGraph.
+ */
+
+// Include C++ standard libraries.
+#include <set>
+#include <string>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../../../src/signaling/graph/fingerprint/fingerprint.h"
+#include "../../../../src/signaling/graph/labeled_graph/graph.h"
+#include "../../../../src/signaling/lexicon/fsa_lexicon/fsa_lexicon.h"
+#include "../../../fsa_lexicon/test_helper.h"
+
+// Include headers from other projects.
+#include "gtest/gtest.h"
+
+namespace {
+
+void add_strings(FSALexicon& lexicon, const std::set<std::string>& strings)
+{
+  auto stream = set_stream(strings);
+  lexicon.add_file(stream);
+}
+
+}  // namespace
+
+TEST(GraphFingerprints, EmptyGraphs)
+{
+  LabeledGraph empty, dead_end;
+  // The dead end accepts nothing, just like the empty graph.
+  dead_end.add_node(dead_end.add_node(dead_end.get_root(), "a"), "bc");
+  const GraphFingerprints lhs{empty}, rhs{dead_end};
+  EXPECT_TRUE(lhs.same_language(rhs));
+  EXPECT_FALSE(lhs.get_prefix("").has_value());
+  EXPECT_FALSE(rhs.get_prefix("a").has_value());
+}
+
+TEST(GraphFingerprints, AcceptFlag)
+{
+  LabeledGraph empty, accept_empty;
+  accept_empty.set_accept(accept_empty.get_root(), true);
+  EXPECT_FALSE(GraphFingerprints{empty}.same_language(
+    GraphFingerprints{accept_empty}));
+}
+
+class GraphFingerprintsTest: public testing::Test
+{
+ protected:
+
+  const std::set<std::string> strings_ = SAMPLE_NAMES;
+};
+
+TEST_F(GraphFingerprintsTest, IndependentOfInsertionOrder)
+{
+  FSALexicon sorted, unsorted;
+  add_strings(sorted, strings_);
+  for (auto str = strings_.rbegin(); str != strings_.rend(); ++str) {
+    unsorted.add_string(*str);
+  }
+  EXPECT_TRUE(GraphFingerprints{sorted.get_graph()}.same_language(
+    GraphFingerprints{unsorted.get_graph()}));
+  EXPECT_EQ(sorted, unsorted);
+}
+
+TEST_F(GraphFingerprintsTest, IndependentOfCompaction)
+{
+  FSALexicon lexicon, compacted;
+  add_strings(lexicon, strings_);
+  add_strings(compacted, strings_);
+  compacted.compact(3);
+  ASSERT_LT(compacted.get_graph().get_num_edges(),
+            lexicon.get_graph().get_num_edges());
+
+  const GraphFingerprints lhs{lexicon.get_graph()};
+  const GraphFingerprints rhs{compacted.get_graph()};
+  EXPECT_EQ(lhs.get_root(), rhs.get_root());
+  // Prefixes that end within a label of the compacted graph.
+  for (const auto& prefix: {"c", "co", "com.ex", "org.example.w", "org.s"}) {
+    ASSERT_TRUE(lhs.get_prefix(prefix).has_value()) << prefix;
+    EXPECT_EQ(lhs.get_prefix(prefix), rhs.get_prefix(prefix)) << prefix;
+  }
+  EXPECT_TRUE(lhs.changed_subtrees(rhs).empty());
+}
+
+TEST_F(GraphFingerprintsTest, SameSubtree)
+{
+  FSALexicon lhs, rhs;
+  add_strings(lhs, strings_);
+  auto changed = strings_;
+  changed.erase("com.example");
+  changed.insert("com.examples");
+  add_strings(rhs, changed);
+  const GraphFingerprints lhs_fingerprints{lhs.get_graph()};
+  const GraphFingerprints rhs_fingerprints{rhs.get_graph()};
+  EXPECT_FALSE(lhs_fingerprints.same_language(rhs_fingerprints));
+  EXPECT_NE(lhs, rhs);
+  EXPECT_FALSE(lhs_fingerprints.same_subtree(rhs_fingerprints, "com."));
+  EXPECT_TRUE(lhs_fingerprints.same_subtree(rhs_fingerprints, "com.s"));
+  EXPECT_TRUE(lhs_fingerprints.same_subtree(rhs_fingerprints, "net."));
+  EXPECT_TRUE(lhs_fingerprints.same_subtree(rhs_fingerprints, "org."));
+  EXPECT_TRUE(lhs_fingerprints.same_subtree(rhs_fingerprints, "xyz"));
+}
+
+TEST(GraphFingerprints, ChangedSubtrees)
+{
+  FSALexicon old_lexicon, new_lexicon;
+  add_strings(old_lexicon, {"ab", "ac", "b", "d"});
+  add_strings(new_lexicon, {"a", "ab", "ad", "b", "bx", "c"});
+  const GraphFingerprints old_fingerprints{old_lexicon.get_graph()};
+  const GraphFingerprints new_fingerprints{new_lexicon.get_graph()};
+
+  using Kind = SubtreeChange::Kind;
+  const std::vector<SubtreeChange> expected{
+    {"a", Kind::accept_changed}, {"ac", Kind::removed}, {"ad", Kind::added},
+    {"bx", Kind::added}, {"c", Kind::added}, {"d", Kind::removed}};
+  EXPECT_EQ(expected, old_fingerprints.changed_subtrees(new_fingerprints));
+  EXPECT_EQ(std::vector<SubtreeChange>(expected.begin(), expected.begin() + 2),
+            old_fingerprints.changed_subtrees(new_fingerprints, 2));
+}
+
+TEST(GraphFingerprints, ChangedSubtreesSharedSuffix)
+{
+  // Both prefixes lead to the same node in each graph, so the change below it
+  // has to be reported under both.
+  FSALexicon old_lexicon, new_lexicon;
+  add_strings(old_lexicon, {"example.com", "sample.com"});
+  add_strings(new_lexicon, {"example.com", "example.com.www", "sample.com",
+                            "sample.com.www"});
+  const GraphFingerprints old_fingerprints{old_lexicon.get_graph()};
+  const GraphFingerprints new_fingerprints{new_lexicon.get_graph()};
+
+  using Kind = SubtreeChange::Kind;
+  const std::vector<SubtreeChange> expected{
+    {"example.com.", Kind::added}, {"sample.com.", Kind::added}};
+  EXPECT_EQ(expected, old_fingerprints.changed_subtrees(new_fingerprints));
+  EXPECT_EQ(std::vector<SubtreeChange>(expected.begin(), expected.begin() + 1),
+            old_fingerprints.changed_subtrees(new_fingerprints, 1));
+}
+
+TEST(GraphFingerprints, ChangedSubtreesWithinLabel)
+{
+  FSALexicon old_lexicon, new_lexicon;
+  add_strings(old_lexicon, {"example.com"});
+  add_strings(new_lexicon, {"example.com", "example.net"});
+  old_lexicon.compact(3);
+  new_lexicon.compact(3);
+  using Kind = SubtreeChange::Kind;
+  const std::vector<SubtreeChange> expected{{"example.n", Kind::added}};
+  EXPECT_EQ(expected,
+            GraphFingerprints{old_lexicon.get_graph()}.changed_subtrees(
+              GraphFingerprints{new_lexicon.get_graph()}));
+}
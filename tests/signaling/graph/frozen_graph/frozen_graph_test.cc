@@ -0,0 +1,229 @@
+/**
+ * Unit tests for the read-only CSR copy of a LabeledGraph.
+ */
+
+// Include C standard libraries.
+#include <cstdint>
+#include <cstring>
+
+// Include C++ standard libraries.
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../../../src/signaling/graph/frozen_graph/frozen_graph.h"
+#include "../../../../src/signaling/graph/labeled_graph/graph.h"
+#include "../../../../src/signaling/lexicon/fsa_lexicon/fsa_lexicon.h"
+
+// Include headers from other projects.
+#include "gtest/gtest.h"
+
+TEST(FrozenGraph, Empty)
+{
+  const FrozenGraph graph;
+  EXPECT_EQ(1, graph.get_num_nodes());
+  EXPECT_EQ(0, graph.get_num_edges());
+  EXPECT_EQ(0, graph.get_num_accept());
+  EXPECT_EQ(0, graph.get_root());
+  EXPECT_TRUE(graph.get_out_edges(graph.get_root()).empty());
+  EXPECT_FALSE(graph.has_string(""));
+  EXPECT_EQ(0, graph.count_strings());
+}
+
+TEST(FrozenGraph, FreezeEmptyGraph)
+{
+  const LabeledGraph graph;
+  const FrozenGraph frozen{graph};
+  EXPECT_EQ(1, frozen.get_num_nodes());
+  EXPECT_EQ(0, frozen.get_num_edges());
+  EXPECT_EQ(0, frozen.get_labels().size());
+}
+
+/**
+ * Provide a graph whose labels span several characters, and where more than
+ * one label out of a node starts with the same character:
+ *
+ *   root -"ab"-> n1 (accept)
+ *   root -"a"-> n2 -"bc"-> n3 (accept)
+ *   n2 -"d"-> n1
+ */
+class FrozenGraphTest: public testing::Test
+{
+ protected:
+
+  void SetUp() override
+  {
+    auto root = graph_.get_root();
+    auto n1 = graph_.add_node(root, "ab");
+    auto n2 = graph_.add_node(root, "a");
+    auto n3 = graph_.add_node(n2, "bc");
+    graph_.add_edge(n2, n1, "d");
+    graph_.set_accept(n1, true);
+    graph_.set_accept(n3, true);
+    // A node that is not reachable from the root.
+    graph_.add_node();
+  }
+
+  LabeledGraph graph_;
+};
+
+TEST_F(FrozenGraphTest, Counts)
+{
+  const FrozenGraph frozen{graph_};
+  EXPECT_EQ(4, frozen.get_num_nodes());
+  EXPECT_EQ(4, frozen.get_num_edges());
+  EXPECT_EQ(2, frozen.get_num_accept());
+  EXPECT_EQ(4, frozen.get_labels().size());
+  EXPECT_EQ(graph_.get_label_counts(), frozen.get_label_counts());
+  EXPECT_EQ(3, frozen.count_strings());
+}
+
+TEST_F(FrozenGraphTest, TopologicalOrder)
+{
+  const FrozenGraph frozen{graph_};
+  for (FrozenGraph::NodeId node = 0; node < frozen.get_num_nodes(); ++node) {
+    for (auto edge: frozen.get_out_edges(node)) {
+      EXPECT_LT(node, frozen.get_target(edge));
+    }
+  }
+  // The first child of the root is numbered right after it.
+  auto first_edge = *frozen.get_out_edges(frozen.get_root()).begin();
+  EXPECT_EQ(1, frozen.get_target(first_edge));
+}
+
+TEST_F(FrozenGraphTest, EdgesSortedByLabel)
+{
+  const FrozenGraph frozen{graph_};
+  auto root = frozen.get_root();
+  ASSERT_EQ(2, frozen.get_out_degree(root));
+  std::vector<std::string> labels;
+  for (auto edge: frozen.get_out_edges(root)) {
+    labels.emplace_back(frozen.get_label(edge).str());
+    EXPECT_EQ(frozen.get_label(edge),
+              frozen.get_labels().at(frozen.get_label_id(edge)));
+  }
+  EXPECT_EQ((std::vector<std::string>{"a", "ab"}), labels);
+}
+
+TEST_F(FrozenGraphTest, FollowOutEdge)
+{
+  const FrozenGraph frozen{graph_};
+  auto root = frozen.get_root();
+  auto n1 = frozen.follow_out_edge(root, "ab");
+  auto n2 = frozen.follow_out_edge(root, "a");
+  ASSERT_NE(FrozenGraph::NO_NODE, n1);
+  ASSERT_NE(FrozenGraph::NO_NODE, n2);
+  EXPECT_TRUE(frozen.get_accept(n1));
+  EXPECT_FALSE(frozen.get_accept(n2));
+  EXPECT_EQ(n1, frozen.follow_out_edge(n2, "d"));
+  EXPECT_EQ(FrozenGraph::NO_NODE, frozen.follow_out_edge(root, "b"));
+  EXPECT_EQ(FrozenGraph::NO_NODE, frozen.follow_out_edge(root, "abc"));
+}
+
+TEST_F(FrozenGraphTest, HasString)
+{
+  const FrozenGraph frozen{graph_};
+  // "ab" is only accepted through the second edge starting with 'a'.
+  EXPECT_TRUE(frozen.has_string("ab"));
+  EXPECT_TRUE(frozen.has_string("abc"));
+  EXPECT_TRUE(frozen.has_string("ad"));
+  EXPECT_FALSE(frozen.has_string(""));
+  EXPECT_FALSE(frozen.has_string("a"));
+  EXPECT_FALSE(frozen.has_string("abd"));
+  EXPECT_FALSE(frozen.has_string("b"));
+}
+
+TEST_F(FrozenGraphTest, Thaw)
+{
+  const FrozenGraph frozen{graph_};
+  LabeledGraph thawed;
+  frozen.thaw(thawed);
+  // The unreachable node is not kept.
+  EXPECT_EQ(4, thawed.get_num_nodes());
+  EXPECT_EQ(4, thawed.get_num_edges());
+  EXPECT_EQ(2, thawed.get_num_accept());
+  EXPECT_EQ(graph_.get_label_counts(), thawed.get_label_counts());
+  auto n2 = thawed.get_root()->follow_out_edge("a");
+  ASSERT_NE(nullptr, n2);
+  EXPECT_EQ(thawed.get_root()->follow_out_edge("ab"), n2->follow_out_edge("d"));
+  EXPECT_TRUE(n2->follow_out_edge("bc")->get_accept());
+}
+
+TEST_F(FrozenGraphTest, WriteAndRead)
+{
+  const FrozenGraph frozen{graph_};
+  std::stringstream stream;
+  frozen.write(stream);
+  // Every section is padded to a multiple of 8 bytes.
+  EXPECT_EQ(0, stream.str().size() % 8);
+
+  auto read = FrozenGraph::read(stream);
+  ASSERT_TRUE(read.has_value());
+  EXPECT_EQ(frozen.get_num_nodes(), read->get_num_nodes());
+  EXPECT_EQ(frozen.get_num_edges(), read->get_num_edges());
+  EXPECT_EQ(frozen.get_num_accept(), read->get_num_accept());
+  EXPECT_EQ(frozen.get_label_counts(), read->get_label_counts());
+  for (FrozenGraph::NodeId node = 0; node < frozen.get_num_nodes(); ++node) {
+    EXPECT_EQ(frozen.get_accept(node), read->get_accept(node));
+    for (auto edge: frozen.get_out_edges(node)) {
+      EXPECT_EQ(frozen.get_target(edge), read->get_target(edge));
+      EXPECT_EQ(frozen.get_label(edge).str(), read->get_label(edge).str());
+    }
+  }
+
+  // Writing the graph that was read gives the same checkpoint.
+  std::stringstream copy;
+  read->write(copy);
+  EXPECT_EQ(stream.str(), copy.str());
+}
+
+TEST_F(FrozenGraphTest, ReadInvalid)
+{
+  std::stringstream stream;
+  FrozenGraph{graph_}.write(stream);
+  const auto checkpoint = stream.str();
+
+  std::stringstream empty;
+  EXPECT_FALSE(FrozenGraph::read(empty).has_value());
+
+  auto bad_magic = checkpoint;
+  bad_magic[0] = 'X';
+  std::stringstream bad_magic_stream{bad_magic};
+  EXPECT_FALSE(FrozenGraph::read(bad_magic_stream).has_value());
+
+  std::stringstream truncated{checkpoint.substr(0, checkpoint.size() - 8)};
+  EXPECT_FALSE(FrozenGraph::read(truncated).has_value());
+
+  // The targets follow a 48-byte header, 5 label offsets, the 6 characters
+  // of the labels (padded to 8 bytes), and 5 edge offsets. Pointing the
+  // first edge back at the root makes the graph cyclic.
+  auto bad_target = checkpoint;
+  const uint32_t root = 0;
+  std::memcpy(&bad_target[48 + 5 * 8 + 8 + 5 * 8], &root, sizeof(root));
+  std::stringstream bad_target_stream{bad_target};
+  EXPECT_FALSE(FrozenGraph::read(bad_target_stream).has_value());
+}
+
+TEST(FrozenGraph, MatchesLexicon)
+{
+  const std::vector<std::string> strings{
+    "com.example", "com.example.mail", "com.sample", "net.example",
+    "org.example", "org.example.www", "org.sample.www"};
+  FSALexicon lexicon;
+  for (const auto& str: strings) {
+    lexicon.add_string(str);
+  }
+  for (size_t level: {0, 3}) {
+    lexicon.compact(level);
+    const FrozenGraph frozen{lexicon.get_graph()};
+    EXPECT_EQ(lexicon.get_graph().get_num_nodes(), frozen.get_num_nodes());
+    EXPECT_EQ(lexicon.get_graph().get_num_edges(), frozen.get_num_edges());
+    EXPECT_EQ(strings.size(), frozen.count_strings());
+    for (const auto& str: strings) {
+      EXPECT_TRUE(frozen.has_string(str)) << str;
+      EXPECT_FALSE(frozen.has_string(str + ".")) << str;
+      EXPECT_FALSE(frozen.has_string(str.substr(0, str.length() - 1))) << str;
+    }
+  }
+}
@@ -8,6 +8,7 @@
 // Include C standard libraries.
 
 // Include C++ standard libraries.
+#include <vector>
 
 // Include other headers from this project.
 #include "../../../../src/signaling/graph/labeled_graph/graph.h"
@@ -200,6 +201,119 @@ TEST(LabeledGraph, RemoveEdge)
   EXPECT_EQ(0, graph.get_num_edges());
 }
 
+TEST(LabeledGraph, InEdgesNotIndexedByDefault)
+{
+  LabeledGraph graph;
+  auto child = graph.add_node(graph.get_root(), SAMPLE_LABEL);
+  graph.add_edge(graph.get_root(), child, SAMPLE_LABEL2);
+  EXPECT_FALSE(graph.has_in_edge_index());
+  EXPECT_EQ(2, child->get_in_degree());
+  EXPECT_TRUE(child->get_in_edges().empty());
+  graph.remove_edge(graph.get_root(), SAMPLE_LABEL);
+  EXPECT_EQ(1, child->get_in_degree());
+}
+
+TEST(LabeledGraph, RemoveNodeKeepsInEdgeIndexState)
+{
+  LabeledGraph graph;
+  auto root = graph.get_root();
+  auto child = graph.add_node(root, SAMPLE_LABEL);
+  graph.add_node(root, SAMPLE_LABEL2);
+  // Removing a node with parents builds the index only for the call.
+  graph.remove_node(child);
+  EXPECT_FALSE(graph.has_in_edge_index());
+  EXPECT_EQ(1, graph.get_num_edges());
+
+  // An index built by the caller is kept.
+  child = graph.add_node(root, SAMPLE_LABEL3);
+  graph.build_in_edge_index();
+  graph.remove_node(child);
+  EXPECT_TRUE(graph.has_in_edge_index());
+  EXPECT_EQ(1, graph.get_num_edges());
+}
+
+TEST(LabeledGraph, BuildAndDropInEdgeIndex)
+{
+  LabeledGraph graph;
+  auto root = graph.get_root();
+  auto child = graph.add_node(root, SAMPLE_LABEL);
+  graph.add_edge(root, child, SAMPLE_LABEL2);
+  const auto& labels = graph.get_labels();
+  graph.build_in_edge_index();
+  EXPECT_TRUE(graph.has_in_edge_index());
+  EXPECT_EQ(2, child->get_in_edges().size());
+  EXPECT_TRUE(child->has_in_edge(*labels.find(SAMPLE_LABEL), root));
+  EXPECT_TRUE(child->has_in_edge(*labels.find(SAMPLE_LABEL2), root));
+
+  // The index is kept up to date until it is dropped.
+  graph.remove_edge(root, SAMPLE_LABEL2);
+  auto grandchild = graph.add_node(child, SAMPLE_LABEL3);
+  EXPECT_EQ(1, child->get_in_edges().size());
+  EXPECT_TRUE(grandchild->has_in_edge(*labels.find(SAMPLE_LABEL3), child));
+
+  graph.drop_in_edge_index();
+  EXPECT_FALSE(graph.has_in_edge_index());
+  EXPECT_TRUE(child->get_in_edges().empty());
+  EXPECT_EQ(1, child->get_in_degree());
+  EXPECT_EQ(1, grandchild->get_in_degree());
+}
+
+TEST(LabeledGraph, BuildLargeInEdgeIndex)
+{
+  // Build a graph large enough to index with several threads: a long chain
+  // with an edge from every node to a shared sink.
+  const size_t num_nodes = 300000;
+  LabeledGraph graph;
+  auto sink = graph.add_node();
+  std::vector<Node*> chain{graph.get_root()};
+  for (size_t i = 0; i < num_nodes; ++i) {
+    chain.push_back(graph.add_node(chain.back(), SAMPLE_LABEL));
+    graph.add_edge(chain[i], sink, SAMPLE_LABEL2);
+  }
+  graph.build_in_edge_index();
+  EXPECT_EQ(num_nodes, sink->get_in_edges().size());
+  auto label = *graph.get_labels().find(SAMPLE_LABEL);
+  for (size_t i = 1; i < chain.size(); ++i) {
+    ASSERT_EQ(1, chain[i]->get_in_edges().size());
+    EXPECT_TRUE(chain[i]->has_in_edge(label, chain[i - 1]));
+  }
+}
+
+TEST(LabeledGraph, CountLabels)
+{
+  LabeledGraph graph;
+  auto root = graph.get_root();
+  auto child = graph.add_node(root, SAMPLE_LABEL);
+  graph.add_node(child, SAMPLE_LABEL);
+  graph.add_node(child, SAMPLE_LABEL2);
+  EXPECT_EQ(2, graph.get_labels().size());
+  EXPECT_EQ(2, graph.get_label_count(SAMPLE_LABEL));
+  EXPECT_EQ(1, graph.get_label_count(SAMPLE_LABEL2));
+  EXPECT_EQ(0, graph.get_label_count(SAMPLE_LABEL3));
+  auto label = *graph.get_labels().find(SAMPLE_LABEL);
+  EXPECT_EQ(2, graph.get_label_count(label));
+  EXPECT_EQ(2, graph.get_label_counts().at(SAMPLE_LABEL));
+
+  // Labels stay interned after their last edge is removed, but are no longer
+  // counted.
+  graph.remove_edge(child, SAMPLE_LABEL2);
+  EXPECT_EQ(2, graph.get_labels().size());
+  EXPECT_EQ(0, graph.get_label_count(SAMPLE_LABEL2));
+  EXPECT_EQ(1, graph.get_label_counts().size());
+}
+
+TEST(LabeledGraph, CopyInternsLabels)
+{
+  LabeledGraph graph1;
+  graph1.add_node(graph1.get_root(), SAMPLE_LABEL);
+  const LabeledGraph graph2{graph1};
+  const auto& [label1, child1] = *graph1.get_root()->get_out_edges().begin();
+  const auto& [label2, child2] = *graph2.get_root()->get_out_edges().begin();
+  EXPECT_NE(label1.str().data(), label2.str().data());
+  EXPECT_EQ(label1, label2);
+  EXPECT_EQ(1, graph2.get_label_count(label2));
+}
+
 // TODO: tests removing edge with source node not in the graph
 // TODO: tests removing edge with label not in out-edge labels
 // TODO: tests removing edge to child with in-degree 1
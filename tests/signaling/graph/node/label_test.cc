@@ -0,0 +1,113 @@
+/**
+ * Unit tests for edge labels and the pool that interns them.
+ */
+
+// Include C++ standard libraries.
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+// Include other headers from this project.
+#include "../../../../src/signaling/graph/node/label.h"
+
+// Include headers from other projects.
+#include "gtest/gtest.h"
+
+TEST(Label, Empty)
+{
+  const Label label;
+  EXPECT_TRUE(label.empty());
+  EXPECT_EQ(0, label.length());
+  EXPECT_EQ(Label::NO_ID, label.id());
+  EXPECT_EQ("", label.str());
+}
+
+TEST(LabelPool, InternOnce)
+{
+  LabelPool pool;
+  auto a = pool.intern("a");
+  auto abc = pool.intern("abc");
+  EXPECT_EQ(2, pool.size());
+  EXPECT_EQ(a, pool.intern(std::string{"a"}));
+  EXPECT_EQ(abc.str().data(), pool.intern("abc").str().data());
+  EXPECT_EQ(2, pool.size());
+  EXPECT_NE(a, abc);
+  EXPECT_EQ("abc", abc.str());
+  EXPECT_EQ(3, abc.length());
+  EXPECT_EQ('a', abc.front());
+}
+
+TEST(LabelPool, DenseIds)
+{
+  LabelPool pool;
+  for (int i = 0; i < 1000; ++i) {
+    auto label = pool.intern(std::to_string(i));
+    EXPECT_EQ(i, label.id());
+    EXPECT_EQ(label, pool.at(label.id()));
+  }
+  EXPECT_EQ(1000, pool.size());
+}
+
+TEST(LabelPool, Find)
+{
+  LabelPool pool;
+  auto label = pool.intern("ab");
+  pool.intern("c");
+  EXPECT_EQ(label, pool.find("ab"));
+  EXPECT_TRUE(pool.find("c").has_value());
+  EXPECT_FALSE(pool.find("a").has_value());
+  EXPECT_FALSE(pool.find("abc").has_value());
+  EXPECT_EQ(2, pool.size());
+}
+
+TEST(LabelPool, OrderByString)
+{
+  LabelPool pool;
+  auto b = pool.intern("b");
+  auto a = pool.intern("a");
+  auto ab = pool.intern("ab");
+  EXPECT_LT(a, ab);
+  EXPECT_LT(ab, b);
+  EXPECT_FALSE(a < a);
+  EXPECT_LT(a, std::string{"b"});
+  EXPECT_LT(std::string{"a"}, b);
+}
+
+TEST(LabelPool, CompareAcrossPools)
+{
+  LabelPool pool1, pool2;
+  pool2.intern("x");
+  auto label1 = pool1.intern("abc");
+  auto label2 = pool2.intern("abc");
+  EXPECT_NE(label1.id(), label2.id());
+  EXPECT_EQ(label1, label2);
+  EXPECT_EQ(std::hash<Label>{}(label1), std::hash<Label>{}(label2));
+  EXPECT_NE(label1, pool2.intern("abd"));
+  std::unordered_set<Label> labels{label1};
+  EXPECT_EQ(1, labels.count(label2));
+}
+
+TEST(LabelPool, LongLabels)
+{
+  LabelPool pool;
+  const std::string long_text(1 << 20, 'x');
+  auto label = pool.intern(long_text);
+  EXPECT_EQ(long_text, label.str());
+  // Fill more than one shared block with shorter labels.
+  for (int i = 0; i < 20000; ++i) {
+    auto text = std::to_string(i) + std::string(10, 'y');
+    EXPECT_EQ(text, pool.intern(text).str());
+  }
+  EXPECT_EQ(long_text, pool.intern(long_text).str());
+  EXPECT_EQ(20001, pool.size());
+}
+
+TEST(LabelPool, Swap)
+{
+  LabelPool pool1, pool2;
+  auto label = pool1.intern("abc");
+  pool1.swap(pool2);
+  EXPECT_EQ(0, pool1.size());
+  EXPECT_EQ(label, pool2.find("abc"));
+  EXPECT_EQ("abc", label.str());
+}
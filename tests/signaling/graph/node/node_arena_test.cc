@@ -0,0 +1,84 @@
+/**
+ * Unit tests for the chunked node store used by LabeledGraph.
+ */
+
+// Include C++ standard libraries.
+#include <set>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../../../src/signaling/graph/node/node.h"
+#include "../../../../src/signaling/graph/node/node_arena.h"
+
+// Include headers from other projects.
+#include "gtest/gtest.h"
+
+TEST(NodeArena, Empty)
+{
+  NodeArena arena;
+  Node node;
+  EXPECT_EQ(0, arena.size());
+  EXPECT_EQ(arena.begin(), arena.end());
+  EXPECT_FALSE(arena.contains(nullptr));
+  EXPECT_FALSE(arena.contains(&node));
+  EXPECT_EQ(Node::NO_INDEX, node.get_index());
+}
+
+TEST(NodeArena, AllocateAcrossChunks)
+{
+  NodeArena arena;
+  std::vector<Node*> nodes;
+  for (size_t i = 0; i < 2 * NodeArena::CHUNK_SIZE + 1; ++i) {
+    nodes.push_back(arena.allocate());
+    EXPECT_EQ(i, nodes.back()->get_index());
+    EXPECT_EQ(nodes.back(), arena.at(nodes.back()->get_index()));
+  }
+  EXPECT_EQ(nodes.size(), arena.size());
+  EXPECT_EQ(nodes.size(), arena.capacity());
+  std::vector<Node*> iterated(arena.begin(), arena.end());
+  EXPECT_EQ(nodes, iterated);
+}
+
+TEST(NodeArena, ReleaseAndReuse)
+{
+  NodeArena arena;
+  LabelPool labels;
+  auto first = arena.allocate();
+  auto second = arena.allocate();
+  auto third = arena.allocate();
+  second->set_accept(true);
+  second->add_out_edge(labels.intern("a"), third);
+  second->add_in_edge(labels.intern("b"), first);
+
+  arena.release(second);
+  EXPECT_EQ(2, arena.size());
+  EXPECT_FALSE(arena.contains(second));
+  EXPECT_TRUE(arena.contains(first));
+  EXPECT_TRUE(arena.contains(third));
+  std::vector<Node*> iterated(arena.begin(), arena.end());
+  EXPECT_EQ((std::vector<Node*>{first, third}), iterated);
+
+  // The released slot is reused, and the reused node is empty.
+  auto reused = arena.allocate();
+  EXPECT_EQ(second, reused);
+  EXPECT_TRUE(arena.contains(reused));
+  EXPECT_EQ(3, arena.capacity());
+  EXPECT_FALSE(reused->get_accept());
+  EXPECT_EQ(0, reused->get_in_degree());
+  EXPECT_EQ(0, reused->get_out_degree());
+  EXPECT_EQ(Node{}.get_out_hash(), reused->get_out_hash());
+}
+
+TEST(NodeArena, ContainsOtherArena)
+{
+  NodeArena arena, other;
+  auto node = arena.allocate();
+  auto other_node = other.allocate();
+  EXPECT_EQ(node->get_index(), other_node->get_index());
+  EXPECT_FALSE(arena.contains(other_node));
+  EXPECT_FALSE(other.contains(node));
+
+  arena.swap(other);
+  EXPECT_TRUE(arena.contains(other_node));
+  EXPECT_TRUE(other.contains(node));
+}
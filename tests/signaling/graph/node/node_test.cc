@@ -54,7 +54,8 @@ class TwoTestNodes: public virtual TestNode
 class TestLabel: public virtual testing::Test
 {
  protected:
-  const std::string label_ = "a";
+  LabelPool labels_;
+  const Node::Label label_ = labels_.intern("a");
 };
 
 /**
@@ -64,7 +65,7 @@ class TestLabel: public virtual testing::Test
 class TwoTestLabels: public virtual TestLabel
 {
  protected:
-  const std::string label2_ = "b";
+  const Node::Label label2_ = labels_.intern("b");
 };
 
 /**
@@ -236,7 +237,7 @@ TEST_F(NodeTestInEdge, RemoveNonexistentInEdge)
 TEST_F(NodeTestInEdge, IterateInEdges)
 {
   test_node_.add_in_edge(label2_, upstream_node_);
-  const std::vector<std::pair<std::string, Node*>> edges{
+  const std::vector<Node::HalfEdge> edges{
     {label_, upstream_node_}, {label2_, upstream_node_}};
   auto i = 0;
   for (const auto in_edge_itr: test_node_.get_in_edges()) {
@@ -253,7 +254,7 @@ TEST_F(NodeTestInEdge, IterateInEdges)
 TEST_F(NodeTestInEdge, IterateReverseInEdges)
 {
   test_node_.add_in_edge(label2_, upstream_node_);
-  const std::vector<std::pair<std::string, Node*>> edges{
+  const std::vector<Node::HalfEdge> edges{
     {label2_, upstream_node_}, {label_, upstream_node_}};
   auto i = 0;
   for (const auto in_edge_itr: test_node_.get_reverse_in_edges()) {
@@ -339,7 +340,7 @@ TEST_F(NodeTestOutEdge, RemoveNonexistentOutEdge)
 TEST_F(NodeTestOutEdge, IterateOutEdges)
 {
   test_node_.add_out_edge(label2_, downstream_node_);
-  const std::vector<std::pair<std::string, Node*>> edges{
+  const std::vector<Node::HalfEdge> edges{
     {label_, downstream_node_}, {label2_, downstream_node_}};
   auto i = 0;
   for (auto& out_edge_itr: test_node_.get_out_edges()) {
@@ -356,7 +357,7 @@ TEST_F(NodeTestOutEdge, IterateOutEdges)
 TEST_F(NodeTestOutEdge, IterateReverseOutEdges)
 {
   test_node_.add_out_edge(label2_, downstream_node_);
-  const std::vector<std::pair<std::string, Node*>> edges{
+  const std::vector<Node::HalfEdge> edges{
     {label2_, downstream_node_}, {label_, downstream_node_}};
   auto i = 0;
   for (auto& out_edge_itr: test_node_.get_reverse_out_edges()) {
@@ -489,3 +490,85 @@ TEST_F(NodeTestEqual, AddDifferentOutEdges)
   EXPECT_NE(test_node_, other_test_node_);
 }
 
+
+/**
+ * Test fixture for the hash of a node's accept flag and out-edges.
+ */
+class NodeTestOutHash: public TwoTestNodes, public AddInEdge,
+                       public TwoTestLabels
+{
+ protected:
+  virtual void SetUp()
+  {
+    TwoTestNodes::SetUp();
+    AddInEdge::SetUp();
+    TwoTestLabels::SetUp();
+  }
+};
+
+/**
+ * Check that the hash depends on the accept flag but not on in-edges.
+ */
+TEST_F(NodeTestOutHash, AcceptAndInEdges)
+{
+  EXPECT_EQ(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+  test_node_.set_accept(true);
+  EXPECT_NE(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+  test_node_.set_accept(true);
+  other_test_node_.set_accept(true);
+  EXPECT_EQ(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+  test_node_.add_in_edge(label_, upstream_node_);
+  EXPECT_EQ(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+}
+
+/**
+ * Check that the hash does not depend on the order in which out-edges are
+ * added, and is restored when an out-edge is removed.
+ */
+TEST_F(NodeTestOutHash, OutEdges)
+{
+  auto empty_hash = test_node_.get_out_hash();
+  test_node_.add_out_edge(label_, downstream_node_);
+  test_node_.add_out_edge(label_, upstream_node_);
+  test_node_.add_out_edge(label2_, upstream_node_);
+  other_test_node_.add_out_edge(label2_, upstream_node_);
+  EXPECT_NE(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+  other_test_node_.add_out_edge(label_, downstream_node_);
+  EXPECT_EQ(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+
+  test_node_.remove_out_edge(label2_);
+  test_node_.remove_out_edge(label2_);
+  test_node_.remove_out_edge(label_);
+  EXPECT_EQ(empty_hash, test_node_.get_out_hash());
+}
+
+/**
+ * Check that the hash depends on the targets of out-edges.
+ */
+TEST_F(NodeTestOutHash, DifferentOutTargets)
+{
+  test_node_.add_out_edge(label_, downstream_node_);
+  other_test_node_.add_out_edge(label_, upstream_node_);
+  EXPECT_NE(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+}
+
+/**
+ * Check that the hash does not depend on whether the accept flag is set before
+ * or after the out-edges are added.
+ */
+TEST_F(NodeTestOutHash, AcceptBeforeOrAfterOutEdges)
+{
+  test_node_.set_accept(true);
+  test_node_.add_out_edge(label_, downstream_node_);
+  test_node_.add_out_edge(label2_, upstream_node_);
+  other_test_node_.add_out_edge(label_, downstream_node_);
+  other_test_node_.add_out_edge(label2_, upstream_node_);
+  other_test_node_.set_accept(true);
+  EXPECT_EQ(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+
+  test_node_.remove_out_edge(label2_);
+  other_test_node_.set_accept(false);
+  other_test_node_.remove_out_edge(label2_);
+  other_test_node_.set_accept(true);
+  EXPECT_EQ(test_node_.get_out_hash(), other_test_node_.get_out_hash());
+}
@@ -0,0 +1,85 @@
+/**
+ * Unit tests for numbering the strings of a LabeledGraph by path counts.
+ */
+
+// Include C++ standard libraries.
+#include <iterator>
+#include <set>
+#include <string>
+
+// Include other headers from this project.
+#include "../../../../src/signaling/graph/labeled_graph/graph.h"
+#include "../../../../src/signaling/graph/path_counts/path_counts.h"
+#include "../../../../src/signaling/lexicon/fsa_lexicon/fsa_lexicon.h"
+#include "../../../fsa_lexicon/test_helper.h"
+
+// Include headers from other projects.
+#include "gtest/gtest.h"
+
+TEST(PathCounts, EmptyGraph)
+{
+  LabeledGraph graph;
+  // The only path ends at a node that is not an accept node.
+  graph.add_node(graph.get_root(), "a");
+  const PathCounts counts{graph};
+  EXPECT_EQ(0, counts.get_root());
+  EXPECT_FALSE(counts.rank("").has_value());
+  EXPECT_FALSE(counts.rank("a").has_value());
+  EXPECT_FALSE(counts.select(0).has_value());
+  EXPECT_EQ(0, counts.count_prefix(""));
+}
+
+class PathCountsTest: public testing::Test
+{
+ protected:
+
+  void SetUp() override
+  {
+    // The empty string and a prefix of every other name under "com" are
+    // accepted, too.
+    strings_.insert({"", "com"});
+    auto stream = set_stream(strings_);
+    lexicon_.add_file(stream);
+  }
+
+  std::set<std::string> strings_ = SAMPLE_NAMES;
+  FSALexicon lexicon_;
+};
+
+TEST_F(PathCountsTest, RankAndSelect)
+{
+  for (size_t level: {0, 1, 3}) {
+    lexicon_.compact(level);
+    const PathCounts counts{lexicon_.get_graph()};
+    ASSERT_EQ(strings_.size(), counts.get_root()) << level;
+    size_t rank = 0;
+    for (const auto& str: strings_) {
+      EXPECT_EQ(rank, counts.rank(str)) << level << ": " << str;
+      EXPECT_EQ(str, counts.select(rank)) << level;
+      ++rank;
+    }
+    EXPECT_FALSE(counts.select(rank).has_value()) << level;
+    for (const auto& str: {"c", "com.", "com.example.w", "net", "zzz"}) {
+      EXPECT_FALSE(counts.rank(str).has_value()) << level << ": " << str;
+    }
+  }
+}
+
+TEST_F(PathCountsTest, CountPrefix)
+{
+  for (size_t level: {0, 1, 3}) {
+    lexicon_.compact(level);
+    const PathCounts counts{lexicon_.get_graph()};
+    // Prefixes that end within a label of the compacted graph, too.
+    for (const auto& prefix: {"", "c", "com", "com.ex", "com.example.",
+                              "org.example.w", "org.s", "x"}) {
+      auto first = strings_.lower_bound(prefix);
+      auto last = first;
+      while (last != strings_.end() && last->rfind(prefix, 0) == 0) {
+        ++last;
+      }
+      EXPECT_EQ(static_cast<size_t>(std::distance(first, last)),
+                counts.count_prefix(prefix)) << level << ": " << prefix;
+    }
+  }
+}
@@ -0,0 +1,84 @@
+/**
+ * Unit tests for the lazy enumeration of accepted strings.
+ */
+
+// Include C++ standard libraries.
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../../src/signaling/graph/labeled_graph/graph.h"
+#include "../../../src/signaling/lexicon/fsa_lexicon/accept_string_iterator.h"
+#include "../../../src/signaling/lexicon/fsa_lexicon/fsa_lexicon.h"
+#include "../../fsa_lexicon/test_helper.h"
+
+// Include headers from other projects.
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<std::string> collect(const AcceptStrings& strings)
+{
+  return {strings.begin(), strings.end()};
+}
+
+}  // namespace
+
+TEST(AcceptStringIterator, EmptyGraph)
+{
+  LabeledGraph graph;
+  // Neither node on the path is an accept node.
+  graph.add_node(graph.add_node(graph.get_root(), "a"), "b");
+  AcceptStrings strings{graph.get_root()};
+  EXPECT_EQ(strings.end(), strings.begin());
+}
+
+TEST(AcceptStringIterator, EmptyString)
+{
+  LabeledGraph graph;
+  graph.set_accept(graph.get_root(), true);
+  graph.set_accept(graph.add_node(graph.get_root(), "a"), true);
+  const std::vector<std::string> expected{"", "a"};
+  EXPECT_EQ(expected, collect(AcceptStrings{graph.get_root()}));
+}
+
+class AcceptStringIteratorTest: public testing::Test
+{
+ protected:
+
+  void SetUp() override
+  {
+    auto stream = set_stream(SAMPLE_NAMES);
+    lexicon_.add_file(stream);
+  }
+
+  FSALexicon lexicon_;
+  const std::vector<std::string> strings_{SAMPLE_NAMES.begin(),
+                                          SAMPLE_NAMES.end()};
+};
+
+TEST_F(AcceptStringIteratorTest, LexicographicOrder)
+{
+  EXPECT_EQ(strings_, collect(lexicon_.get_strings()));
+  auto itr = lexicon_.get_strings().begin();
+  EXPECT_EQ(11, itr->length());
+  ++itr;
+  EXPECT_EQ("com.example.mail", *itr);
+}
+
+TEST_F(AcceptStringIteratorTest, Compacted)
+{
+  lexicon_.compact(3);
+  EXPECT_EQ(strings_, collect(lexicon_.get_strings()));
+}
+
+TEST_F(AcceptStringIteratorTest, Dump)
+{
+  std::stringstream expected, dumped;
+  for (const auto& str: strings_) {
+    expected << str << "\n";
+  }
+  lexicon_.dump(dumped);
+  EXPECT_EQ(expected.str(), dumped.str());
+}
@@ -7,9 +7,13 @@
 // Include C standard libraries.
 
 // Include C++ standard libraries.
+#include <algorithm>
+#include <iterator>
+#include <random>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -147,7 +151,7 @@ TEST_F(GoogleLexiconShort, AddString1)
   EXPECT_EQ(5, lexicon_.get_graph().get_num_nodes());
   EXPECT_EQ(4, lexicon_.get_graph().get_num_edges());
   EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
-  EXPECT_TRUE(lexicon_.get_register().empty());
+  EXPECT_EQ(4, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(1, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
@@ -158,10 +162,10 @@ TEST_F(GoogleLexiconShort, AddString1)
 TEST_F(GoogleLexiconShort, AddString2)
 {
   add_n_strings(2);
-  EXPECT_EQ(8, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(7, lexicon_.get_graph().get_num_nodes());
   EXPECT_EQ(7, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(3, lexicon_.get_register().size());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(6, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(1, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
@@ -175,27 +179,27 @@ TEST_F(GoogleLexiconShort, AddString2)
 TEST_F(GoogleLexiconShort, AddString3)
 {
   add_n_strings(3);
-  EXPECT_EQ(9, lexicon_.get_graph().get_num_nodes());
-  EXPECT_EQ(9, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(3, lexicon_.get_register().size());
+  EXPECT_EQ(7, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(8, lexicon_.get_graph().get_num_edges());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(6, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(1, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
   EXPECT_EQ(1, label_map.at("h"));
   EXPECT_EQ(1, label_map.at("m"));
   EXPECT_EQ(2, label_map.at("w"));
-  EXPECT_EQ(2, label_map.at("x"));
+  EXPECT_EQ(1, label_map.at("x"));
   EXPECT_EQ(1, label_map.at("/"));
 }
 
 TEST_F(GoogleLexiconShort, AddString4)
 {
   add_n_strings(4);
-  EXPECT_EQ(10, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(9, lexicon_.get_graph().get_num_nodes());
   EXPECT_EQ(11, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(5, lexicon_.get_register().size());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(8, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(1, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
@@ -210,19 +214,19 @@ TEST_F(GoogleLexiconShort, AddString4)
 TEST_F(GoogleLexiconShort, AddString5)
 {
   add_n_strings(5);
-  EXPECT_EQ(11, lexicon_.get_graph().get_num_nodes());
-  EXPECT_EQ(13, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(5, lexicon_.get_register().size());
+  EXPECT_EQ(7, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(9, lexicon_.get_graph().get_num_edges());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(6, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(1, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
   EXPECT_EQ(1, label_map.at("h"));
-  EXPECT_EQ(2, label_map.at("m"));
+  EXPECT_EQ(1, label_map.at("m"));
   EXPECT_EQ(1, label_map.at("o"));
-  EXPECT_EQ(3, label_map.at("w"));
-  EXPECT_EQ(2, label_map.at("x"));
-  EXPECT_EQ(2, label_map.at("/"));
+  EXPECT_EQ(2, label_map.at("w"));
+  EXPECT_EQ(1, label_map.at("x"));
+  EXPECT_EQ(1, label_map.at("/"));
 }
 
 TEST_F(GoogleLexiconShort, AddString7)
@@ -231,6 +235,7 @@ TEST_F(GoogleLexiconShort, AddString7)
   EXPECT_EQ(8, lexicon_.get_graph().get_num_nodes());
   EXPECT_EQ(11, lexicon_.get_graph().get_num_edges());
   EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(7, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(1, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
@@ -240,7 +245,8 @@ TEST_F(GoogleLexiconShort, AddString7)
   EXPECT_EQ(1, label_map.at("u"));
   EXPECT_EQ(2, label_map.at("w"));
   EXPECT_EQ(1, label_map.at("x"));
-  EXPECT_EQ(2, label_map.at("."));
+  EXPECT_EQ(1, label_map.at("."));
+  EXPECT_EQ(1, label_map.at("/"));
 }
 
 class GoogleLexicon: public testing::Test
@@ -267,7 +273,7 @@ TEST_F(GoogleLexicon, AddString1)
   EXPECT_EQ(14, lexicon_.get_graph().get_num_nodes());
   EXPECT_EQ(13, lexicon_.get_graph().get_num_edges());
   EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
-  EXPECT_TRUE(lexicon_.get_register().empty());
+  EXPECT_EQ(13, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(1, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
@@ -282,10 +288,10 @@ TEST_F(GoogleLexicon, AddString1)
 TEST_F(GoogleLexicon, AddString2)
 {
   add_n_strings(2);
-  EXPECT_EQ(27, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(26, lexicon_.get_graph().get_num_nodes());
   EXPECT_EQ(26, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(12, lexicon_.get_register().size());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(25, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(2, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
@@ -303,10 +309,10 @@ TEST_F(GoogleLexicon, AddString2)
 TEST_F(GoogleLexicon, AddString3)
 {
   add_n_strings(3);
-  EXPECT_EQ(29, lexicon_.get_graph().get_num_nodes());
-  EXPECT_EQ(29, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(15, lexicon_.get_register().size());
+  EXPECT_EQ(26, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(27, lexicon_.get_graph().get_num_edges());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(25, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(2, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
@@ -317,25 +323,25 @@ TEST_F(GoogleLexicon, AddString3)
   EXPECT_EQ(3, label_map.at("l"));
   EXPECT_EQ(1, label_map.at("m"));
   EXPECT_EQ(4, label_map.at("o"));
-  EXPECT_EQ(6, label_map.at("w"));
+  EXPECT_EQ(4, label_map.at("w"));
   EXPECT_EQ(4, label_map.at("."));
 }
 
 TEST_F(GoogleLexicon, AddString4)
 {
   add_n_strings(4);
-  EXPECT_EQ(40, lexicon_.get_graph().get_num_nodes());
-  EXPECT_EQ(41, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(24, lexicon_.get_register().size());
+  EXPECT_EQ(36, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(38, lexicon_.get_graph().get_num_edges());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(35, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
-  EXPECT_EQ(3, label_map.at("a"));
+  EXPECT_EQ(2, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
   EXPECT_EQ(3, label_map.at("e"));
   EXPECT_EQ(6, label_map.at("g"));
   EXPECT_EQ(1, label_map.at("h"));
-  EXPECT_EQ(2, label_map.at("i"));
-  EXPECT_EQ(5, label_map.at("l"));
+  EXPECT_EQ(1, label_map.at("i"));
+  EXPECT_EQ(4, label_map.at("l"));
   EXPECT_EQ(3, label_map.at("m"));
   EXPECT_EQ(7, label_map.at("o"));
   EXPECT_EQ(4, label_map.at("w"));
@@ -345,31 +351,31 @@ TEST_F(GoogleLexicon, AddString4)
 TEST_F(GoogleLexicon, AddString5)
 {
   add_n_strings(5);
-  EXPECT_EQ(39, lexicon_.get_graph().get_num_nodes());
-  EXPECT_EQ(41, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(24, lexicon_.get_register().size());
+  EXPECT_EQ(27, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(29, lexicon_.get_graph().get_num_edges());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(26, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(2, label_map.at("a"));
   EXPECT_EQ(1, label_map.at("c"));
-  EXPECT_EQ(3, label_map.at("e"));
-  EXPECT_EQ(6, label_map.at("g"));
+  EXPECT_EQ(2, label_map.at("e"));
+  EXPECT_EQ(4, label_map.at("g"));
   EXPECT_EQ(1, label_map.at("h"));
   EXPECT_EQ(1, label_map.at("i"));
-  EXPECT_EQ(4, label_map.at("l"));
-  EXPECT_EQ(3, label_map.at("m"));
-  EXPECT_EQ(7, label_map.at("o"));
-  EXPECT_EQ(7, label_map.at("w"));
-  EXPECT_EQ(6, label_map.at("."));
+  EXPECT_EQ(3, label_map.at("l"));
+  EXPECT_EQ(2, label_map.at("m"));
+  EXPECT_EQ(5, label_map.at("o"));
+  EXPECT_EQ(4, label_map.at("w"));
+  EXPECT_EQ(4, label_map.at("."));
 }
 
 TEST_F(GoogleLexicon, AddString6)
 {
   add_n_strings(6);
-  EXPECT_EQ(39, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(38, lexicon_.get_graph().get_num_nodes());
   EXPECT_EQ(41, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(26, lexicon_.get_register().size());
+  EXPECT_EQ(1, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(37, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(2, label_map.at("a"));
   EXPECT_EQ(2, label_map.at("c"));
@@ -389,10 +395,10 @@ TEST_F(GoogleLexicon, AddString6)
 TEST_F(GoogleLexicon, AddString7)
 {
   add_n_strings(7);
-  EXPECT_EQ(43, lexicon_.get_graph().get_num_nodes());
-  EXPECT_EQ(45, lexicon_.get_graph().get_num_edges());
-  EXPECT_EQ(3, lexicon_.get_graph().get_num_accept());
-  EXPECT_EQ(26, lexicon_.get_register().size());
+  EXPECT_EQ(39, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(42, lexicon_.get_graph().get_num_edges());
+  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
+  EXPECT_EQ(38, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(2, label_map.at("a"));
   EXPECT_EQ(2, label_map.at("c"));
@@ -405,7 +411,7 @@ TEST_F(GoogleLexicon, AddString7)
   EXPECT_EQ(2, label_map.at("m"));
   EXPECT_EQ(8, label_map.at("o"));
   EXPECT_EQ(1, label_map.at("u"));
-  EXPECT_EQ(7, label_map.at("w"));
+  EXPECT_EQ(4, label_map.at("w"));
   EXPECT_EQ(7, label_map.at("."));
 }
 
@@ -419,7 +425,8 @@ TEST_F(GoogleLexicon, AddAllStrings)
   EXPECT_EQ(39, lexicon_.get_graph().get_num_nodes());
   EXPECT_EQ(42, lexicon_.get_graph().get_num_edges());
   EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
-  EXPECT_TRUE(lexicon_.get_register().empty());
+  // Every node but the root stays registered for later calls to add_string.
+  EXPECT_EQ(38, lexicon_.get_register().size());
   const auto& label_map = lexicon_.get_graph().get_label_counts();
   EXPECT_EQ(2, label_map.at("a"));
   EXPECT_EQ(2, label_map.at("c"));
@@ -436,6 +443,558 @@ TEST_F(GoogleLexicon, AddAllStrings)
   EXPECT_EQ(7, label_map.at("."));
 }
 
+TEST_F(GoogleLexicon, AddFileSkipsDuplicates)
+{
+  std::stringstream stream;
+  for (const auto& str: domains_) {
+    stream << str << std::endl << str << std::endl;
+  }
+  lexicon_.add_file(stream);
+  EXPECT_EQ(7, lexicon_.size());
+  EXPECT_EQ(39, lexicon_.get_graph().get_num_nodes());
+  EXPECT_EQ(42, lexicon_.get_graph().get_num_edges());
+  EXPECT_EQ(2, lexicon_.get_graph().get_num_accept());
+  for (const auto& str: domains_) {
+    EXPECT_TRUE(lexicon_.has_string(str)) << str;
+  }
+}
+
+TEST_F(GoogleLexicon, AddFileEmptyString)
+{
+  std::stringstream stream;
+  stream << std::endl;
+  for (const auto& str: domains_) {
+    stream << str << std::endl;
+  }
+  lexicon_.add_file(stream);
+  EXPECT_EQ(8, lexicon_.size());
+  EXPECT_TRUE(lexicon_.get_graph().get_root()->get_accept());
+  EXPECT_TRUE(lexicon_.has_string(""));
+  EXPECT_TRUE(lexicon_.has_string("uk.co.google"));
+  EXPECT_FALSE(lexicon_.has_string("uk.co"));
+}
+
+TEST_F(GoogleLexicon, AddFileOutOfOrder)
+{
+  // Strings after the first one that is out of order are added one at a
+  // time, so the lexicon should still contain every string.
+  std::stringstream stream;
+  for (size_t i = 0; i < 5; ++i) {
+    stream << domains_[i] << std::endl;
+  }
+  stream << "ca.google.mail" << std::endl;
+  lexicon_.add_file(stream);
+  EXPECT_EQ(6, lexicon_.size());
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_TRUE(lexicon_.has_string(domains_[i])) << domains_[i];
+  }
+  EXPECT_TRUE(lexicon_.has_string("ca.google.mail"));
+  EXPECT_FALSE(lexicon_.has_string("ca.google"));
+}
+
+TEST(FSALexiconAddFile, EmptyStream)
+{
+  FSALexicon lexicon;
+  std::stringstream stream;
+  lexicon.add_file(stream);
+  EXPECT_EQ(0, lexicon.size());
+  EXPECT_EQ(1, lexicon.get_graph().get_num_nodes());
+  EXPECT_FALSE(lexicon.has_string(""));
+}
+
+TEST(FSALexiconAddString, UnsortedMatchesAddFile)
+{
+  // Shuffle strings that share both prefixes and suffixes, so that many of
+  // them are added through confluence nodes.
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < 2000; ++i) {
+    auto domain = "com.d" + std::to_string(1000 + i / 4);
+    strings.push_back(domain + (i % 4 == 0 ? "" : "." + std::to_string(i % 4)));
+  }
+  std::stringstream stream;
+  for (const auto& str: strings) {
+    stream << str << std::endl;
+  }
+  FSALexicon sorted, unsorted;
+  sorted.add_file(stream);
+  std::mt19937 generator{42};
+  std::shuffle(strings.begin(), strings.end(), generator);
+  for (const auto& str: strings) {
+    unsorted.add_string(str);
+  }
+  EXPECT_EQ(sorted.size(), unsorted.size());
+  // The minimal automaton of a set of strings is unique.
+  EXPECT_EQ(sorted.get_graph().get_num_nodes(),
+            unsorted.get_graph().get_num_nodes());
+  EXPECT_EQ(sorted.get_graph().get_num_edges(),
+            unsorted.get_graph().get_num_edges());
+  EXPECT_EQ(sorted, unsorted);
+  EXPECT_EQ(unsorted.get_graph().get_num_nodes() - 1,
+            unsorted.get_register().size());
+}
+
+TEST(FSALexiconAddString, ClonesConfluenceNodes)
+{
+  std::stringstream stream;
+  stream << "com.a.mail" << std::endl << "com.b.mail" << std::endl;
+  FSALexicon lexicon;
+  lexicon.add_file(stream);
+  // "com.a." and "com.b." lead to the same node, which must be cloned so that
+  // "com.b.www" is not added too.
+  lexicon.add_string("com.a.www");
+  EXPECT_EQ(3, lexicon.size());
+  EXPECT_TRUE(lexicon.has_string("com.a.www"));
+  EXPECT_FALSE(lexicon.has_string("com.b.www"));
+  // Adding the string to the other branch makes the branches equivalent
+  // again, so they are merged back.
+  const auto num_nodes = lexicon.get_graph().get_num_nodes();
+  lexicon.add_string("com.b.www");
+  EXPECT_GT(num_nodes, lexicon.get_graph().get_num_nodes());
+  std::stringstream sorted_stream;
+  for (const auto& str: {"com.a.mail", "com.a.www", "com.b.mail",
+                         "com.b.www"}) {
+    sorted_stream << str << std::endl;
+  }
+  FSALexicon sorted;
+  sorted.add_file(sorted_stream);
+  EXPECT_EQ(sorted.get_graph().get_num_nodes(),
+            lexicon.get_graph().get_num_nodes());
+  EXPECT_EQ(sorted, lexicon);
+}
+
+TEST(FSALexiconAddString, AfterLoad)
+{
+  std::stringstream stream;
+  stream << "com.a.mail" << std::endl << "com.b.mail" << std::endl;
+  FSALexicon lexicon;
+  lexicon.add_file(stream);
+  std::stringstream checkpoint;
+  lexicon.save_checkpoint(checkpoint);
+  FSALexicon loaded;
+  ASSERT_TRUE(loaded.load_checkpoint(checkpoint));
+  EXPECT_TRUE(loaded.get_register().empty());
+  // The register is rebuilt before the first string is added.
+  loaded.add_string("com.c.mail");
+  EXPECT_EQ(3, loaded.size());
+  // The new string shares every node with the others.
+  EXPECT_EQ(lexicon.get_graph().get_num_nodes(),
+            loaded.get_graph().get_num_nodes());
+  EXPECT_EQ(lexicon.get_graph().get_num_edges() + 1,
+            loaded.get_graph().get_num_edges());
+  EXPECT_EQ(loaded.get_graph().get_num_nodes() - 1,
+            loaded.get_register().size());
+}
+
+TEST(FSALexiconRemoveString, MatchesAddFile)
+{
+  // Remove every third of a sorted list of strings, in random order.
+  std::vector<std::string> removed;
+  std::stringstream stream, kept_stream;
+  for (size_t i = 0; i < 2000; ++i) {
+    auto str = "com.d" + std::to_string(1000 + i / 4)
+               + (i % 4 == 0 ? "" : "." + std::to_string(i % 4));
+    stream << str << std::endl;
+    if (i % 3 == 0) {
+      removed.push_back(str);
+    } else {
+      kept_stream << str << std::endl;
+    }
+  }
+  FSALexicon lexicon, kept;
+  lexicon.add_file(stream);
+  kept.add_file(kept_stream);
+  std::mt19937 generator{42};
+  std::shuffle(removed.begin(), removed.end(), generator);
+  for (const auto& str: removed) {
+    lexicon.remove_string(str);
+  }
+  EXPECT_EQ(kept.size(), lexicon.size());
+  // The minimal automaton of a set of strings is unique.
+  EXPECT_EQ(kept.get_graph().get_num_nodes(),
+            lexicon.get_graph().get_num_nodes());
+  EXPECT_EQ(kept.get_graph().get_num_edges(),
+            lexicon.get_graph().get_num_edges());
+  EXPECT_EQ(kept, lexicon);
+  EXPECT_EQ(lexicon.get_graph().get_num_nodes() - 1,
+            lexicon.get_register().size());
+}
+
+TEST(FSALexiconRemoveString, PrunesDeadBranches)
+{
+  FSALexicon lexicon;
+  for (const auto& str: {"com.example", "com.example.www", "org.example"}) {
+    lexicon.add_string(str);
+  }
+  lexicon.remove_string("com.example.www");
+  lexicon.remove_string("com.example");
+  EXPECT_EQ(1, lexicon.size());
+  // Only the path of "org.example" is left.
+  EXPECT_EQ(12, lexicon.get_graph().get_num_nodes());
+  EXPECT_EQ(11, lexicon.get_graph().get_num_edges());
+  lexicon.remove_string("org.example");
+  EXPECT_EQ(0, lexicon.size());
+  EXPECT_EQ(1, lexicon.get_graph().get_num_nodes());
+  EXPECT_TRUE(lexicon.get_register().empty());
+}
+
+TEST(FSALexiconRemoveString, ClonesConfluenceNodes)
+{
+  std::stringstream stream;
+  stream << "com.a.mail" << std::endl << "com.a.www" << std::endl
+         << "com.b.mail" << std::endl << "com.b.www" << std::endl;
+  FSALexicon lexicon;
+  lexicon.add_file(stream);
+  // "com.a." and "com.b." lead to the same node, which must be cloned so that
+  // "com.b.www" is not removed too.
+  lexicon.remove_string("com.a.www");
+  EXPECT_EQ(3, lexicon.size());
+  EXPECT_FALSE(lexicon.has_string("com.a.www"));
+  EXPECT_TRUE(lexicon.has_string("com.b.www"));
+  EXPECT_TRUE(lexicon.has_string("com.a.mail"));
+}
+
+TEST(FSALexiconRemoveString, AfterCopy)
+{
+  std::stringstream stream;
+  stream << "com.a.mail" << std::endl << "com.b.mail" << std::endl;
+  FSALexicon lexicon;
+  lexicon.add_file(stream);
+  // The copy rebuilds a register for its own nodes.
+  FSALexicon copy{lexicon};
+  copy.remove_string("com.a.mail");
+  copy.add_string("com.c.mail");
+  EXPECT_TRUE(lexicon.has_string("com.a.mail"));
+  EXPECT_FALSE(lexicon.has_string("com.c.mail"));
+  EXPECT_FALSE(copy.has_string("com.a.mail"));
+  EXPECT_TRUE(copy.has_string("com.c.mail"));
+  EXPECT_EQ(lexicon.get_graph().get_num_nodes(),
+            copy.get_graph().get_num_nodes());
+}
+
+TEST(FSALexiconDumpParallel, MatchesDump)
+{
+  // Accepted prefixes of other strings have to be split off from the
+  // strings below them, including the empty string at the root.
+  FSALexicon lexicon;
+  lexicon.add_string("");
+  lexicon.add_string("com");
+  for (size_t i = 0; i < 500; ++i) {
+    auto domain = "com.d" + std::to_string(1000 + i / 2);
+    lexicon.add_string(domain);
+    lexicon.add_string(domain + (i % 2 == 0 ? ".mail" : ".www"));
+  }
+  lexicon.add_string("net.example");
+  std::stringstream expected;
+  lexicon.dump(expected);
+
+  for (size_t num_streams: {1, 3, 8}) {
+    std::vector<std::stringstream> streams(num_streams);
+    std::vector<std::ostream*> outstreams;
+    for (auto& stream: streams) {
+      outstreams.push_back(&stream);
+    }
+    lexicon.dump_parallel(outstreams, 2);
+    std::string concatenated;
+    for (const auto& stream: streams) {
+      // Every stream gets a share of the strings.
+      EXPECT_FALSE(stream.str().empty()) << num_streams;
+      concatenated += stream.str();
+    }
+    EXPECT_EQ(expected.str(), concatenated) << num_streams;
+  }
+}
+
+TEST(FSALexiconDumpParallel, Compacted)
+{
+  std::stringstream stream;
+  for (const auto& str: {"com.example", "com.example.mail", "com.sample",
+                         "net.example", "org.example", "org.example.www"}) {
+    stream << str << std::endl;
+  }
+  FSALexicon lexicon;
+  lexicon.add_file(stream);
+  lexicon.compact(3);
+  std::stringstream expected, first, second;
+  lexicon.dump(expected);
+  lexicon.dump_parallel({&first, &second}, 2);
+  EXPECT_EQ(expected.str(), first.str() + second.str());
+}
+
+TEST(FSALexiconRank, FollowsChanges)
+{
+  FSALexicon lexicon;
+  lexicon.add_string("b");
+  lexicon.add_string("d");
+  EXPECT_EQ(1, lexicon.rank("d"));
+  // The counts kept from the last query must not be used after a change.
+  lexicon.add_string("a");
+  EXPECT_EQ(2, lexicon.rank("d"));
+  EXPECT_EQ("a", lexicon.select(0));
+  lexicon.remove_string("b");
+  EXPECT_EQ(1, lexicon.rank("d"));
+  EXPECT_FALSE(lexicon.rank("b").has_value());
+  EXPECT_FALSE(lexicon.select(2).has_value());
+  EXPECT_EQ(2, lexicon.count_prefix(""));
+}
+
+TEST(FSALexiconRank, AfterCompaction)
+{
+  std::stringstream stream;
+  for (size_t i = 0; i < 200; ++i) {
+    stream << "com.d" << 1000 + i << std::endl;
+    stream << "com.d" << 1000 + i << ".www" << std::endl;
+  }
+  FSALexicon lexicon;
+  lexicon.add_file(stream);
+  std::vector<std::string> strings(lexicon.get_strings().begin(),
+                                   lexicon.get_strings().end());
+  lexicon.compact(3);
+  ASSERT_EQ(static_cast<int>(strings.size()), lexicon.size());
+  for (size_t rank = 0; rank < strings.size(); ++rank) {
+    EXPECT_EQ(rank, lexicon.rank(strings[rank])) << strings[rank];
+    EXPECT_EQ(strings[rank], lexicon.select(rank));
+  }
+  EXPECT_EQ(20, lexicon.count_prefix("com.d109"));
+  EXPECT_EQ(0, lexicon.count_prefix("com.d2"));
+}
+
+class FSALexiconSetOperations: public testing::Test
+{
+ protected:
+
+  void SetUp() override
+  {
+    // Overlapping sets of strings that share prefixes and suffixes, with the
+    // empty string and prefixes of other strings in some of them.
+    for (size_t i = 0; i < 600; ++i) {
+      auto domain = "com.d" + std::to_string(1000 + i / 3);
+      auto str = domain + (i % 3 == 0 ? "" : "." + std::to_string(i % 3));
+      if (i % 2 == 0) {
+        lhs_strings_.insert(str);
+      }
+      if (i % 5 != 0) {
+        rhs_strings_.insert(str);
+      }
+    }
+    lhs_strings_.insert("");
+    rhs_strings_.insert("net.example");
+    lhs_ = make_lexicon(lhs_strings_);
+    rhs_ = make_lexicon(rhs_strings_);
+  }
+
+  static FSALexicon make_lexicon(const std::set<std::string>& strings)
+  {
+    std::stringstream stream;
+    for (const auto& str: strings) {
+      stream << str << std::endl;
+    }
+    FSALexicon lexicon;
+    lexicon.add_file(stream);
+    return lexicon;
+  }
+
+  /**
+   * Check that a lexicon has the given strings, and that it is the minimal
+   * automaton of them with single-character labels.
+   */
+  static void expect_strings(const std::set<std::string>& expected,
+                             const FSALexicon& lexicon)
+  {
+    EXPECT_EQ(expected, lexicon.dump_strings());
+    EXPECT_EQ(static_cast<int>(expected.size()), lexicon.size());
+    auto minimal = make_lexicon(expected);
+    EXPECT_EQ(minimal.get_graph().get_num_nodes(),
+              lexicon.get_graph().get_num_nodes());
+    EXPECT_EQ(minimal.get_graph().get_num_edges(),
+              lexicon.get_graph().get_num_edges());
+  }
+
+  std::set<std::string> lhs_strings_;
+  std::set<std::string> rhs_strings_;
+  FSALexicon lhs_;
+  FSALexicon rhs_;
+};
+
+TEST_F(FSALexiconSetOperations, MatchesSets)
+{
+  for (size_t level: {0, 1, 3}) {
+    SCOPED_TRACE(level);
+    lhs_.compact(level);
+    rhs_.compact(level);
+    std::set<std::string> expected;
+    std::set_union(lhs_strings_.begin(), lhs_strings_.end(),
+                   rhs_strings_.begin(), rhs_strings_.end(),
+                   std::inserter(expected, expected.end()));
+    expect_strings(expected, FSALexicon::set_union(lhs_, rhs_));
+    expected.clear();
+    std::set_intersection(lhs_strings_.begin(), lhs_strings_.end(),
+                          rhs_strings_.begin(), rhs_strings_.end(),
+                          std::inserter(expected, expected.end()));
+    expect_strings(expected, FSALexicon::set_intersection(lhs_, rhs_));
+    expected.clear();
+    std::set_difference(lhs_strings_.begin(), lhs_strings_.end(),
+                        rhs_strings_.begin(), rhs_strings_.end(),
+                        std::inserter(expected, expected.end()));
+    expect_strings(expected, FSALexicon::set_difference(lhs_, rhs_));
+  }
+}
+
+TEST_F(FSALexiconSetOperations, EmptyOperand)
+{
+  FSALexicon empty;
+  expect_strings(lhs_strings_, FSALexicon::set_union(lhs_, empty));
+  expect_strings(lhs_strings_, FSALexicon::set_union(empty, lhs_));
+  expect_strings({}, FSALexicon::set_intersection(lhs_, empty));
+  expect_strings(lhs_strings_, FSALexicon::set_difference(lhs_, empty));
+  expect_strings({}, FSALexicon::set_difference(empty, lhs_));
+  expect_strings({}, FSALexicon::set_difference(lhs_, lhs_));
+}
+
+TEST_F(FSALexiconSetOperations, Editable)
+{
+  // The result keeps its register, so it can be changed like any lexicon.
+  auto lexicon = FSALexicon::set_intersection(lhs_, rhs_);
+  EXPECT_EQ(lexicon.get_graph().get_num_nodes() - 1,
+            lexicon.get_register().size());
+  lexicon.add_string("org.example");
+  lexicon.remove_string("com.d1002");
+  auto expected = lexicon.dump_strings();
+  expect_strings(expected, lexicon);
+}
+
+TEST(FSALexiconHasStrings, MatchesHasString)
+{
+  std::stringstream stream;
+  std::vector<std::string> queries{"", "c", "com", "com.d1000.", "zzz"};
+  for (size_t i = 0; i < 300; ++i) {
+    auto domain = "com.d" + std::to_string(1000 + i / 3);
+    auto str = domain + (i % 3 == 0 ? "" : "." + std::to_string(i % 3));
+    if (i % 4 != 0) {
+      stream << str << std::endl;
+    }
+    // Query some strings more than once.
+    queries.push_back(str);
+    queries.push_back(domain + ".3");
+  }
+  FSALexicon lexicon;
+  lexicon.add_file(stream);
+  std::mt19937 generator{42};
+  std::shuffle(queries.begin(), queries.end(), generator);
+  const std::vector<std::string_view> views(queries.begin(), queries.end());
+
+  for (size_t level: {0, 1, 3}) {
+    lexicon.compact(level);
+    auto found = lexicon.has_strings(views);
+    ASSERT_EQ(queries.size(), found.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+      EXPECT_EQ(lexicon.has_string(queries[i]), found[i])
+        << level << ": " << queries[i];
+    }
+  }
+}
+
+TEST(FSALexiconAddFileParallel, MatchesAddFile)
+{
+  // Enough reversed domain names for several batches, with prefixes shared
+  // across batch boundaries and suffixes shared across shards.
+  std::stringstream stream;
+  for (size_t i = 0; i < 100000; ++i) {
+    auto domain = "com.d" + std::to_string(1000000 + i / 2);
+    stream << domain << "." << (i % 2 == 0 ? "mail" : "www") << std::endl;
+    if (i % 7 == 0) {
+      stream << domain << "." << (i % 2 == 0 ? "mail" : "www") << ".x"
+             << std::endl;
+    }
+  }
+  stream << "org.example" << std::endl;
+  const auto strings = stream.str();
+
+  FSALexicon sequential, parallel;
+  std::stringstream sequential_stream{strings}, parallel_stream{strings};
+  sequential.add_file(sequential_stream);
+  parallel.add_file_parallel(parallel_stream, 3);
+  EXPECT_EQ(sequential.size(), parallel.size());
+  // The minimal automaton of a set of strings is unique.
+  EXPECT_EQ(sequential.get_graph().get_num_nodes(),
+            parallel.get_graph().get_num_nodes());
+  EXPECT_EQ(sequential.get_graph().get_num_edges(),
+            parallel.get_graph().get_num_edges());
+  EXPECT_EQ(sequential, parallel);
+  EXPECT_EQ(parallel.get_graph().get_num_nodes() - 1,
+            parallel.get_register().size());
+  EXPECT_TRUE(parallel.has_string("com.d1000000.mail.x"));
+  EXPECT_FALSE(parallel.has_string("com.d1000000.www.x"));
+}
+
+TEST(FSALexiconAddFileParallel, OutOfOrder)
+{
+  std::stringstream stream;
+  stream << "com.b" << std::endl << "com.b" << std::endl << "com.c"
+         << std::endl << "com.a" << std::endl << "net.a" << std::endl;
+  FSALexicon lexicon;
+  lexicon.add_file_parallel(stream, 2);
+  EXPECT_EQ(4, lexicon.size());
+  for (const auto& str: {"com.a", "com.b", "com.c", "net.a"}) {
+    EXPECT_TRUE(lexicon.has_string(str)) << str;
+  }
+  EXPECT_FALSE(lexicon.has_string("com."));
+}
+
+TEST(FSALexiconAddFileParallel, EmptyStream)
+{
+  FSALexicon lexicon;
+  std::stringstream stream;
+  lexicon.add_file_parallel(stream, 2);
+  EXPECT_EQ(0, lexicon.size());
+  EXPECT_EQ(1, lexicon.get_graph().get_num_nodes());
+}
+
+TEST(FSALexiconAddFilePipelined, MatchesAddFile)
+{
+  // Enough strings to fill the queue between the threads several times, with
+  // long frozen paths that share suffixes.
+  std::stringstream stream;
+  for (size_t i = 0; i < 50000; ++i) {
+    auto domain = "com.d" + std::to_string(1000000 + i / 3);
+    stream << domain << "." << (i % 3 == 0 ? "mail" : "www") << i % 3
+           << std::endl;
+  }
+  const auto strings = stream.str();
+
+  FSALexicon sequential, pipelined;
+  std::stringstream sequential_stream{strings}, pipelined_stream{strings};
+  sequential.add_file(sequential_stream);
+  pipelined.add_file_pipelined(pipelined_stream);
+  EXPECT_EQ(sequential.size(), pipelined.size());
+  EXPECT_EQ(sequential.get_graph().get_num_nodes(),
+            pipelined.get_graph().get_num_nodes());
+  EXPECT_EQ(sequential.get_graph().get_num_edges(),
+            pipelined.get_graph().get_num_edges());
+  EXPECT_EQ(sequential, pipelined);
+  EXPECT_EQ(pipelined.get_graph().get_num_nodes() - 1,
+            pipelined.get_register().size());
+}
+
+TEST(FSALexiconAddFilePipelined, OutOfOrder)
+{
+  std::stringstream stream;
+  stream << "com.b" << std::endl << "com.b" << std::endl << "com.c"
+         << std::endl << "com.a" << std::endl << "net.a" << std::endl;
+  FSALexicon lexicon;
+  const auto strings = stream.str();
+  std::stringstream sequential_stream{strings};
+  FSALexicon sequential;
+  sequential.add_file(sequential_stream);
+  lexicon.add_file_pipelined(stream);
+  EXPECT_EQ(4, lexicon.size());
+  for (const auto& str: {"com.a", "com.b", "com.c", "net.a"}) {
+    EXPECT_TRUE(lexicon.has_string(str)) << str;
+  }
+  EXPECT_FALSE(lexicon.has_string("com."));
+  EXPECT_EQ(sequential.get_graph().get_num_nodes(),
+            lexicon.get_graph().get_num_nodes());
+}
+
 TEST_F(GoogleLexicon, AddAndCompress)
 {
   std::stringstream stream;
@@ -461,6 +1020,30 @@ TEST_F(GoogleLexicon, AddAndCompress)
   EXPECT_EQ(1, label_map.at(".google."));
 }
 
+TEST_F(GoogleLexicon, SaveAndLoadCheckpoint)
+{
+  add_n_strings(domains_.size());
+  lexicon_.compact(3);
+  std::stringstream stream;
+  lexicon_.save_checkpoint(stream);
+
+  FSALexicon loaded;
+  ASSERT_TRUE(loaded.load_checkpoint(stream));
+  EXPECT_EQ(domains_.size(), loaded.size());
+  EXPECT_EQ(lexicon_.get_graph().get_num_nodes(),
+            loaded.get_graph().get_num_nodes());
+  EXPECT_EQ(lexicon_.get_graph().get_num_edges(),
+            loaded.get_graph().get_num_edges());
+  EXPECT_EQ(lexicon_.get_graph().get_label_counts(),
+            loaded.get_graph().get_label_counts());
+  EXPECT_EQ(lexicon_.dump_strings(), loaded.dump_strings());
+
+  // An invalid checkpoint leaves the lexicon unchanged.
+  std::stringstream invalid{"not a checkpoint"};
+  EXPECT_FALSE(loaded.load_checkpoint(invalid));
+  EXPECT_EQ(domains_.size(), loaded.size());
+}
+
 //class NodeHashTest: public testing::Test
 //{
 // protected:
@@ -8,6 +8,8 @@
 
 // Include C++ standard libraries.
 #include <sstream>
+#include <string_view>
+#include <vector>
 
 // Include other headers from this project.
 #include "../../../src/signaling/lexicon/lexicon.h"
@@ -96,6 +98,47 @@ TYPED_TEST(LexiconStringTest, AddStringPreservesEqual)
   EXPECT_EQ(*(this->lexicon_), *copy);
 }
 
+TYPED_TEST(LexiconStringTest, RemoveString)
+{
+  this->lexicon_->add_string(this->SAMPLE_URL);
+  this->lexicon_->remove_string(this->SAMPLE_URL);
+  EXPECT_EQ(0, this->lexicon_->size());
+  EXPECT_FALSE(this->lexicon_->has_string(this->SAMPLE_URL));
+  // Removing a string that is not in the lexicon does nothing.
+  this->lexicon_->remove_string(this->SAMPLE_URL);
+  EXPECT_EQ(0, this->lexicon_->size());
+  EXPECT_EQ(*(this->lexicon_), TypeParam{});
+}
+
+TYPED_TEST(LexiconStringTest, RemoveFile)
+{
+  std::stringstream add_stream, remove_stream;
+  add_stream << "com.example" << std::endl << this->SAMPLE_URL << std::endl
+             << "org.example" << std::endl;
+  remove_stream << this->SAMPLE_URL << std::endl << "net.example"
+                << std::endl << "org.example" << std::endl;
+  this->lexicon_->add_file(add_stream);
+  this->lexicon_->remove_file(remove_stream);
+  EXPECT_EQ(1, this->lexicon_->size());
+  EXPECT_TRUE(this->lexicon_->has_string("com.example"));
+  EXPECT_FALSE(this->lexicon_->has_string(this->SAMPLE_URL));
+  EXPECT_FALSE(this->lexicon_->has_string("org.example"));
+}
+
+TYPED_TEST(LexiconStringTest, HasStrings)
+{
+  std::stringstream stream;
+  stream << "com.example" << std::endl << this->SAMPLE_URL << std::endl;
+  this->lexicon_->add_file(stream);
+  const std::vector<std::string_view> queries{
+    "org.example", this->SAMPLE_URL, "com.example", "com.", "com.example",
+    "com.example.wwww", ""};
+  const std::vector<bool> expected{false, true, true, false, true, false,
+                                   false};
+  EXPECT_EQ(expected, this->lexicon_->has_strings(queries));
+  EXPECT_TRUE(this->lexicon_->has_strings({}).empty());
+}
+
 
 TYPED_TEST_SUITE(LexiconPrefixTest, Implementations);
 
@@ -110,4 +153,17 @@ TYPED_TEST(LexiconPrefixTest, AddPrefix)
   this->lexicon_->add_string(this->SAMPLE_PREFIX);
   this->lexicon_->add_string(this->SAMPLE_URL);
   EXPECT_TRUE(this->lexicon_->has_string(this->SAMPLE_PREFIX));
-}
\ No newline at end of file
+}
+
+TYPED_TEST(LexiconPrefixTest, RemovePrefix)
+{
+  this->lexicon_->add_string(this->SAMPLE_PREFIX);
+  this->lexicon_->add_string(this->SAMPLE_URL);
+  this->lexicon_->remove_string(this->SAMPLE_PREFIX);
+  EXPECT_FALSE(this->lexicon_->has_string(this->SAMPLE_PREFIX));
+  EXPECT_TRUE(this->lexicon_->has_string(this->SAMPLE_URL));
+  this->lexicon_->add_string(this->SAMPLE_PREFIX);
+  this->lexicon_->remove_string(this->SAMPLE_URL);
+  EXPECT_TRUE(this->lexicon_->has_string(this->SAMPLE_PREFIX));
+  EXPECT_FALSE(this->lexicon_->has_string(this->SAMPLE_URL));
+}
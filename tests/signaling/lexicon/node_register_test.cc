@@ -0,0 +1,114 @@
+/**
+ * Unit tests for the register of nodes used to minimize FSAs.
+ */
+
+// Include C++ standard libraries.
+#include <memory>
+#include <string>
+#include <vector>
+
+// Include other headers from this project.
+#include "../../../src/signaling/graph/node/node.h"
+#include "../../../src/signaling/lexicon/fsa_lexicon/node_register.h"
+
+// Include header from other projects.
+#include "gtest/gtest.h"
+
+class NodeRegisterTest: public testing::Test
+{
+ protected:
+
+  // Make a node whose right language is determined by an index: the node has
+  // an edge to each of the two sinks for each set bit of the index.
+  Node* make_node(size_t index)
+  {
+    nodes_.push_back(std::make_unique<Node>());
+    auto node = nodes_.back().get();
+    for (size_t bit = 0; (index >> bit) > 0; ++bit) {
+      if ((index >> bit) & 1) {
+        node->add_out_edge(labels_.intern(std::to_string(bit)),
+                           bit % 2 ? &sink_ : &accept_);
+      }
+    }
+    return node;
+  }
+
+  void SetUp() override
+  {
+    accept_.set_accept(true);
+  }
+
+  LabelPool labels_;
+  Node sink_, accept_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+  NodeRegister register_;
+};
+
+TEST_F(NodeRegisterTest, Empty)
+{
+  EXPECT_TRUE(register_.empty());
+  EXPECT_EQ(0, register_.size());
+  auto node = make_node(1);
+  EXPECT_EQ(nullptr, register_.find(node));
+  EXPECT_FALSE(register_.contains(node));
+  EXPECT_FALSE(register_.erase(node));
+}
+
+TEST_F(NodeRegisterTest, FindEquivalent)
+{
+  auto node = make_node(5);
+  auto equivalent = make_node(5);
+  EXPECT_TRUE(register_.insert(node));
+  EXPECT_FALSE(register_.insert(equivalent));
+  EXPECT_EQ(1, register_.size());
+  EXPECT_EQ(node, register_.find(node));
+  EXPECT_EQ(node, register_.find(equivalent));
+  EXPECT_TRUE(register_.contains(node));
+  EXPECT_FALSE(register_.contains(equivalent));
+
+  // Erasing an equivalent node does not erase the registered node.
+  EXPECT_FALSE(register_.erase(equivalent));
+  EXPECT_TRUE(register_.erase(node));
+  EXPECT_TRUE(register_.empty());
+  EXPECT_EQ(nullptr, register_.find(equivalent));
+}
+
+TEST_F(NodeRegisterTest, EditNode)
+{
+  auto node = make_node(2);
+  ASSERT_TRUE(register_.insert(node));
+  ASSERT_TRUE(register_.erase(node));
+  node->set_accept(true);
+  ASSERT_TRUE(register_.insert(node));
+
+  auto equivalent = make_node(2);
+  EXPECT_EQ(nullptr, register_.find(equivalent));
+  equivalent->set_accept(true);
+  EXPECT_EQ(node, register_.find(equivalent));
+}
+
+TEST_F(NodeRegisterTest, ManyNodes)
+{
+  // Insert enough nodes for the table to grow several times, then erase every
+  // other node and check that the rest can still be found.
+  const size_t num_nodes = 1000;
+  std::vector<Node*> registered;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    registered.push_back(make_node(i));
+    ASSERT_TRUE(register_.insert(registered.back()));
+  }
+  EXPECT_EQ(num_nodes, register_.size());
+  for (size_t i = 0; i < num_nodes; i += 2) {
+    ASSERT_TRUE(register_.erase(registered[i]));
+  }
+  EXPECT_EQ(num_nodes / 2, register_.size());
+  for (size_t i = 0; i < num_nodes; ++i) {
+    auto equivalent = make_node(i);
+    EXPECT_EQ(i % 2 ? registered[i] : nullptr, register_.find(equivalent))
+      << i;
+  }
+
+  NodeRegister{}.swap(register_);
+  EXPECT_TRUE(register_.empty());
+  EXPECT_EQ(nullptr, register_.find(registered[1]));
+}